@@ -0,0 +1,204 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+#include "ohclient.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+struct oh_client {
+    int socket;
+    const unsigned char *ring;
+    size_t size;
+    const struct oh_ring_header *header;
+    uint64_t last;     /* Number of the last acquired frame */
+    uint64_t sequence; /* Sequence of the acquired frame */
+    unsigned long long dropped;
+};
+
+static uint64_t load_acquire(const uint64_t *value) { return __atomic_load_n(value, __ATOMIC_ACQUIRE); }
+
+/* Receives the hello message and the file descriptor of the ring */
+static int receive_hello(int socket, struct oh_hello *hello) {
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = {hello, sizeof(*hello)};
+    struct msghdr message;
+    struct cmsghdr *cmsg;
+    ssize_t received;
+    int fd = -1;
+
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    do
+        received = recvmsg(socket, &message, 0);
+    while (received < 0 && errno == EINTR);
+
+    for (cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+            memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+    if (fd >= 0) fcntl(fd, F_SETFD, FD_CLOEXEC);
+    if (received != (ssize_t)sizeof(*hello) || hello->magic != OH_PROTOCOL_MAGIC ||
+        hello->version != OH_PROTOCOL_VERSION || fd < 0) {
+        if (fd >= 0) close(fd);
+        errno = EPROTO;
+        return -1;
+    }
+    return fd;
+}
+
+struct oh_client *oh_connect(const char *socket_path) {
+    struct sockaddr_un address;
+    struct oh_hello hello;
+    struct oh_client *client;
+    void *ring;
+    int fd, error;
+
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return NULL;
+    }
+    client = calloc(1, sizeof(*client));
+    if (!client) return NULL;
+
+    client->socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client->socket < 0) goto fail;
+    fcntl(client->socket, F_SETFD, FD_CLOEXEC);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+    if (connect(client->socket, (struct sockaddr *)&address, sizeof(address)) < 0) goto fail;
+
+    fd = receive_hello(client->socket, &hello);
+    if (fd < 0) goto fail;
+    ring = mmap(NULL, (size_t)hello.size, PROT_READ, MAP_SHARED, fd, 0);
+    error = errno;
+    close(fd);
+    errno = error;
+    if (ring == MAP_FAILED) goto fail;
+    client->ring = ring;
+    client->size = (size_t)hello.size;
+    client->header = ring;
+
+    if (client->size < sizeof(struct oh_ring_header) || client->header->magic != OH_PROTOCOL_MAGIC ||
+        !client->header->slot_count || client->header->slot_size < sizeof(struct oh_frame_header) ||
+        client->header->slot_offset + client->header->slot_count * client->header->slot_size > client->size) {
+        errno = EPROTO;
+        goto fail;
+    }
+    /* Start with the next frame */
+    client->last = load_acquire(&client->header->latest);
+    return client;
+
+fail:
+    error = errno;
+    oh_disconnect(client);
+    errno = error;
+    return NULL;
+}
+
+void oh_disconnect(struct oh_client *client) {
+    if (!client) return;
+    if (client->ring) munmap((void *)client->ring, client->size);
+    if (client->socket >= 0) close(client->socket);
+    free(client);
+}
+
+int oh_fd(const struct oh_client *client) { return client->socket; }
+
+int oh_wait(struct oh_client *client, int timeout_ms) {
+    struct pollfd pfd = {client->socket, POLLIN, 0};
+    char buffer[256];
+
+    for (;;) {
+        ssize_t received;
+        int ready;
+        if (load_acquire(&client->header->latest) > client->last) return 1;
+
+        ready = poll(&pfd, 1, timeout_ms);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0) return -1;
+        if (ready == 0) return load_acquire(&client->header->latest) > client->last;
+
+        /* The bytes only signal new frames, read all that piled up */
+        received = recv(client->socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) return -1;
+    }
+}
+
+const struct oh_frame_header *oh_acquire(struct oh_client *client) {
+    const struct oh_ring_header *header = client->header;
+    const uint64_t number = load_acquire(&header->latest);
+    const struct oh_frame_header *frame;
+    uint64_t sequence;
+
+    if (number <= client->last) return NULL;
+    frame = (const struct oh_frame_header *)(client->ring + header->slot_offset +
+                                             (number % header->slot_count) * header->slot_size);
+    sequence = load_acquire(&frame->sequence);
+    /* Overwritten by a newer frame already, that one is announced soon */
+    if (sequence != 2 * number) return NULL;
+
+    client->dropped += number - client->last - 1;
+    client->last = number;
+    client->sequence = sequence;
+    return frame;
+}
+
+int oh_release(struct oh_client *client, const struct oh_frame_header *frame) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&frame->sequence, __ATOMIC_RELAXED) == client->sequence) return 1;
+    ++client->dropped;
+    return 0;
+}
+
+unsigned long long oh_dropped(const struct oh_client *client) { return client->dropped; }
+
+/* Reads the values once and checks them against the slot, a frame that is overwritten while it is read may
+ * pair an offset with the count of another frame */
+static const float *samples(const struct oh_client *client, const struct oh_frame_header *frame,
+                            const uint64_t *offset_field, const uint64_t *count_field, size_t *count) {
+    const uint64_t offset = __atomic_load_n(offset_field, __ATOMIC_RELAXED);
+    const uint64_t size = __atomic_load_n(count_field, __ATOMIC_RELAXED);
+    const uint64_t slot_size = client->header->slot_size;
+    *count = 0;
+    if (offset > slot_size || size > (slot_size - offset) / sizeof(float)) return NULL;
+    *count = (size_t)size;
+    return (const float *)((const unsigned char *)frame + offset);
+}
+
+unsigned oh_channel_count(const struct oh_client *client, const struct oh_frame_header *frame) {
+    const uint32_t count = __atomic_load_n(&frame->channel_count, __ATOMIC_RELAXED);
+    const uint64_t fit =
+        (client->header->slot_size - sizeof(struct oh_frame_header)) / sizeof(struct oh_channel_header);
+    return count < fit ? count : (unsigned)fit;
+}
+
+const struct oh_channel_header *oh_channel(const struct oh_client *client, const struct oh_frame_header *frame,
+                                           unsigned index) {
+    if (index >= oh_channel_count(client, frame)) return NULL;
+    return (const struct oh_channel_header *)(frame + 1) + index;
+}
+
+const float *oh_voltage(const struct oh_client *client, const struct oh_frame_header *frame,
+                        const struct oh_channel_header *channel, size_t *count) {
+    *count = 0;
+    if (!(channel->flags & OH_CHANNEL_VOLTAGE)) return NULL;
+    return samples(client, frame, &channel->voltage_offset, &channel->voltage_count, count);
+}
+
+const float *oh_spectrum(const struct oh_client *client, const struct oh_frame_header *frame,
+                         const struct oh_channel_header *channel, size_t *count) {
+    *count = 0;
+    if (!(channel->flags & OH_CHANNEL_SPECTRUM)) return NULL;
+    return samples(client, frame, &channel->spectrum_offset, &channel->spectrum_count, count);
+}
@@ -0,0 +1,63 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Client library for the frame server of OpenHantek, see ohprotocol.h.
+ *
+ *     struct oh_client *client = oh_connect("/run/user/1000/openhantek");
+ *     while (oh_wait(client, -1) > 0) {
+ *         const struct oh_frame_header *frame = oh_acquire(client);
+ *         ... read the frame in place ...
+ *         if (!oh_release(client, frame)) ... the frame has been overwritten while reading, drop the results ...
+ *     }
+ *     oh_disconnect(client);
+ */
+
+#ifndef OHCLIENT_H
+#define OHCLIENT_H
+
+#include <stddef.h>
+
+#include "ohprotocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oh_client;
+
+/* Connects to the server and maps the ring. Returns NULL on failure, errno tells why. */
+struct oh_client *oh_connect(const char *socket_path);
+void oh_disconnect(struct oh_client *client);
+
+/* The socket, to wait for frames with poll() together with other files */
+int oh_fd(const struct oh_client *client);
+
+/* Waits until a frame newer than the last acquired one is available.
+ * timeout_ms: -1 waits forever. Returns 1 if there is a new frame, 0 on timeout and -1 if the server is gone. */
+int oh_wait(struct oh_client *client, int timeout_ms);
+
+/* Returns the newest frame, directly in the shared memory, or NULL if there is none or it is being overwritten.
+ * The frames in between are counted as dropped. */
+const struct oh_frame_header *oh_acquire(struct oh_client *client);
+/* Returns 1 if the frame stayed unchanged since oh_acquire(), 0 if the data read in between is invalid. */
+int oh_release(struct oh_client *client, const struct oh_frame_header *frame);
+
+/* Frames that have been skipped or overwritten while reading */
+unsigned long long oh_dropped(const struct oh_client *client);
+
+/* The channels of a frame. The counts and offsets are checked against the slot, so reading them is safe even
+ * if the frame is overwritten at the same time. Use the counts returned here to access the samples. */
+unsigned oh_channel_count(const struct oh_client *client, const struct oh_frame_header *frame);
+const struct oh_channel_header *oh_channel(const struct oh_client *client, const struct oh_frame_header *frame,
+                                           unsigned index);
+/* The voltage (V) and spectrum (dB) samples of a channel, NULL if the channel has none */
+const float *oh_voltage(const struct oh_client *client, const struct oh_frame_header *frame,
+                        const struct oh_channel_header *channel, size_t *count);
+const float *oh_spectrum(const struct oh_client *client, const struct oh_frame_header *frame,
+                         const struct oh_channel_header *channel, size_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/* Sample client: Prints the minimum, maximum and mean voltage of every channel for each received frame.
+ * Usage: ohmonitor <socket path> */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "ohclient.h"
+
+int main(int argc, char *argv[]) {
+    struct oh_client *client;
+    int result;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <socket path>\n", argv[0]);
+        return 1;
+    }
+    client = oh_connect(argv[1]);
+    if (!client) {
+        fprintf(stderr, "Can't connect to %s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+
+    while ((result = oh_wait(client, -1)) > 0) {
+        const struct oh_frame_header *frame = oh_acquire(client);
+        char line[1024];
+        size_t length;
+        unsigned index;
+        if (!frame) continue;
+
+        /* Collect the output first, it is only valid if the frame is unchanged afterwards */
+        length = (size_t)snprintf(line, sizeof(line), "frame %llu:", (unsigned long long)frame->number);
+        for (index = 0; index < oh_channel_count(client, frame) && length < sizeof(line); ++index) {
+            const struct oh_channel_header *channel = oh_channel(client, frame, index);
+            size_t count, position;
+            const float *samples = oh_voltage(client, frame, channel, &count);
+            double minimum = 0, maximum = 0, sum = 0;
+            char name[sizeof(channel->name)];
+            if (!samples || !count) continue;
+
+            for (position = 0; position < count; ++position) {
+                if (!position || samples[position] < minimum) minimum = samples[position];
+                if (!position || samples[position] > maximum) maximum = samples[position];
+                sum += samples[position];
+            }
+            memcpy(name, channel->name, sizeof(name));
+            name[sizeof(name) - 1] = 0;
+            length += (size_t)snprintf(line + length, sizeof(line) - length, "  %s %zu samples %.4g..%.4g V, mean %.4g V",
+                                       name, count, minimum, maximum, sum / count);
+        }
+        if (oh_release(client, frame)) printf("%s  (%llu dropped)\n", line, oh_dropped(client));
+    }
+
+    oh_disconnect(client);
+    if (result < 0) fprintf(stderr, "Server closed the connection\n");
+    return result < 0 ? 1 : 0;
+}
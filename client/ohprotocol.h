@@ -0,0 +1,77 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+
+/*
+ * Layout of the frames that OpenHantek publishes with "--server <socket>".
+ *
+ * The server creates a shared memory ring and passes its file descriptor to every client that connects to the
+ * Unix domain socket, together with an oh_hello message. Afterwards the server writes one byte to the socket
+ * for every new frame, clients that don't read them fast enough just miss bytes. The bytes only wake up the
+ * client, the state is in the ring: oh_ring_header.latest is the number of the newest complete frame, which
+ * lives in slot (number % slot_count).
+ *
+ * Every slot is guarded by a sequence lock. The server sets oh_frame_header.sequence to 2 * number - 1 before
+ * it writes frame "number" into the slot and to 2 * number afterwards. A reader loads the sequence, reads the
+ * frame in place and loads the sequence again: If it changed, the slot has been overwritten and the frame has
+ * to be dropped. So the server never waits for a client.
+ *
+ * All values are in the byte order of the host, the ring is only shared with local processes.
+ */
+
+#ifndef OHPROTOCOL_H
+#define OHPROTOCOL_H
+
+#include <stdint.h>
+
+#define OH_PROTOCOL_MAGIC 0x52464f48u /* "OHFR" */
+#define OH_PROTOCOL_VERSION 1
+
+/* Sent by the server after accepting a client, with the file descriptor of the ring as SCM_RIGHTS */
+struct oh_hello {
+    uint32_t magic;   /* OH_PROTOCOL_MAGIC */
+    uint32_t version; /* OH_PROTOCOL_VERSION */
+    uint64_t size;    /* Size of the ring for mmap() */
+};
+
+/* At offset 0 of the ring */
+struct oh_ring_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t reserved;
+    uint64_t slot_offset; /* Offset of the first slot */
+    uint64_t slot_size;   /* Bytes per slot, including the oh_frame_header */
+    uint64_t latest;      /* Number of the newest complete frame, 0 before the first frame (atomic) */
+};
+
+/* oh_frame_header.flags */
+#define OH_FRAME_ROLL 0x1u      /* The samples continue the previous frame (roll mode) */
+#define OH_FRAME_TRIGGERED 0x2u /* The software trigger found a trigger point */
+#define OH_FRAME_TRUNCATED 0x4u /* The frame didn't fit into the slot, the channels have been shortened */
+
+/* At the start of a slot, followed by channel_count oh_channel_header and the samples */
+struct oh_frame_header {
+    uint64_t sequence;      /* Sequence lock, see above (atomic) */
+    uint64_t number;        /* Frame number, counting from 1 */
+    int64_t timestamp;      /* Host time of the first sample in ns since the epoch */
+    uint32_t flags;         /* OH_FRAME_* */
+    uint32_t channel_count; /* Number of oh_channel_header */
+};
+
+/* oh_channel_header.flags */
+#define OH_CHANNEL_VOLTAGE 0x1u  /* The voltage samples are valid */
+#define OH_CHANNEL_SPECTRUM 0x2u /* The spectrum samples are valid */
+
+struct oh_channel_header {
+    char name[32];               /* Zero terminated, UTF-8 */
+    uint32_t channel;            /* Index of the channel, the math channel follows the device channels */
+    uint32_t flags;              /* OH_CHANNEL_* */
+    double frequency;            /* Signal frequency in Hz, 0 if unknown */
+    double voltage_interval;     /* Time between two voltage samples in s */
+    double spectrum_interval;    /* Frequency between two spectrum samples in Hz */
+    uint64_t voltage_offset;     /* Offset of the float voltage samples (V) from the oh_frame_header */
+    uint64_t voltage_count;
+    uint64_t spectrum_offset;    /* Offset of the float spectrum samples (dB) from the oh_frame_header */
+    uint64_t spectrum_count;
+};
+
+#endif
@@ -7,6 +7,10 @@
 #   FFTW_FOUND					... true if fftw is found on the system
 #   FFTW_LIBRARIES				... full path to fftw library
 #   FFTW_INCLUDES				... fftw include directory
+#   FFTW_FLOAT_FOUND			... true if the single precision library (fftw3f) is found as well
+#   FFTW_FLOAT_LIBRARIES		... full path to the single precision library
+#   FFTW_THREADS_FOUND			... true if the threaded libraries are found as well
+#   FFTW_THREADS_LIBRARIES		... full path to the threaded libraries (fftw3_threads and fftw3f_threads)
 #
 # The following variables will be checked by the function
 #   FFTW_USE_STATIC_LIBS		... if true, only static libraries are found
@@ -47,6 +51,39 @@ endif (FFTW_USE_STATIC_LIBS AND NOT MSVC)
       /sw/lib
   )
 
+  find_library(FFTW_FLOAT_LIBRARY
+    NAMES
+      fftw3f
+      libfftw3f${LIBFFTW_LIB_SUFFIX}
+    PATHS
+      /usr/lib
+      /usr/local/lib
+      /opt/local/lib
+      /sw/lib
+  )
+
+  find_library(FFTW_THREADS_LIBRARY
+    NAMES
+      fftw3_threads
+      libfftw3_threads${LIBFFTW_LIB_SUFFIX}
+    PATHS
+      /usr/lib
+      /usr/local/lib
+      /opt/local/lib
+      /sw/lib
+  )
+
+  find_library(FFTW_FLOAT_THREADS_LIBRARY
+    NAMES
+      fftw3f_threads
+      libfftw3f_threads${LIBFFTW_LIB_SUFFIX}
+    PATHS
+      /usr/lib
+      /usr/local/lib
+      /opt/local/lib
+      /sw/lib
+  )
+
   set(FFTW_INCLUDE_DIRS
     ${FFTW_INCLUDE_DIR}
   )
@@ -58,11 +95,27 @@ endif (FFTW_USE_STATIC_LIBS AND NOT MSVC)
      set(FFTW_FOUND TRUE)
   endif (FFTW_INCLUDE_DIRS AND FFTW_LIBRARIES)
 
+  if (FFTW_FOUND AND FFTW_FLOAT_LIBRARY)
+     set(FFTW_FLOAT_FOUND TRUE)
+     set(FFTW_FLOAT_LIBRARIES ${FFTW_FLOAT_LIBRARY})
+  endif (FFTW_FOUND AND FFTW_FLOAT_LIBRARY)
+
+  if (FFTW_FLOAT_FOUND AND FFTW_THREADS_LIBRARY AND FFTW_FLOAT_THREADS_LIBRARY)
+     set(FFTW_THREADS_FOUND TRUE)
+     set(FFTW_THREADS_LIBRARIES ${FFTW_THREADS_LIBRARY} ${FFTW_FLOAT_THREADS_LIBRARY})
+  endif (FFTW_FLOAT_FOUND AND FFTW_THREADS_LIBRARY AND FFTW_FLOAT_THREADS_LIBRARY)
+
   if (FFTW_FOUND)
     if (NOT FFTW_FIND_QUIETLY)
       message(STATUS "Found libfftw3:")
 	  message(STATUS " - Includes: ${FFTW_INCLUDE_DIRS}")
 	  message(STATUS " - Libraries: ${FFTW_LIBRARIES}")
+	  if (FFTW_FLOAT_FOUND)
+	    message(STATUS " - Single precision: ${FFTW_FLOAT_LIBRARIES}")
+	  endif (FFTW_FLOAT_FOUND)
+	  if (FFTW_THREADS_FOUND)
+	    message(STATUS " - Threads: ${FFTW_THREADS_LIBRARIES}")
+	  endif (FFTW_THREADS_FOUND)
     endif (NOT FFTW_FIND_QUIETLY)
   else (FFTW_FOUND)
     if (FFTW_FIND_REQUIRED)
@@ -71,6 +124,6 @@ endif (FFTW_USE_STATIC_LIBS AND NOT MSVC)
   endif (FFTW_FOUND)
 
   # show the FFTW_INCLUDE_DIRS and FFTW_LIBRARIES variables only in the advanced view
-  mark_as_advanced(FFTW_INCLUDE_DIRS FFTW_LIBRARIES)
+  mark_as_advanced(FFTW_INCLUDE_DIRS FFTW_LIBRARIES FFTW_FLOAT_LIBRARY FFTW_THREADS_LIBRARY FFTW_FLOAT_THREADS_LIBRARY)
 
 endif (FFTW_LIBRARIES AND FFTW_INCLUDE_DIRS)
@@ -1,6 +1,12 @@
 // SPDX-License-Identifier: GPL-2.0+
 
+#include <QSignalBlocker>
+#include <QThread>
+#include <algorithm>
+
 #include "DsoConfigAnalysisPage.h"
+#include "post/mathexpression.h"
+#include "sispinbox.h"
 
 DsoConfigAnalysisPage::DsoConfigAnalysisPage(DsoSettings *settings, QWidget *parent)
     : QWidget(parent), settings(settings) {
@@ -39,6 +45,60 @@ DsoConfigAnalysisPage::DsoConfigAnalysisPage(DsoSettings *settings, QWidget *par
     minimumMagnitudeLayout->addWidget(minimumMagnitudeSpinBox);
     minimumMagnitudeLayout->addWidget(minimumMagnitudeUnitLabel);
 
+    zoomCheckBox = new QCheckBox(tr("Only between the markers"));
+    zoomCheckBox->setChecked(settings->post.spectrumZoom);
+
+    decimationLabel = new QLabel(tr("Decimation"));
+    decimationSpinBox = new QSpinBox();
+    decimationSpinBox->setMinimum(1);
+    decimationSpinBox->setMaximum(64);
+    decimationSpinBox->setSpecialValueText(tr("Off"));
+    decimationSpinBox->setValue((int)settings->post.spectrumDecimation);
+
+    singlePrecisionCheckBox = new QCheckBox(tr("Single precision DFT"));
+    singlePrecisionCheckBox->setChecked(settings->post.spectrumSinglePrecision);
+#ifndef HAVE_FFTW_FLOAT
+    singlePrecisionCheckBox->setEnabled(false);
+#endif
+
+    threadsLabel = new QLabel(tr("DFT threads"));
+    threadsSpinBox = new QSpinBox();
+    threadsSpinBox->setMinimum(1);
+    threadsSpinBox->setMaximum(std::max(1, QThread::idealThreadCount()));
+    threadsSpinBox->setValue((int)settings->post.spectrumThreads);
+#ifndef HAVE_FFTW_THREADS
+    threadsSpinBox->setEnabled(false);
+#endif
+
+    segmentLengthLabel = new QLabel(tr("Segment length"));
+    segmentLengthSpinBox = new QSpinBox();
+    segmentLengthSpinBox->setMinimum(0);
+    segmentLengthSpinBox->setMaximum(1 << 20);
+    segmentLengthSpinBox->setSingleStep(256);
+    segmentLengthSpinBox->setSpecialValueText(tr("Whole record"));
+    segmentLengthSpinBox->setSuffix(tr(" S"));
+    segmentLengthSpinBox->setValue((int)settings->post.spectrumSegmentLength);
+
+    overlapLabel = new QLabel(tr("Segment overlap"));
+    overlapSpinBox = new QSpinBox();
+    overlapSpinBox->setMinimum(0);
+    overlapSpinBox->setMaximum(95);
+    overlapSpinBox->setSingleStep(5);
+    overlapSpinBox->setSuffix(tr(" %"));
+    overlapSpinBox->setValue((int)(settings->post.spectrumOverlap * 100 + 0.5));
+
+    averagingLabel = new QLabel(tr("Averaging"));
+    averagingComboBox = new QComboBox();
+    for (Dso::SpectrumAveraging averaging : Dso::SpectrumAveragingEnum)
+        averagingComboBox->addItem(Dso::spectrumAveragingString(averaging));
+    averagingComboBox->setCurrentIndex((int)settings->post.spectrumAveraging);
+
+    averageFramesLabel = new QLabel(tr("Averaged frames"));
+    averageFramesSpinBox = new QSpinBox();
+    averageFramesSpinBox->setMinimum(1);
+    averageFramesSpinBox->setMaximum(1000);
+    averageFramesSpinBox->setValue((int)settings->post.spectrumFrames);
+
     spectrumLayout = new QGridLayout();
     spectrumLayout->addWidget(windowFunctionLabel, 0, 0);
     spectrumLayout->addWidget(windowFunctionComboBox, 0, 1);
@@ -46,20 +106,225 @@ DsoConfigAnalysisPage::DsoConfigAnalysisPage(DsoSettings *settings, QWidget *par
     spectrumLayout->addLayout(referenceLevelLayout, 1, 1);
     spectrumLayout->addWidget(minimumMagnitudeLabel, 2, 0);
     spectrumLayout->addLayout(minimumMagnitudeLayout, 2, 1);
+    spectrumLayout->addWidget(segmentLengthLabel, 3, 0);
+    spectrumLayout->addWidget(segmentLengthSpinBox, 3, 1);
+    spectrumLayout->addWidget(overlapLabel, 4, 0);
+    spectrumLayout->addWidget(overlapSpinBox, 4, 1);
+    spectrumLayout->addWidget(averagingLabel, 5, 0);
+    spectrumLayout->addWidget(averagingComboBox, 5, 1);
+    spectrumLayout->addWidget(averageFramesLabel, 6, 0);
+    spectrumLayout->addWidget(averageFramesSpinBox, 6, 1);
+    spectrumLayout->addWidget(zoomCheckBox, 7, 0, 1, 2);
+    spectrumLayout->addWidget(decimationLabel, 8, 0);
+    spectrumLayout->addWidget(decimationSpinBox, 8, 1);
+    spectrumLayout->addWidget(singlePrecisionCheckBox, 9, 0, 1, 2);
+    spectrumLayout->addWidget(threadsLabel, 10, 0);
+    spectrumLayout->addWidget(threadsSpinBox, 10, 1);
 
     spectrumGroup = new QGroupBox(tr("Spectrum"));
     spectrumGroup->setLayout(spectrumLayout);
 
+    spectrogramCheckBox = new QCheckBox(tr("Show waterfall"));
+    spectrogramCheckBox->setChecked(settings->post.spectrogram);
+    spectrogramRowsLabel = new QLabel(tr("Frames"));
+    spectrogramRowsSpinBox = new QSpinBox();
+    spectrogramRowsSpinBox->setMinimum(16);
+    spectrogramRowsSpinBox->setMaximum(4096);
+    spectrogramRowsSpinBox->setValue((int)settings->post.spectrogramRows);
+
+    spectrogramLayout = new QGridLayout();
+    spectrogramLayout->addWidget(spectrogramCheckBox, 0, 0, 1, 2);
+    spectrogramLayout->addWidget(spectrogramRowsLabel, 1, 0);
+    spectrogramLayout->addWidget(spectrogramRowsSpinBox, 1, 1);
+
+    spectrogramGroup = new QGroupBox(tr("Waterfall"));
+    spectrogramGroup->setLayout(spectrogramLayout);
+
+    mathExpressionLabel = new QLabel(tr("Expression"));
+    mathExpressionLineEdit = new QLineEdit(settings->post.mathExpression);
+    mathExpressionLineEdit->setToolTip(tr("Used by the math mode \"Expression\". Supports + - * /, CH1 ... CH%1, "
+                                          "pi, e, abs(), sqrt(), log(), integrate() and differentiate()")
+                                           .arg(settings->scope.countChannels() - 1));
+    mathExpressionStatusLabel = new QLabel();
+    mathExpressionStatusLabel->setWordWrap(true);
+    // Check the expression while typing, the math channel itself only compiles it once per change
+    auto checkExpression = [this, settings](const QString &text) {
+        MathExpression expression;
+        // The last voltage channel is the math channel
+        if (expression.compile(text, settings->scope.countChannels() - 1))
+            mathExpressionStatusLabel->clear();
+        else
+            mathExpressionStatusLabel->setText(expression.error());
+    };
+    checkExpression(mathExpressionLineEdit->text());
+    connect(mathExpressionLineEdit, &QLineEdit::textChanged, checkExpression);
+
+    mathLayout = new QGridLayout();
+    mathLayout->addWidget(mathExpressionLabel, 0, 0);
+    mathLayout->addWidget(mathExpressionLineEdit, 0, 1);
+    mathLayout->addWidget(mathExpressionStatusLabel, 1, 0, 1, 2);
+
+    mathGroup = new QGroupBox(tr("Math channel"));
+    mathGroup->setLayout(mathLayout);
+
+    // The filters are edited one channel at a time
+    filters = settings->post.filter;
+    filterChannelLabel = new QLabel(tr("Channel"));
+    filterChannelComboBox = new QComboBox();
+    for (ChannelID channel = 0; channel < filters.size(); ++channel)
+        filterChannelComboBox->addItem(settings->scope.voltage[channel].name);
+    filterTypeLabel = new QLabel(tr("Type"));
+    filterTypeComboBox = new QComboBox();
+    for (Dso::FilterType type : Dso::FilterTypeEnum) filterTypeComboBox->addItem(Dso::filterTypeString(type));
+    filterDesignLabel = new QLabel(tr("Design"));
+    filterDesignComboBox = new QComboBox();
+    for (Dso::FilterDesign design : Dso::FilterDesignEnum)
+        filterDesignComboBox->addItem(Dso::filterDesignString(design));
+    filterFrequencyLabel = new QLabel(tr("Frequency"));
+    filterFrequencySiSpinBox = new SiSpinBox(UNIT_HERTZ);
+    filterFrequencySiSpinBox->setMinimum(1e-3);
+    filterFrequencySiSpinBox->setMaximum(1e9);
+    filterFrequencySiSpinBox->setToolTip(tr("Cutoff frequency of low- and high-pass, center of band-pass and notch"));
+    filterBandwidthLabel = new QLabel(tr("Bandwidth"));
+    filterBandwidthSiSpinBox = new SiSpinBox(UNIT_HERTZ);
+    filterBandwidthSiSpinBox->setMinimum(1e-3);
+    filterBandwidthSiSpinBox->setMaximum(1e9);
+    filterOrderLabel = new QLabel(tr("Order"));
+    filterOrderSpinBox = new QSpinBox();
+    filterOrderSpinBox->setMinimum(1);
+    filterOrderSpinBox->setMaximum(16);
+    filterTapsLabel = new QLabel(tr("Taps"));
+    filterTapsSpinBox = new QSpinBox();
+    filterTapsSpinBox->setMinimum(3);
+    filterTapsSpinBox->setMaximum(16383);
+    filterTapsSpinBox->setSingleStep(2);
+    filterTapsSpinBox->setToolTip(tr("Filters with more than 64 taps are computed with the FFT"));
+    showFilter(0);
+
+    connect(filterChannelComboBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            [this](int index) { showFilter(index); });
+    connect(filterTypeComboBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            [this](int index) {
+                filters[(unsigned)filterChannelComboBox->currentIndex()].type = (Dso::FilterType)index;
+                updateFilterControls();
+            });
+    connect(filterDesignComboBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            [this](int index) {
+                filters[(unsigned)filterChannelComboBox->currentIndex()].design = (Dso::FilterDesign)index;
+                updateFilterControls();
+            });
+    connect(filterFrequencySiSpinBox, static_cast<void (QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged),
+            [this](double value) { filters[(unsigned)filterChannelComboBox->currentIndex()].frequency = value; });
+    connect(filterBandwidthSiSpinBox, static_cast<void (QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged),
+            [this](double value) { filters[(unsigned)filterChannelComboBox->currentIndex()].bandwidth = value; });
+    connect(filterOrderSpinBox, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            [this](int value) { filters[(unsigned)filterChannelComboBox->currentIndex()].order = (unsigned)value; });
+    connect(filterTapsSpinBox, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), [this](int value) {
+        // Only odd lengths have a center tap, which keeps the filter linear phase without delay
+        filters[(unsigned)filterChannelComboBox->currentIndex()].taps = (unsigned)value | 1;
+    });
+
+    filterLayout = new QGridLayout();
+    filterLayout->addWidget(filterChannelLabel, 0, 0);
+    filterLayout->addWidget(filterChannelComboBox, 0, 1);
+    filterLayout->addWidget(filterTypeLabel, 1, 0);
+    filterLayout->addWidget(filterTypeComboBox, 1, 1);
+    filterLayout->addWidget(filterDesignLabel, 2, 0);
+    filterLayout->addWidget(filterDesignComboBox, 2, 1);
+    filterLayout->addWidget(filterFrequencyLabel, 3, 0);
+    filterLayout->addWidget(filterFrequencySiSpinBox, 3, 1);
+    filterLayout->addWidget(filterBandwidthLabel, 4, 0);
+    filterLayout->addWidget(filterBandwidthSiSpinBox, 4, 1);
+    filterLayout->addWidget(filterOrderLabel, 5, 0);
+    filterLayout->addWidget(filterOrderSpinBox, 5, 1);
+    filterLayout->addWidget(filterTapsLabel, 6, 0);
+    filterLayout->addWidget(filterTapsSpinBox, 6, 1);
+
+    filterGroup = new QGroupBox(tr("Filter"));
+    filterGroup->setLayout(filterLayout);
+
+    envelopeCheckBox = new QCheckBox(tr("Show min/max envelope"));
+    envelopeCheckBox->setChecked(settings->post.envelope);
+    envelopeFramesLabel = new QLabel(tr("Frames"));
+    envelopeFramesSpinBox = new QSpinBox();
+    envelopeFramesSpinBox->setMinimum(0);
+    envelopeFramesSpinBox->setMaximum(1000);
+    envelopeFramesSpinBox->setSpecialValueText(tr("Unlimited"));
+    envelopeFramesSpinBox->setValue(settings->post.envelopeFrames);
+
+    envelopeLayout = new QGridLayout();
+    envelopeLayout->addWidget(envelopeCheckBox, 0, 0, 1, 2);
+    envelopeLayout->addWidget(envelopeFramesLabel, 1, 0);
+    envelopeLayout->addWidget(envelopeFramesSpinBox, 1, 1);
+
+    envelopeGroup = new QGroupBox(tr("Envelope"));
+    envelopeGroup->setLayout(envelopeLayout);
+
     mainLayout = new QVBoxLayout();
     mainLayout->addWidget(spectrumGroup);
+    mainLayout->addWidget(spectrogramGroup);
+    mainLayout->addWidget(envelopeGroup);
+    mainLayout->addWidget(mathGroup);
+    mainLayout->addWidget(filterGroup);
     mainLayout->addStretch(1);
 
     setLayout(mainLayout);
 }
 
+/// \brief Shows the filter of the given channel.
+void DsoConfigAnalysisPage::showFilter(int channel) {
+    if (channel < 0 || (unsigned)channel >= filters.size()) return;
+    // Copy first, the value changed handlers write into the filter
+    const DsoSettingsFilter filter = filters[(unsigned)channel];
+    QSignalBlocker typeBlocker(filterTypeComboBox);
+    QSignalBlocker designBlocker(filterDesignComboBox);
+    QSignalBlocker frequencyBlocker(filterFrequencySiSpinBox);
+    QSignalBlocker bandwidthBlocker(filterBandwidthSiSpinBox);
+    QSignalBlocker orderBlocker(filterOrderSpinBox);
+    QSignalBlocker tapsBlocker(filterTapsSpinBox);
+    filterTypeComboBox->setCurrentIndex((int)filter.type);
+    filterDesignComboBox->setCurrentIndex((int)filter.design);
+    filterFrequencySiSpinBox->setValue(filter.frequency);
+    filterBandwidthSiSpinBox->setValue(filter.bandwidth);
+    filterOrderSpinBox->setValue((int)filter.order);
+    filterTapsSpinBox->setValue((int)filter.taps);
+    updateFilterControls();
+}
+
+/// \brief Enables the filter parameters that are used by the selected type and design.
+void DsoConfigAnalysisPage::updateFilterControls() {
+    const Dso::FilterType type = (Dso::FilterType)filterTypeComboBox->currentIndex();
+    const bool iir = (Dso::FilterDesign)filterDesignComboBox->currentIndex() == Dso::FilterDesign::IIR;
+    const bool active = type != Dso::FilterType::OFF;
+    const bool band = type == Dso::FilterType::BANDPASS || type == Dso::FilterType::NOTCH;
+
+    filterDesignComboBox->setEnabled(active);
+    filterFrequencySiSpinBox->setEnabled(active);
+    filterBandwidthSiSpinBox->setEnabled(active && band);
+    filterOrderSpinBox->setEnabled(active && iir);
+    filterTapsSpinBox->setEnabled(active && !iir);
+}
+
 /// \brief Saves the new settings.
 void DsoConfigAnalysisPage::saveSettings() {
     settings->post.spectrumWindow = (Dso::WindowFunction)windowFunctionComboBox->currentIndex();
     settings->post.spectrumReference = referenceLevelSpinBox->value();
     settings->post.spectrumLimit = minimumMagnitudeSpinBox->value();
+    settings->post.spectrumSegmentLength = (unsigned)segmentLengthSpinBox->value();
+    settings->post.spectrumOverlap = overlapSpinBox->value() / 100.0;
+    settings->post.spectrumAveraging = (Dso::SpectrumAveraging)averagingComboBox->currentIndex();
+    settings->post.spectrumFrames = (unsigned)averageFramesSpinBox->value();
+    settings->post.spectrumZoom = zoomCheckBox->isChecked();
+    settings->post.spectrumDecimation = (unsigned)decimationSpinBox->value();
+    settings->post.spectrumSinglePrecision = singlePrecisionCheckBox->isChecked();
+    settings->post.spectrumThreads = (unsigned)threadsSpinBox->value();
+    settings->post.spectrogram = spectrogramCheckBox->isChecked();
+    settings->post.spectrogramRows = (unsigned)spectrogramRowsSpinBox->value();
+    settings->post.envelope = envelopeCheckBox->isChecked();
+    settings->post.envelopeFrames = (unsigned)envelopeFramesSpinBox->value();
+    {
+        QMutexLocker locker(&settings->post.mathExpressionMutex);
+        settings->post.mathExpression = mathExpressionLineEdit->text();
+    }
+    settings->post.filter = filters;
 }
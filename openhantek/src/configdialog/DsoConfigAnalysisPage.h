@@ -11,9 +11,14 @@
 #include <QGroupBox>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QLineEdit>
 #include <QSpinBox>
 #include <QVBoxLayout>
 
+#include <vector>
+
+class SiSpinBox;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \class DsoConfigAnalysisPage                                   configpages.h
 /// \brief Config page for the data analysis.
@@ -27,7 +32,11 @@ class DsoConfigAnalysisPage : public QWidget {
     void saveSettings();
 
   private:
+    void showFilter(int channel);
+    void updateFilterControls();
+
     DsoSettings *settings;
+    std::vector<DsoSettingsFilter> filters; ///< The edited filters, written back by saveSettings()
 
     QVBoxLayout *mainLayout;
 
@@ -45,4 +54,56 @@ class DsoConfigAnalysisPage : public QWidget {
     QDoubleSpinBox *minimumMagnitudeSpinBox;
     QLabel *minimumMagnitudeUnitLabel;
     QHBoxLayout *minimumMagnitudeLayout;
+
+    QLabel *segmentLengthLabel;
+    QSpinBox *segmentLengthSpinBox;
+    QLabel *overlapLabel;
+    QSpinBox *overlapSpinBox;
+    QLabel *averagingLabel;
+    QComboBox *averagingComboBox;
+    QLabel *averageFramesLabel;
+    QSpinBox *averageFramesSpinBox;
+
+    QCheckBox *zoomCheckBox;
+    QLabel *decimationLabel;
+    QSpinBox *decimationSpinBox;
+
+    QCheckBox *singlePrecisionCheckBox;
+    QLabel *threadsLabel;
+    QSpinBox *threadsSpinBox;
+
+    QGroupBox *spectrogramGroup;
+    QGridLayout *spectrogramLayout;
+    QCheckBox *spectrogramCheckBox;
+    QLabel *spectrogramRowsLabel;
+    QSpinBox *spectrogramRowsSpinBox;
+
+    QGroupBox *mathGroup;
+    QGridLayout *mathLayout;
+    QLabel *mathExpressionLabel;
+    QLineEdit *mathExpressionLineEdit;
+    QLabel *mathExpressionStatusLabel;
+
+    QGroupBox *filterGroup;
+    QGridLayout *filterLayout;
+    QLabel *filterChannelLabel;
+    QComboBox *filterChannelComboBox;
+    QLabel *filterTypeLabel;
+    QComboBox *filterTypeComboBox;
+    QLabel *filterDesignLabel;
+    QComboBox *filterDesignComboBox;
+    QLabel *filterFrequencyLabel;
+    SiSpinBox *filterFrequencySiSpinBox;
+    QLabel *filterBandwidthLabel;
+    SiSpinBox *filterBandwidthSiSpinBox;
+    QLabel *filterOrderLabel;
+    QSpinBox *filterOrderSpinBox;
+    QLabel *filterTapsLabel;
+    QSpinBox *filterTapsSpinBox;
+
+    QGroupBox *envelopeGroup;
+    QGridLayout *envelopeLayout;
+    QCheckBox *envelopeCheckBox;
+    QLabel *envelopeFramesLabel;
+    QSpinBox *envelopeFramesSpinBox;
 };
@@ -2,6 +2,8 @@
 
 #include "DsoConfigFilesPage.h"
 
+#include <algorithm>
+
 DsoConfigFilesPage::DsoConfigFilesPage(DsoSettings *settings, QWidget *parent) : QWidget(parent), settings(settings) {
     // Export group
     screenColorCheckBox = new QCheckBox(tr("Export Images with Screen Colors"));
@@ -17,6 +19,13 @@ DsoConfigFilesPage::DsoConfigFilesPage(DsoSettings *settings, QWidget *parent) :
     imageHeightSpinBox->setMinimum(100);
     imageHeightSpinBox->setMaximum(9999);
     imageHeightSpinBox->setValue(settings->exporting.imageSize.height());
+    exportSizeLabel = new QLabel(tr("Recording limit"));
+    exportSizeSpinBox = new QSpinBox();
+    exportSizeSpinBox->setMinimum(1);
+    exportSizeSpinBox->setMaximum(1024 * 1024);
+    exportSizeSpinBox->setSuffix(tr(" MB"));
+    exportSizeSpinBox->setToolTip(tr("Size of the data that continuous exporters record before they are saved"));
+    exportSizeSpinBox->setValue((int)std::max<uint64_t>(1, settings->exporting.exportSizeBytes / (1024 * 1024)));
 
     exportLayout = new QGridLayout();
     exportLayout->addWidget(screenColorCheckBox, 0, 0, 1, 2);
@@ -24,6 +33,8 @@ DsoConfigFilesPage::DsoConfigFilesPage(DsoSettings *settings, QWidget *parent) :
     exportLayout->addWidget(imageWidthSpinBox, 1, 1);
     exportLayout->addWidget(imageHeightLabel, 2, 0);
     exportLayout->addWidget(imageHeightSpinBox, 2, 1);
+    exportLayout->addWidget(exportSizeLabel, 3, 0);
+    exportLayout->addWidget(exportSizeSpinBox, 3, 1);
 
     exportGroup = new QGroupBox(tr("Export"));
     exportGroup->setLayout(exportLayout);
@@ -57,4 +68,5 @@ void DsoConfigFilesPage::saveSettings() {
     settings->view.screenColorImages = screenColorCheckBox->isChecked();
     settings->exporting.imageSize.setWidth(imageWidthSpinBox->value());
     settings->exporting.imageSize.setHeight(imageHeightSpinBox->value());
+    settings->exporting.exportSizeBytes = (uint64_t)exportSizeSpinBox->value() * 1024 * 1024;
 }
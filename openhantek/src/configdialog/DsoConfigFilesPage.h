@@ -44,4 +44,6 @@ class DsoConfigFilesPage : public QWidget {
     QSpinBox *imageWidthSpinBox;
     QLabel *imageHeightLabel;
     QSpinBox *imageHeightSpinBox;
+    QLabel *exportSizeLabel;
+    QSpinBox *exportSizeSpinBox;
 };
@@ -5,13 +5,23 @@
 DsoConfigScopePage::DsoConfigScopePage(DsoSettings *settings, QWidget *parent) : QWidget(parent), settings(settings) {
     // Initialize lists for comboboxes
     QStringList interpolationStrings;
-    interpolationStrings << tr("Off") << tr("Linear");
+    interpolationStrings << tr("Off") << tr("Linear") << tr("Sin(x)/x");
 
     // Initialize elements
     interpolationLabel = new QLabel(tr("Interpolation"));
     interpolationComboBox = new QComboBox();
     interpolationComboBox->addItems(interpolationStrings);
     interpolationComboBox->setCurrentIndex(settings->view.interpolation);
+    dotSizeLabel = new QLabel(tr("Dot size"));
+    dotSizeSpinBox = new QSpinBox();
+    dotSizeSpinBox->setMinimum(1);
+    dotSizeSpinBox->setMaximum(8);
+    dotSizeSpinBox->setSuffix(tr(" px"));
+    dotSizeSpinBox->setToolTip(tr("Size of the sample dots if the interpolation is off"));
+    dotSizeSpinBox->setValue((int)settings->view.dotSize);
+    dotSizeSpinBox->setEnabled(settings->view.interpolation == Dso::INTERPOLATION_OFF);
+    connect(interpolationComboBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            [this](int index) { dotSizeSpinBox->setEnabled(index == Dso::INTERPOLATION_OFF); });
     digitalPhosphorDepthLabel = new QLabel(tr("Digital phosphor depth"));
     digitalPhosphorDepthSpinBox = new QSpinBox();
     digitalPhosphorDepthSpinBox->setMinimum(2);
@@ -21,8 +31,10 @@ DsoConfigScopePage::DsoConfigScopePage(DsoSettings *settings, QWidget *parent) :
     graphLayout = new QGridLayout();
     graphLayout->addWidget(interpolationLabel, 1, 0);
     graphLayout->addWidget(interpolationComboBox, 1, 1);
-    graphLayout->addWidget(digitalPhosphorDepthLabel, 2, 0);
-    graphLayout->addWidget(digitalPhosphorDepthSpinBox, 2, 1);
+    graphLayout->addWidget(dotSizeLabel, 2, 0);
+    graphLayout->addWidget(dotSizeSpinBox, 2, 1);
+    graphLayout->addWidget(digitalPhosphorDepthLabel, 3, 0);
+    graphLayout->addWidget(digitalPhosphorDepthSpinBox, 3, 1);
 
     graphGroup = new QGroupBox(tr("Graph"));
     graphGroup->setLayout(graphLayout);
@@ -40,9 +52,19 @@ DsoConfigScopePage::DsoConfigScopePage(DsoSettings *settings, QWidget *parent) :
     cursorsGroup = new QGroupBox(tr("Cursors"));
     cursorsGroup->setLayout(cursorsLayout);
 
+    detailedMeasurementsCheckBox = new QCheckBox(tr("Show all measurements"));
+    detailedMeasurementsCheckBox->setChecked(settings->view.detailedMeasurements);
+
+    measurementsLayout = new QGridLayout();
+    measurementsLayout->addWidget(detailedMeasurementsCheckBox, 0, 0);
+
+    measurementsGroup = new QGroupBox(tr("Measurements"));
+    measurementsGroup->setLayout(measurementsLayout);
+
     mainLayout = new QVBoxLayout();
     mainLayout->addWidget(graphGroup);
     mainLayout->addWidget(cursorsGroup);
+    mainLayout->addWidget(measurementsGroup);
     mainLayout->addStretch(1);
 
     setLayout(mainLayout);
@@ -51,6 +73,8 @@ DsoConfigScopePage::DsoConfigScopePage(DsoSettings *settings, QWidget *parent) :
 /// \brief Saves the new settings.
 void DsoConfigScopePage::saveSettings() {
     settings->view.interpolation = (Dso::InterpolationMode)interpolationComboBox->currentIndex();
+    settings->view.dotSize = (unsigned)dotSizeSpinBox->value();
     settings->view.digitalPhosphorDepth = digitalPhosphorDepthSpinBox->value();
     settings->view.cursorGridPosition = (Qt::ToolBarArea)cursorsComboBox->currentData().toUInt();
+    settings->view.detailedMeasurements = detailedMeasurementsCheckBox->isChecked();
 }
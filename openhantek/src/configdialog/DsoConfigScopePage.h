@@ -37,9 +37,15 @@ class DsoConfigScopePage : public QWidget {
     QSpinBox *digitalPhosphorDepthSpinBox;
     QLabel *interpolationLabel;
     QComboBox *interpolationComboBox;
+    QLabel *dotSizeLabel;
+    QSpinBox *dotSizeSpinBox;
 
     QGroupBox *cursorsGroup;
     QGridLayout *cursorsLayout;
     QLabel *cursorsLabel;
     QComboBox *cursorsComboBox;
+
+    QGroupBox *measurementsGroup;
+    QGridLayout *measurementsLayout;
+    QCheckBox *detailedMeasurementsCheckBox;
 };
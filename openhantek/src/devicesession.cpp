@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include <QDebug>
+#include <QStatusBar>
+
+#include <algorithm>
+
+#include "devicesession.h"
+
+// Settings
+#include "settings.h"
+#include "viewconstants.h"
+
+// DSO core logic
+#include "dsomodel.h"
+#include "hantekdsocontrol.h"
+#include "usb/usbdevice.h"
+
+// Post processing
+#include "post/envelopegenerator.h"
+#include "post/filterprocessor.h"
+#include "post/frequencycounter.h"
+#include "post/graphgenerator.h"
+#include "post/mathchannelgenerator.h"
+#include "post/measurementgenerator.h"
+#include "post/postprocessing.h"
+#include "post/softwaretrigger.h"
+#include "post/spectrogramgenerator.h"
+#include "post/spectrumgenerator.h"
+#include "post/windowfunction.h"
+
+// Exporter
+#include "exporting/exportcsv.h"
+#include "exporting/exporterprocessor.h"
+#include "exporting/exporterregistry.h"
+#include "exporting/exportimage.h"
+#include "exporting/exportprint.h"
+#include "exporting/exportsigrok.h"
+#include "exporting/exportwav.h"
+
+// Servers
+#include "ipc/frameserver.h"
+#include "remote/scpiserver.h"
+
+// GUI
+#include "mainwindow.h"
+
+DeviceSession::DeviceSession(std::unique_ptr<USBDevice> device, unsigned index, QThread *postProcessingThread,
+                             const QString &serverSocket, const QString &scpiAddress)
+    : device(std::move(device)), devicePort(this->device->getUniqueUSBDeviceID()), index(index) {
+    const Dso::ControlSpecification *spec = this->device->getModel()->spec();
+    // Appended to the names of the second and further devices
+    const QString suffix = index ? QString("-%1").arg(index + 1) : QString();
+
+    //////// Create DSO control object and move it to a separate thread ////////
+    dsoControlThread.setObjectName("dsoControlThread" + suffix);
+    dsoControl.reset(new HantekDsoControl(this->device.get()));
+    dsoControl->moveToThread(&dsoControlThread);
+    QObject::connect(&dsoControlThread, &QThread::started, dsoControl.get(), &HantekDsoControl::run);
+    // Emitted in the control thread, queued so that nothing arrives after the session has been destroyed
+    QObject::connect(dsoControl.get(), &HantekDsoControl::communicationError, this, &DeviceSession::lostConnection,
+                     Qt::QueuedConnection);
+    QObject::connect(this->device.get(), &USBDevice::deviceDisconnected, this, &DeviceSession::lostConnection,
+                     Qt::QueuedConnection);
+    QObject::connect(this, &DeviceSession::reconnectFinished, this, &DeviceSession::finishReconnect,
+                     Qt::QueuedConnection);
+    retryTimer.setInterval(1000);
+    QObject::connect(&retryTimer, &QTimer::timeout, this, [this]() { reconnect(nullptr); });
+
+    //////// Create settings object ////////
+    settings.reset(new DsoSettings(spec, index ? QString("device%1").arg(index + 1) : QString()));
+
+    //////// Create exporters ////////
+    exportRegistry.reset(new ExporterRegistry(spec, settings.get()));
+
+    exporters.emplace_back(new ExporterCSV);
+    exporters.emplace_back(new ExporterImage);
+    exporters.emplace_back(new ExporterPrint);
+    exporters.emplace_back(new ExporterWAV(ExporterInterface::Type::SnapshotExport));
+    exporters.emplace_back(new ExporterWAV(ExporterInterface::Type::ContinousExport));
+    exporters.emplace_back(new ExporterSigrok);
+    for (const std::unique_ptr<ExporterInterface> &exporter : exporters)
+        exportRegistry->registerExporter(exporter.get());
+
+    //////// Create post processing objects ////////
+    postProcessing.reset(new PostProcessing(settings->scope.countChannels()));
+    windowCache.reset(new WindowCache);
+
+    DsoSettingsScope *scope = &settings->scope;
+    DsoSettingsPostProcessing *post = &settings->post;
+    const bool isSoftwareTriggerDevice = spec->isSoftwareTriggerDevice;
+
+    processors.emplace_back(new ExporterProcessor(exportRegistry.get()));
+    processors.emplace_back(new MathChannelGenerator(scope, post, spec->channels));
+    // The math channel is computed from the unfiltered channels, everything below sees the filtered samples
+    processors.emplace_back(new FilterProcessor(scope, post, windowCache.get()));
+    // The software trigger may use the math channel as source, every processor below uses its trigger point
+    processors.emplace_back(new SoftwareTrigger(scope, isSoftwareTriggerDevice));
+    processors.emplace_back(new EnvelopeGenerator(scope, post, isSoftwareTriggerDevice));
+    processors.emplace_back(new MeasurementGenerator(scope));
+    processors.emplace_back(new FrequencyCounter(scope));
+    processors.emplace_back(new SpectrumGenerator(scope, post, windowCache.get(), isSoftwareTriggerDevice));
+    processors.emplace_back(new SpectrogramGenerator(scope, post));
+    processors.emplace_back(new GraphGenerator(scope, &settings->view, isSoftwareTriggerDevice));
+    for (const std::unique_ptr<Processor> &processor : processors) postProcessing->registerProcessor(processor.get());
+
+    postProcessing->moveToThread(postProcessingThread);
+    QObject::connect(dsoControl.get(), &HantekDsoControl::samplesAvailable, postProcessing.get(),
+                     &PostProcessing::input);
+    QObject::connect(postProcessing.get(), &PostProcessing::processingFinished, exportRegistry.get(),
+                     &ExporterRegistry::input, Qt::DirectConnection);
+
+    //////// Create frame server ////////
+    frameServer.reset(new FrameServer(scope));
+    if (!serverSocket.isEmpty()) {
+        QString errorMessage;
+        if (frameServer->start(serverSocket + suffix, errorMessage))
+            QObject::connect(postProcessing.get(), &PostProcessing::processingFinished, frameServer.get(),
+                             &FrameServer::input, Qt::DirectConnection);
+        else
+            qWarning() << errorMessage;
+    }
+
+    //////// Create remote control ////////
+    scpiServer.reset(new ScpiServer(dsoControl.get(), settings.get()));
+    if (!scpiAddress.isEmpty()) {
+        // The following devices use the next ports
+        bool isPort = false;
+        unsigned port = scpiAddress.toUInt(&isPort);
+        const QString address = isPort ? QString::number(port + index) : scpiAddress + suffix;
+
+        ScpiServer *server = scpiServer.get();
+        server->moveToThread(&dsoControlThread);
+        QObject::connect(&dsoControlThread, &QThread::started, server,
+                         [server, address]() { server->listen(address); });
+        QObject::connect(&dsoControlThread, &QThread::finished, server, &ScpiServer::close, Qt::DirectConnection);
+        QObject::connect(postProcessing.get(), &PostProcessing::processingFinished, server, &ScpiServer::input,
+                         Qt::DirectConnection);
+    }
+
+    //////// Create main window ////////
+    mainWindow.reset(new MainWindow(dsoControl.get(), settings.get(), exportRegistry.get()));
+    if (index) mainWindow->setWindowTitle(mainWindow->windowTitle() + QString(" - #%1").arg(index + 1));
+    QObject::connect(postProcessing.get(), &PostProcessing::processingFinished, mainWindow.get(),
+                     &MainWindow::showNewData);
+    QObject::connect(exportRegistry.get(), &ExporterRegistry::exporterProgressChanged, mainWindow.get(),
+                     &MainWindow::exporterProgressChanged);
+    QObject::connect(exportRegistry.get(), &ExporterRegistry::exporterStatusChanged, mainWindow.get(),
+                     &MainWindow::exporterStatusChanged);
+    if (!scpiAddress.isEmpty()) mainWindow->connectRemoteControl(scpiServer.get());
+}
+
+DeviceSession::~DeviceSession() {}
+
+void DeviceSession::start() {
+    mainWindow->show();
+
+    applySettingsToDevice(settings->scope);
+
+    dsoControl->enableSampling(true);
+    dsoControlThread.start();
+}
+
+void DeviceSession::stop() {
+    retryTimer.stop();
+    dsoControlThread.quit();
+    dsoControlThread.wait(10000);
+}
+
+void DeviceSession::reconnect(std::unique_ptr<USBDevice> replacement) {
+    if (replacement) ++pendingReplacements;
+    std::shared_ptr<USBDevice> candidate(std::move(replacement));
+    // The settings belong to the GUI thread, the device gets the values they have now
+    const DsoSettingsScope scope = settings->scope;
+    QTimer::singleShot(0, dsoControl.get(), [this, candidate, scope]() {
+        // Another attempt has been successful already
+        if (device->isConnected()) {
+            emit reconnectFinished(false, candidate != nullptr, device->getUniqueUSBDeviceID());
+            return;
+        }
+
+        QString errorMessage;
+        bool connected =
+            device->reconnectDevice(candidate ? candidate->getRawDevice() : device->getRawDevice(), errorMessage);
+        if (connected) {
+            applySettingsToDevice(scope);
+            if (dsoControl->resumeCommunication() != Dso::ErrorCode::NONE) {
+                device->disconnectFromDevice();
+                connected = false;
+            }
+        }
+        emit reconnectFinished(connected, candidate != nullptr, device->getUniqueUSBDeviceID());
+    });
+}
+
+void DeviceSession::lostConnection() {
+    if (lost) return;
+    lost = true;
+
+    mainWindow->statusBar()->showMessage(tr("Connection to the device lost, waiting for it to be plugged in again"));
+    // Close the device after communication errors, the control thread stops at its next cycle
+    USBDevice *usbDevice = device.get();
+    QTimer::singleShot(0, dsoControl.get(), [usbDevice]() { usbDevice->disconnectFromDevice(); });
+    retryTimer.start();
+    emit connectionLost();
+}
+
+void DeviceSession::finishReconnect(bool connected, bool replacement, UniqueUSBid port) {
+    if (replacement) --pendingReplacements;
+    devicePort = port;
+    if (!connected || !lost) return;
+
+    lost = false;
+    retryTimer.stop();
+    mainWindow->statusBar()->showMessage(tr("Device connected again"), 3000);
+}
+
+void DeviceSession::applySettingsToDevice(const DsoSettingsScope &scope) {
+    const Dso::ControlSpecification *spec = device->getModel()->spec();
+
+    bool mathUsed = scope.anyUsed(spec->channels);
+    for (ChannelID channel = 0; channel < spec->channels; ++channel) {
+        dsoControl->setCoupling(channel, scope.coupling(channel, spec));
+        dsoControl->setGain(channel, scope.gain(channel) * DIVS_VOLTAGE);
+        dsoControl->setOffset(channel, (scope.voltage[channel].offset / DIVS_VOLTAGE) + 0.5);
+        dsoControl->setTriggerLevel(channel, scope.voltage[channel].trigger);
+        dsoControl->setChannelUsed(channel, mathUsed | scope.anyUsed(channel));
+    }
+
+    if (scope.horizontal.samplerateSource == DsoSettingsScopeHorizontal::Samplerrate)
+        dsoControl->setSamplerate(scope.horizontal.samplerate);
+    else
+        dsoControl->setRecordTime(scope.horizontal.timebase * DIVS_TIME);
+
+    if (dsoControl->getAvailableRecordLengths().empty())
+        dsoControl->setRecordLength(scope.horizontal.recordLength);
+    else {
+        auto recLenVec = dsoControl->getAvailableRecordLengths();
+        ptrdiff_t lengthIndex = std::distance(
+            recLenVec.begin(), std::find(recLenVec.begin(), recLenVec.end(), scope.horizontal.recordLength));
+        dsoControl->setRecordLength(lengthIndex < 0 ? 1 : (unsigned)lengthIndex);
+    }
+    dsoControl->setTriggerMode(scope.trigger.mode);
+    dsoControl->setPretriggerPosition(scope.trigger.position * scope.horizontal.timebase * DIVS_TIME);
+    dsoControl->setTriggerSlope(scope.trigger.slope);
+    dsoControl->setTriggerSource(scope.trigger.special, scope.trigger.source);
+}
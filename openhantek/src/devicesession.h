@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+
+#include <memory>
+#include <vector>
+
+#include "usb/usbdevice.h"
+
+class DsoSettings;
+class ExporterInterface;
+class ExporterRegistry;
+class FrameServer;
+class HantekDsoControl;
+class MainWindow;
+class PostProcessing;
+class Processor;
+class ScpiServer;
+class WindowCache;
+struct DsoSettingsScope;
+
+/// \brief Everything that is needed to use one oscilloscope: The device control in its own thread, the
+/// settings, the post processing chain, the exporters, the optional servers and the main window.
+/// Several sessions run side by side if more than one device is used. Their frames carry host time stamps
+/// of the same clock, so the frames of different devices can be aligned by other programs.
+/// If the connection to the device is lost, the session keeps its window and settings and waits for the
+/// device: It retries the same device every second and takes the one a DeviceWatcher finds after replugging.
+class DeviceSession : public QObject {
+    Q_OBJECT
+  public:
+    /// \param device The connected device, the session takes it over.
+    /// \param index 0 for the first device. The other devices use their own settings and their own server
+    /// addresses, with the number of the device appended.
+    /// \param postProcessingThread The thread that runs the post processing, it may be shared by several sessions.
+    /// \param serverSocket The socket for the frame server, empty if the frames are not published.
+    /// \param scpiAddress The TCP port or socket for the remote control, empty if there is no remote control.
+    DeviceSession(std::unique_ptr<USBDevice> device, unsigned index, QThread *postProcessingThread,
+                  const QString &serverSocket, const QString &scpiAddress);
+    ~DeviceSession();
+
+    /// Applies the settings to the device, starts sampling and shows the main window.
+    void start();
+    /// Stops the device control thread. The post processing threads are stopped by the caller.
+    void stop();
+
+    /// The device of the session, it may be found on another port after the connection has been lost.
+    inline const USBDevice *getDevice() const { return device.get(); }
+    /// The port of the device. The device itself changes it in the device control thread while reconnecting, this
+    /// copy is updated in the GUI thread when the reconnection has finished.
+    inline UniqueUSBid getDevicePort() const { return devicePort; }
+    /// true, if the connection to the device has been lost.
+    inline bool isLost() const { return lost; }
+    /// true, if the connection has been lost and no replacement device is being connected.
+    inline bool isWaitingForDevice() const { return lost && !pendingReplacements; }
+
+    /// \brief Connects the session again, in the device control thread.
+    /// \param replacement The device of the same model found by the DeviceWatcher, nullptr to retry the
+    /// current device.
+    void reconnect(std::unique_ptr<USBDevice> replacement);
+
+  signals:
+    void connectionLost(); ///< The session waits for its device
+    /// A reconnection attempt has finished in the device control thread
+    void reconnectFinished(bool connected, bool replacement, UniqueUSBid port);
+
+  private slots:
+    void lostConnection();
+    void finishReconnect(bool connected, bool replacement, UniqueUSBid port);
+
+  private:
+    /// \brief Initialize the device with the given settings.
+    /// Called in the device control thread while it runs, the settings have to be a copy then.
+    void applySettingsToDevice(const DsoSettingsScope &scope);
+
+    std::unique_ptr<USBDevice> device;
+    UniqueUSBid devicePort; ///< Only accessed in the GUI thread
+    const unsigned index;
+
+    QThread dsoControlThread;
+    std::unique_ptr<HantekDsoControl> dsoControl;
+    std::unique_ptr<DsoSettings> settings;
+
+    // The registry waits for running exports when it is destroyed, before the exporters
+    std::vector<std::unique_ptr<ExporterInterface>> exporters;
+    std::unique_ptr<ExporterRegistry> exportRegistry;
+
+    std::unique_ptr<PostProcessing> postProcessing;
+    std::unique_ptr<WindowCache> windowCache;
+    std::vector<std::unique_ptr<Processor>> processors;
+
+    std::unique_ptr<FrameServer> frameServer;
+    std::unique_ptr<ScpiServer> scpiServer;
+    std::unique_ptr<MainWindow> mainWindow;
+
+    bool lost = false;
+    unsigned pendingReplacements = 0; ///< Replacement devices that are being connected
+    QTimer retryTimer;                ///< Retries the current device while the connection is lost
+};
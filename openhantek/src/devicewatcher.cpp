@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include <QDebug>
+
+#include <algorithm>
+
+#include "devicewatcher.h"
+
+#include "devicesession.h"
+#include "usb/uploadFirmware.h"
+
+DeviceWatcher::DeviceWatcher(libusb_context *context, const std::vector<std::unique_ptr<DeviceSession>> &sessions)
+    : sessions(sessions), findDevices(context) {
+    pollTimer.setInterval(1000);
+    connect(&pollTimer, &QTimer::timeout, this, &DeviceWatcher::updateDevices);
+
+    int errorCode = findDevices.enableHotplug();
+    if (errorCode == LIBUSB_SUCCESS)
+        connect(&findDevices, &FindDevices::devicesChanged, this, &DeviceWatcher::updateDevices,
+                Qt::QueuedConnection);
+    else
+        qDebug() << "No USB hotplug events, the bus is enumerated instead:" << libUsbErrorString(errorCode);
+
+    for (const std::unique_ptr<DeviceSession> &session : sessions)
+        connect(session.get(), &DeviceSession::connectionLost, this, &DeviceWatcher::updateDevices);
+}
+
+void DeviceWatcher::updateDevices() {
+    findDevices.updateDeviceList();
+
+    bool waiting = std::any_of(sessions.begin(), sessions.end(), [](const std::unique_ptr<DeviceSession> &session) {
+        return session->isWaitingForDevice();
+    });
+    if (!waiting) {
+        pollTimer.stop();
+        return;
+    }
+    if (!findDevices.isHotplugEnabled() && !pollTimer.isActive()) pollTimer.start();
+
+    // takeDevice() changes the list
+    std::vector<UniqueUSBid> ids;
+    for (const auto &entry : *findDevices.getDevices()) ids.push_back(entry.first);
+
+    for (UniqueUSBid id : ids) {
+        DeviceSession *session = findWaitingSession(id, findDevices.getDevices()->at(id).get());
+        if (!session) continue;
+
+        std::unique_ptr<USBDevice> device = findDevices.takeDevice(id);
+        if (device->needsFirmware()) {
+            // The device arrives again with the firmware
+            UploadFirmware uploadFirmware;
+            if (!uploadFirmware.startUpload(device.get())) qWarning() << uploadFirmware.getErrorMessage();
+            continue;
+        }
+        session->reconnect(std::move(device));
+    }
+}
+
+DeviceSession *DeviceWatcher::findWaitingSession(UniqueUSBid id, const USBDevice *device) const {
+    DeviceSession *waitingSession = nullptr;
+    for (const std::unique_ptr<DeviceSession> &session : sessions) {
+        if (!session->isLost()) {
+            if (session->getDevicePort() == id) return nullptr;
+        } else if (session->isWaitingForDevice() && session->getDevice()->getModel() == device->getModel()) {
+            // Prefer the session whose device was plugged into the same port
+            if (!waitingSession || session->getDevicePort() == id) waitingSession = session.get();
+        }
+    }
+    return waitingSession;
+}
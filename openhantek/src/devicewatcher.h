@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+
+#include <memory>
+#include <vector>
+
+#include "usb/finddevices.h"
+
+class DeviceSession;
+struct libusb_context;
+
+/// \brief Finds the devices of the sessions that lost their connection, when they are plugged in again.
+/// Listens to libusb hotplug events if the platform supports them. Otherwise the bus is enumerated every
+/// second, but only while a session waits for its device. A device without firmware gets it uploaded first,
+/// it then arrives again with the firmware and is handed over to a waiting session of the same model.
+class DeviceWatcher : public QObject {
+    Q_OBJECT
+  public:
+    /// \param context The usb context, do not close it before this object is destroyed.
+    /// \param sessions The sessions of all devices, they have to outlive this object.
+    DeviceWatcher(libusb_context *context, const std::vector<std::unique_ptr<DeviceSession>> &sessions);
+
+  private slots:
+    void updateDevices();
+
+  private:
+    /// \return The waiting session for the device, nullptr if no session waits or a session uses the device.
+    DeviceSession *findWaitingSession(UniqueUSBid id, const USBDevice *device) const;
+
+    const std::vector<std::unique_ptr<DeviceSession>> &sessions;
+    FindDevices findDevices;
+    QTimer pollTimer;
+};
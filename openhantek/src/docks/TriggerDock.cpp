@@ -24,6 +24,10 @@ TriggerDock::TriggerDock(DsoSettingsScope *scope, const Dso::ControlSpecificatio
     // Initialize lists for comboboxes
     for (ChannelID channel = 0; channel < mSpec->channels; ++channel)
         this->sourceStandardStrings << tr("CH%1").arg(channel + 1);
+    // The software trigger runs after the math channel has been computed, so it can trigger on it as well
+    if (mSpec->isSoftwareTriggerDevice)
+        for (ChannelID channel = mSpec->channels; channel < scope->voltage.size(); ++channel)
+            this->sourceStandardStrings << scope->voltage[channel].name;
     for (const Dso::SpecialTriggerChannel &specialTrigger : mSpec->specialTriggerChannels)
         this->sourceSpecialStrings.append(QString::fromStdString(specialTrigger.name));
 
@@ -51,6 +55,99 @@ TriggerDock::TriggerDock(DsoSettingsScope *scope, const Dso::ControlSpecificatio
     this->dockLayout->addWidget(this->slopeLabel, 2, 0);
     this->dockLayout->addWidget(this->slopeComboBox, 2, 1);
 
+    // The software trigger offers more event types than the single edge trigger of the hardware
+    if (mSpec->isSoftwareTriggerDevice) {
+        this->typeLabel = new QLabel(tr("Type"));
+        this->typeComboBox = new QComboBox();
+        for (Dso::TriggerType type : Dso::TriggerTypeEnum) this->typeComboBox->addItem(Dso::triggerTypeString(type));
+        this->typeComboBox->setCurrentIndex((int)scope->trigger.swTriggerType);
+
+        this->pulseConditionLabel = new QLabel(tr("Width"));
+        this->pulseConditionComboBox = new QComboBox();
+        for (Dso::PulseCondition condition : Dso::PulseConditionEnum)
+            this->pulseConditionComboBox->addItem(Dso::pulseConditionString(condition));
+        this->pulseConditionComboBox->setCurrentIndex((int)scope->trigger.swTriggerPulseCondition);
+
+        this->windowConditionLabel = new QLabel(tr("Window"));
+        this->windowConditionComboBox = new QComboBox();
+        for (Dso::WindowCondition condition : Dso::WindowConditionEnum)
+            this->windowConditionComboBox->addItem(Dso::windowConditionString(condition));
+        this->windowConditionComboBox->setCurrentIndex((int)scope->trigger.swTriggerWindowCondition);
+
+        this->timeLabel = new QLabel(tr("Time"));
+        this->timeSiSpinBox = new SiSpinBox(UNIT_SECONDS);
+        this->timeSiSpinBox->setMinimum(1e-9);
+        this->timeSiSpinBox->setMaximum(3.6e3);
+        this->timeSiSpinBox->setValue(scope->trigger.swTriggerTime);
+
+        this->timeUpperLabel = new QLabel(tr("Max. time"));
+        this->timeUpperSiSpinBox = new SiSpinBox(UNIT_SECONDS);
+        this->timeUpperSiSpinBox->setMinimum(1e-9);
+        this->timeUpperSiSpinBox->setMaximum(3.6e3);
+        this->timeUpperSiSpinBox->setValue(scope->trigger.swTriggerTimeUpper);
+
+        this->levelUpperLabel = new QLabel(tr("Level 2"));
+        this->levelUpperSpinBox = new QDoubleSpinBox();
+        this->levelUpperSpinBox->setRange(-1000.0, 1000.0);
+        this->levelUpperSpinBox->setDecimals(3);
+        this->levelUpperSpinBox->setSingleStep(0.1);
+        this->levelUpperSpinBox->setSuffix(tr(" V"));
+        this->levelUpperSpinBox->setValue(scope->trigger.swTriggerLevelUpper);
+
+        this->hysteresisLabel = new QLabel(tr("Hysteresis"));
+        this->hysteresisSpinBox = new QDoubleSpinBox();
+        this->hysteresisSpinBox->setRange(0.0, 2.0);
+        this->hysteresisSpinBox->setDecimals(2);
+        this->hysteresisSpinBox->setSingleStep(0.05);
+        this->hysteresisSpinBox->setSuffix(tr(" div"));
+        this->hysteresisSpinBox->setToolTip(tr("The signal has to leave this band around the level before the next "
+                                               "crossing is accepted, so noise doesn't trigger"));
+        this->hysteresisSpinBox->setValue(scope->trigger.swTriggerHysteresis);
+
+        this->dockLayout->addWidget(this->typeLabel, 3, 0);
+        this->dockLayout->addWidget(this->typeComboBox, 3, 1);
+        this->dockLayout->addWidget(this->pulseConditionLabel, 4, 0);
+        this->dockLayout->addWidget(this->pulseConditionComboBox, 4, 1);
+        this->dockLayout->addWidget(this->windowConditionLabel, 5, 0);
+        this->dockLayout->addWidget(this->windowConditionComboBox, 5, 1);
+        this->dockLayout->addWidget(this->timeLabel, 6, 0);
+        this->dockLayout->addWidget(this->timeSiSpinBox, 6, 1);
+        this->dockLayout->addWidget(this->timeUpperLabel, 7, 0);
+        this->dockLayout->addWidget(this->timeUpperSiSpinBox, 7, 1);
+        this->dockLayout->addWidget(this->levelUpperLabel, 8, 0);
+        this->dockLayout->addWidget(this->levelUpperSpinBox, 8, 1);
+        this->dockLayout->addWidget(this->hysteresisLabel, 9, 0);
+        this->dockLayout->addWidget(this->hysteresisSpinBox, 9, 1);
+        updateSoftwareTriggerControls();
+
+        // The post processing reads these settings for every frame, there is nothing to send to the device
+        connect(this->typeComboBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+                [this](int index) {
+                    this->scope->trigger.swTriggerType = (Dso::TriggerType)index;
+                    updateSoftwareTriggerControls();
+                });
+        connect(this->pulseConditionComboBox,
+                static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [this](int index) {
+                    this->scope->trigger.swTriggerPulseCondition = (Dso::PulseCondition)index;
+                    updateSoftwareTriggerControls();
+                });
+        connect(this->windowConditionComboBox,
+                static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [this](int index) {
+                    this->scope->trigger.swTriggerWindowCondition = (Dso::WindowCondition)index;
+                });
+        connect(this->timeSiSpinBox, static_cast<void (QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged),
+                [this](double value) { this->scope->trigger.swTriggerTime = value; });
+        connect(this->timeUpperSiSpinBox,
+                static_cast<void (QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged),
+                [this](double value) { this->scope->trigger.swTriggerTimeUpper = value; });
+        connect(this->levelUpperSpinBox,
+                static_cast<void (QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged),
+                [this](double value) { this->scope->trigger.swTriggerLevelUpper = value; });
+        connect(this->hysteresisSpinBox,
+                static_cast<void (QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged),
+                [this](double value) { this->scope->trigger.swTriggerHysteresis = value; });
+    }
+
     this->dockWidget = new QWidget();
     SetupDockWidget(this, dockWidget, dockLayout);
 
@@ -93,6 +190,26 @@ void TriggerDock::closeEvent(QCloseEvent *event) {
     event->accept();
 }
 
+void TriggerDock::updateSoftwareTriggerControls() {
+    const Dso::TriggerType type = scope->trigger.swTriggerType;
+    const bool pulse = type == Dso::TriggerType::PulseWidth;
+    const bool window = type == Dso::TriggerType::Window;
+    const bool time = pulse || type == Dso::TriggerType::Timeout;
+    const bool timeUpper = pulse && scope->trigger.swTriggerPulseCondition == Dso::PulseCondition::Inside;
+    const bool levelUpper = window || type == Dso::TriggerType::Runt;
+
+    pulseConditionLabel->setVisible(pulse);
+    pulseConditionComboBox->setVisible(pulse);
+    windowConditionLabel->setVisible(window);
+    windowConditionComboBox->setVisible(window);
+    timeLabel->setVisible(time);
+    timeSiSpinBox->setVisible(time);
+    timeUpperLabel->setVisible(timeUpper);
+    timeUpperSiSpinBox->setVisible(timeUpper);
+    levelUpperLabel->setVisible(levelUpper);
+    levelUpperSpinBox->setVisible(levelUpper);
+}
+
 void TriggerDock::setMode(Dso::TriggerMode mode) {
     int index = std::find(mSpec->triggerModes.begin(), mSpec->triggerModes.end(), mode) - mSpec->triggerModes.begin();
     QSignalBlocker blocker(modeComboBox);
@@ -7,6 +7,7 @@
 #include <QLabel>
 #include <QCheckBox>
 #include <QComboBox>
+#include <QDoubleSpinBox>
 
 #include "hantekdso/enums.h"
 
@@ -44,6 +45,8 @@ class TriggerDock : public QDockWidget {
 
   protected:
     void closeEvent(QCloseEvent *event);
+    /// \brief Shows the software trigger settings that are used by the selected trigger type.
+    void updateSoftwareTriggerControls();
 
     QGridLayout *dockLayout;   ///< The main layout for the dock window
     QWidget *dockWidget;       ///< The main widget for the dock window
@@ -54,6 +57,21 @@ class TriggerDock : public QDockWidget {
     QComboBox *sourceComboBox; ///< Select the source for triggering
     QComboBox *slopeComboBox;  ///< Select the slope that causes triggering
 
+    QLabel *typeLabel = nullptr;                    ///< The label for the software trigger type combobox
+    QComboBox *typeComboBox = nullptr;              ///< Select the event the software trigger is looking for
+    QLabel *pulseConditionLabel = nullptr;          ///< The label for the pulse condition combobox
+    QComboBox *pulseConditionComboBox = nullptr;    ///< Select the accepted pulse widths
+    QLabel *windowConditionLabel = nullptr;         ///< The label for the window condition combobox
+    QComboBox *windowConditionComboBox = nullptr;   ///< Select entering or leaving the window
+    QLabel *timeLabel = nullptr;                    ///< The label for the pulse width/timeout spinbox
+    SiSpinBox *timeSiSpinBox = nullptr;             ///< Pulse width or timeout
+    QLabel *timeUpperLabel = nullptr;               ///< The label for the upper pulse width spinbox
+    SiSpinBox *timeUpperSiSpinBox = nullptr;        ///< Upper pulse width of the range condition
+    QLabel *levelUpperLabel = nullptr;              ///< The label for the second level spinbox
+    QDoubleSpinBox *levelUpperSpinBox = nullptr;    ///< Second level of the runt and window triggers
+    QLabel *hysteresisLabel = nullptr;              ///< The label for the hysteresis spinbox
+    QDoubleSpinBox *hysteresisSpinBox = nullptr;    ///< Noise band around the trigger levels
+
     DsoSettingsScope *scope; ///< The settings provided by the parent class
     const Dso::ControlSpecification* mSpec;
 
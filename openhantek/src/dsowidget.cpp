@@ -130,13 +130,19 @@ DsoWidget::DsoWidget(DsoSettingsScope *scope, DsoSettingsView *view, const Dso::
         measurementFrequencyLabel.push_back(new QLabel());
         measurementFrequencyLabel[channel]->setAlignment(Qt::AlignRight);
         measurementFrequencyLabel[channel]->setPalette(palette);
+        measurementDetailsLabel.push_back(new QLabel());
+        measurementDetailsLabel[channel]->setIndent(5);
+        measurementDetailsLabel[channel]->setPalette(palette);
+        measurementDetailsLabel[channel]->setVisible(false);
         setMeasurementVisible(channel);
-        measurementLayout->addWidget(measurementNameLabel[channel], (int)channel, 0);
-        measurementLayout->addWidget(measurementMiscLabel[channel], (int)channel, 1);
-        measurementLayout->addWidget(measurementGainLabel[channel], (int)channel, 2);
-        measurementLayout->addWidget(measurementMagnitudeLabel[channel], (int)channel, 3);
-        measurementLayout->addWidget(measurementAmplitudeLabel[channel], (int)channel, 4);
-        measurementLayout->addWidget(measurementFrequencyLabel[channel], (int)channel, 5);
+        const int row = (int)channel * 2;
+        measurementLayout->addWidget(measurementNameLabel[channel], row, 0);
+        measurementLayout->addWidget(measurementMiscLabel[channel], row, 1);
+        measurementLayout->addWidget(measurementGainLabel[channel], row, 2);
+        measurementLayout->addWidget(measurementMagnitudeLabel[channel], row, 3);
+        measurementLayout->addWidget(measurementAmplitudeLabel[channel], row, 4);
+        measurementLayout->addWidget(measurementFrequencyLabel[channel], row, 5);
+        measurementLayout->addWidget(measurementDetailsLabel[channel], row + 1, 1, 1, 5);
         if ((unsigned)channel < spec->channels)
             updateVoltageCoupling((unsigned)channel);
         else
@@ -316,7 +322,7 @@ void DsoWidget::setupSliders(DsoWidget::Sliders &sliders) {
 
     // The sliders for the trigger levels
     sliders.triggerLevelSlider = new LevelSlider(Qt::LeftArrow);
-    for (ChannelID channel = 0; channel < spec->channels; ++channel) {
+    for (ChannelID channel = 0; channel < triggerChannels(); ++channel) {
         sliders.triggerLevelSlider->addSlider((int)channel);
         sliders.triggerLevelSlider->setColor(channel,
                                              (!scope->trigger.special && channel == scope->trigger.source)
@@ -338,6 +344,10 @@ void DsoWidget::setupSliders(DsoWidget::Sliders &sliders) {
     }
 }
 
+ChannelID DsoWidget::triggerChannels() const {
+    return spec->isSoftwareTriggerDevice ? scope->countChannels() : spec->channels;
+}
+
 /// \brief Set the trigger level sliders minimum and maximum to the new values.
 void DsoWidget::adaptTriggerLevelSlider(DsoWidget::Sliders &sliders, ChannelID channel) {
     sliders.triggerLevelSlider->setLimits((int)channel,
@@ -361,6 +371,10 @@ void DsoWidget::setMeasurementVisible(ChannelID channel) {
         measurementAmplitudeLabel[channel]->setText(QString());
         measurementFrequencyLabel[channel]->setText(QString());
     }
+    if (!scope->voltage[channel].used) {
+        measurementDetailsLabel[channel]->setVisible(false);
+        measurementDetailsLabel[channel]->setText(QString());
+    }
 
     measurementGainLabel[channel]->setVisible(scope->voltage[channel].used);
     if (!scope->voltage[channel].used) { measurementGainLabel[channel]->setText(QString()); }
@@ -471,6 +485,29 @@ void DsoWidget::updateVoltageDetails(ChannelID channel) {
         measurementGainLabel[channel]->setText(QString());
 }
 
+/// \brief Update the line with all automatic measurements of a channel
+void DsoWidget::updateMeasurementDetails(ChannelID channel, const Measurements &measurements) {
+    bool visible = view->detailedMeasurements && scope->voltage[channel].used && measurements.valid;
+    measurementDetailsLabel[channel]->setVisible(visible);
+    if (!visible) return;
+
+    measurementDetailsLabel[channel]->setText(
+        tr("Min %1  Max %2  Mean %3  RMS %4  AC RMS %5  Top %6  Base %7  Overshoot %8  Rise %9  Fall %10  "
+           "Duty %11  Period %12")
+            .arg(valueToString(measurements.minimum, UNIT_VOLTS, 4))
+            .arg(valueToString(measurements.maximum, UNIT_VOLTS, 4))
+            .arg(valueToString(measurements.mean, UNIT_VOLTS, 4))
+            .arg(valueToString(measurements.rms, UNIT_VOLTS, 4))
+            .arg(valueToString(measurements.acRms, UNIT_VOLTS, 4))
+            .arg(valueToString(measurements.top, UNIT_VOLTS, 4))
+            .arg(valueToString(measurements.base, UNIT_VOLTS, 4))
+            .arg(tr("%L1%").arg(measurements.overshoot, 0, 'f', 1))
+            .arg(valueToString(measurements.riseTime, UNIT_SECONDS, 3))
+            .arg(valueToString(measurements.fallTime, UNIT_SECONDS, 3))
+            .arg(tr("%L1%").arg(measurements.dutyCycle, 0, 'f', 1))
+            .arg(valueToString(measurements.period, UNIT_SECONDS, 4)));
+}
+
 /// \brief Handles frequencybaseChanged signal from the horizontal dock.
 /// \param frequencybase The frequencybase used for displaying the trace.
 void DsoWidget::updateFrequencybase(double frequencybase) {
@@ -519,7 +556,7 @@ void DsoWidget::updateTriggerSlope() { updateTriggerDetails(); }
 /// \brief Handles sourceChanged signal from the trigger dock.
 void DsoWidget::updateTriggerSource() {
     // Change the colors of the trigger sliders
-    if (scope->trigger.special || scope->trigger.source >= spec->channels) {
+    if (scope->trigger.special || scope->trigger.source >= triggerChannels()) {
         mainSliders.triggerPositionSlider->setColor(0, view->screen.border);
         zoomSliders.triggerPositionSlider->setColor(0, view->screen.border);
     } else {
@@ -527,7 +564,7 @@ void DsoWidget::updateTriggerSource() {
         zoomSliders.triggerPositionSlider->setColor(0, view->screen.voltage[scope->trigger.source]);
     }
 
-    for (ChannelID channel = 0; channel < spec->channels; ++channel) {
+    for (ChannelID channel = 0; channel < triggerChannels(); ++channel) {
         QColor color = (!scope->trigger.special && channel == scope->trigger.source)
                            ? view->screen.voltage[channel]
                            : view->screen.voltage[channel].darker();
@@ -557,7 +594,7 @@ void DsoWidget::updateMathMode() {
 void DsoWidget::updateVoltageGain(ChannelID channel) {
     if (channel >= (unsigned int)scope->voltage.size()) return;
 
-    if (channel < spec->channels) {
+    if (channel < triggerChannels()) {
         adaptTriggerLevelSlider(mainSliders, channel);
         adaptTriggerLevelSlider(zoomSliders, channel);
     }
@@ -637,6 +674,7 @@ void DsoWidget::showNew(std::shared_ptr<PPresult> data) {
             // Frequency string representation (5 significant digits)
             measurementFrequencyLabel[channel]->setText(
                 valueToString(data.get()->data(channel)->frequency, UNIT_HERTZ, 5));
+            updateMeasurementDetails(channel, data.get()->data(channel)->measurements);
         }
     }
 }
@@ -662,7 +700,7 @@ void DsoWidget::updateOffset(ChannelID channel, double value) {
     if (channel < scope->voltage.size()) {
         scope->voltage[channel].offset = value;
 
-        if (channel < spec->channels) {
+        if (channel < triggerChannels()) {
             adaptTriggerLevelSlider(mainSliders, channel);
             adaptTriggerLevelSlider(zoomSliders, channel);
         }
@@ -760,6 +798,26 @@ void DsoWidget::updateTriggerLevel(ChannelID channel, double value) {
     emit triggerLevelChanged(channel, value);
 }
 
+void DsoWidget::setOffset(ChannelID channel, double value) {
+    const QSignalBlocker blocker(this);
+    updateOffset(channel, value);
+}
+
+void DsoWidget::setTriggerLevel(ChannelID channel, double value) {
+    if (channel >= triggerChannels()) return;
+    const QSignalBlocker blocker(this);
+    updateTriggerLevel(channel, value);
+}
+
+void DsoWidget::setTriggerPosition(double position) {
+    const QSignalBlocker blocker(this);
+    {
+        const QSignalBlocker sliderBlocker(mainSliders.triggerPositionSlider);
+        mainSliders.triggerPositionSlider->setValue(0, position);
+    }
+    updateTriggerPosition(0, position);
+}
+
 /// \brief Handles valueChanged signal from the marker slider.
 /// \param marker The index of the slider.
 /// \param value The new marker position.
@@ -15,6 +15,7 @@
 class SpectrumGenerator;
 struct DsoSettingsScope;
 struct DsoSettingsView;
+struct Measurements;
 class DataGrid;
 
 /// \brief The widget for the oszilloscope-screen
@@ -41,16 +42,24 @@ class DsoWidget : public QWidget {
     // Data arrived
     void showNew(std::shared_ptr<PPresult> data);
 
+    /// \brief Moves the sliders to values that have been set elsewhere, without emitting the changed signals.
+    void setOffset(ChannelID channel, double value);
+    void setTriggerLevel(ChannelID channel, double value);
+    void setTriggerPosition(double position);
+
   protected:
     virtual void showEvent(QShowEvent *event);
     void setupSliders(Sliders &sliders);
     void adaptTriggerLevelSlider(DsoWidget::Sliders &sliders, ChannelID channel);
+    /// \brief Number of channels with a trigger level, the math channel is a trigger source for the software trigger.
+    ChannelID triggerChannels() const;
     void adaptTriggerPositionSlider();
     void setMeasurementVisible(ChannelID channel);
     void updateMarkerDetails();
     void updateSpectrumDetails(ChannelID channel);
     void updateTriggerDetails();
     void updateVoltageDetails(ChannelID channel);
+    void updateMeasurementDetails(ChannelID channel, const Measurements &measurements);
 
     double mainToZoom(double position) const;
     double zoomToMain(double position) const;
@@ -83,6 +92,7 @@ class DsoWidget : public QWidget {
     std::vector<QLabel *> measurementMiscLabel;      ///< Coupling or math mode
     std::vector<QLabel *> measurementAmplitudeLabel; ///< Amplitude of the signal (V)
     std::vector<QLabel *> measurementFrequencyLabel; ///< Frequency of the signal (Hz)
+    std::vector<QLabel *> measurementDetailsLabel;   ///< All automatic measurements of the signal
 
     DataGrid *cursorDataGrid;
 
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include <QFile>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "csvwriter.h"
+#include "post/ppresult.h"
+#include "scopesettings.h"
+#include "utils/numberformat.h"
+
+/// Rows that are formatted by one thread at once
+#define CSV_CHUNK_ROWS 16384
+
+CsvWriter::CsvWriter(std::shared_ptr<PPresult> data, const DsoSettingsScope *scope) : data(std::move(data)) {
+    const ChannelID channelCount = (ChannelID)scope->voltage.size();
+    double timeInterval = 0.0;
+    double frequencyInterval = 0.0;
+    std::vector<const std::vector<double> *> voltages;
+    std::vector<const std::vector<double> *> spectra;
+    QByteArray voltageNames;
+    QByteArray spectrumNames;
+
+    for (ChannelID channel = 0; channel < channelCount; ++channel) {
+        const DataChannel *channelData = this->data->data(channel);
+        if (!channelData) continue;
+        if (scope->voltage[channel].used) {
+            voltages.push_back(&channelData->voltage.sample);
+            voltageNames += ",\"" + scope->voltage[channel].name.toUtf8() + "\"";
+            rows = std::max(rows, channelData->voltage.sample.size());
+            timeInterval = channelData->voltage.interval;
+        }
+        if (scope->spectrum[channel].used) {
+            spectra.push_back(&channelData->spectrum.sample);
+            spectrumNames += ",\"" + scope->spectrum[channel].name.toUtf8() + "\"";
+            rows = std::max(rows, channelData->spectrum.sample.size());
+            frequencyInterval = channelData->spectrum.interval;
+        }
+    }
+
+    header = "\"t\"" + voltageNames;
+    addAxis(timeInterval);
+    for (const std::vector<double> *samples : voltages) columns.push_back({samples, 0.0, 0.0});
+    if (!spectra.empty()) {
+        header += ",\"f\"" + spectrumNames;
+        addAxis(frequencyInterval);
+        for (const std::vector<double> *samples : spectra) columns.push_back({samples, 0.0, 0.0});
+    }
+    header += '\n';
+}
+
+void CsvWriter::addAxis(double interval) {
+    // Dividing by an integer sample rate gives the exact decimal times (0.3 instead of 0.30000000000000004)
+    double rate = 0.0;
+    if (interval > 0.0) {
+        rate = std::round(1.0 / interval);
+        if (rate < 1.0 || std::abs(rate * interval - 1.0) > 1e-12) rate = 0.0;
+    }
+    columns.push_back({nullptr, interval, rate});
+}
+
+void CsvWriter::formatRows(size_t begin, size_t end, std::vector<char> &buffer) const {
+    // Every cell needs at most a separator and a number
+    buffer.resize((end - begin) * columns.size() * (SHORTEST_BUFFER_SIZE + 1));
+    char *output = buffer.data();
+
+    for (size_t row = begin; row < end; ++row) {
+        for (size_t index = 0; index < columns.size(); ++index) {
+            const Column &column = columns[index];
+            if (index) *output++ = ',';
+            if (!column.samples)
+                output = formatShortest(output, column.rate > 0.0 ? row / column.rate : row * column.interval);
+            else if (row < column.samples->size())
+                output = formatShortest(output, (*column.samples)[row]);
+        }
+        *output++ = '\n';
+    }
+    buffer.resize((size_t)(output - buffer.data()));
+}
+
+bool CsvWriter::write(const QString &fileName, const std::function<bool(float)> &progress) {
+    QFile csvFile(fileName);
+    if (!csvFile.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    if (csvFile.write(header) != header.size()) {
+        csvFile.remove();
+        return false;
+    }
+
+    const size_t chunkCount = (rows + CSV_CHUNK_ROWS - 1) / CSV_CHUNK_ROWS;
+    const size_t threadCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), chunkCount));
+    std::vector<std::vector<char>> buffers(threadCount);
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+
+    // Each pass formats one chunk per thread, the chunks are written in order after all threads are done
+    for (size_t firstChunk = 0; firstChunk < chunkCount; firstChunk += threadCount) {
+        const size_t passChunks = std::min(threadCount, chunkCount - firstChunk);
+        for (size_t index = 1; index < passChunks; ++index) {
+            const size_t begin = (firstChunk + index) * CSV_CHUNK_ROWS;
+            threads.emplace_back(&CsvWriter::formatRows, this, begin, std::min(rows, begin + CSV_CHUNK_ROWS),
+                                 std::ref(buffers[index]));
+        }
+        const size_t begin = firstChunk * CSV_CHUNK_ROWS;
+        formatRows(begin, std::min(rows, begin + CSV_CHUNK_ROWS), buffers[0]);
+        for (std::thread &thread : threads) thread.join();
+        threads.clear();
+
+        for (size_t index = 0; index < passChunks; ++index) {
+            const qint64 size = (qint64)buffers[index].size();
+            if (csvFile.write(buffers[index].data(), size) != size) {
+                csvFile.remove();
+                return false;
+            }
+        }
+        if (progress && !progress((float)std::min(rows, (firstChunk + passChunks) * CSV_CHUNK_ROWS) / rows)) {
+            csvFile.remove();
+            return false;
+        }
+    }
+
+    csvFile.close();
+    return csvFile.error() == QFile::NoError;
+}
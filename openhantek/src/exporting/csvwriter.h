@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct DsoSettingsScope;
+class PPresult;
+
+/// \brief Writes the voltage and spectrum samples of a post processing result into a CSV file.
+/// The numbers are written with formatShortest(), so every value reads back exactly. The rows are split into
+/// chunks that are formatted in parallel by several threads, each into its own reused buffer, and written to
+/// the file in order. write() may run in any thread, the constructor has to run in the thread that owns the
+/// settings.
+class CsvWriter {
+  public:
+    /// \param data The samples, they have to stay unchanged while writing.
+    /// \param scope The scope settings, used for the selection and names of the channels.
+    CsvWriter(std::shared_ptr<PPresult> data, const DsoSettingsScope *scope);
+
+    /// \brief Writes the file.
+    /// \param fileName The file that is created or overwritten.
+    /// \param progress Called with the written fraction of the rows (0 to 1) after each part of the file.
+    /// Writing is canceled if it returns false.
+    /// \return false if the file couldn't be written or writing has been canceled, the file is removed then.
+    bool write(const QString &fileName, const std::function<bool(float)> &progress = std::function<bool(float)>());
+
+    /// \return The number of data rows.
+    size_t rowCount() const { return rows; }
+
+  private:
+    /// \brief A column of the file, either a channel or the time/frequency axis.
+    struct Column {
+        const std::vector<double> *samples; ///< The channel samples, nullptr for an axis column
+        double interval;                    ///< Axis columns: The interval between two rows
+        double rate;                        ///< Axis columns: 1 / interval if that is an integer, otherwise 0
+    };
+
+    void addAxis(double interval);
+    /// \brief Formats the rows [begin, end) into the buffer, which is resized to the written length.
+    void formatRows(size_t begin, size_t end, std::vector<char> &buffer) const;
+
+    std::shared_ptr<PPresult> data;
+    QByteArray header;
+    std::vector<Column> columns;
+    size_t rows = 0;
+};
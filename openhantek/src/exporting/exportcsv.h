@@ -3,6 +3,8 @@
 #pragma once
 #include "exporterinterface.h"
 
+class CsvWriter;
+
 class ExporterCSV : public ExporterInterface
 {
 public:
@@ -12,8 +14,11 @@ public:
     virtual QString name() override;
     virtual Type type() override;
     virtual bool samples(const std::shared_ptr<PPresult>data) override;
-    virtual bool save() override;
+    virtual bool prepareSave() override;
+    virtual bool save(ExportControl *control) override;
     virtual float progress() override;
 private:
     std::shared_ptr<PPresult> data;
+    std::unique_ptr<CsvWriter> writer;
+    QString fileName;
 };
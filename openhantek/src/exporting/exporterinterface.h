@@ -5,17 +5,39 @@
 #include <QIcon>
 #include <QString>
 
+#include <atomic>
 #include <memory>
 
 class ExporterRegistry;
 class PPresult;
 
+/**
+ * Progress and cancellation of a running ExporterInterface::save(). The exporter reports its progress,
+ * the GUI may cancel the export at any time.
+ */
+class ExportControl {
+public:
+    /// Called by the exporter: The saved fraction of the data (0..1).
+    void setProgress(float value) { exportProgress = value; }
+    float progress() const { return exportProgress; }
+
+    /// Called by the GUI: Ask the exporter to stop as soon as possible.
+    void cancel() { canceled = true; }
+    /// The exporter should check this regularly and return false from save() if it is set.
+    bool isCanceled() const { return canceled; }
+
+private:
+    std::atomic<float> exportProgress{0.0f};
+    std::atomic<bool> canceled{false};
+};
+
 /**
  * Implement this interface and register your Exporter to the ExporterRegistry instance
  * in the main routine to make an Exporter available.
  */
 class ExporterInterface {
 public:
+    virtual ~ExporterInterface() {}
 
     /**
     * Starts up this exporter. Aquires resources etc. Do not call this directly, it
@@ -56,17 +78,26 @@ public:
      */
     virtual bool samples(const std::shared_ptr<PPresult>) = 0;
 
+    /**
+     * Exporter: Ask the user where and how to save the received data, e.g. with a file dialog.
+     * This method will be called in the GUI thread context right before save() and can create and
+     * show dialogs if required. Take everything you need from the settings here.
+     * @return Return true to continue with save() or false if the user aborted.
+     */
+    virtual bool prepareSave() = 0;
+
     /**
      * Exporter: Save your received data and perform any conversions necessary.
-     * This method will be called in the
-     * GUI thread context and can create and show dialogs if required.
+     * This method will be called in a worker thread of the ExporterRegistry after prepareSave(),
+     * do not access widgets or open dialogs here.
+     * @param control Report the progress here and return early if the export has been canceled.
      * @return Return true if saving succedded otherwise false.
      */
-    virtual bool save() = 0;
+    virtual bool save(ExportControl *control) = 0;
 
     /**
      * @brief The progress of receiving and processing samples. If the exporter returns 1, it will
-     * be called back by the GUI via the save() method.
+     * be called back by the GUI via the prepareSave() and save() methods.
      *
      * @return A number between 0..1 indicating the used capacity of this exporter. If this is a
      * snapshot exporter, only 0 for "no samples processed yet" or 1 for "finished" will be returned.
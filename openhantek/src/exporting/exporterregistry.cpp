@@ -3,6 +3,8 @@
 #include "exporterregistry.h"
 #include "exporterinterface.h"
 
+#include <QRunnable>
+
 #include <algorithm>
 
 #include "controlspecification.h"
@@ -11,7 +13,18 @@
 
 ExporterRegistry::ExporterRegistry(const Dso::ControlSpecification *deviceSpecification, DsoSettings *settings,
                                    QObject *parent)
-    : QObject(parent), deviceSpecification(deviceSpecification), settings(settings) {}
+    : QObject(parent), deviceSpecification(deviceSpecification), settings(settings) {
+    qRegisterMetaType<ExporterInterface *>();
+    // Finish the exports in the GUI thread, where the exporters are reset and reused
+    connect(this, &ExporterRegistry::saveFinished, this, &ExporterRegistry::exportFinished, Qt::QueuedConnection);
+    connect(&progressTimer, &QTimer::timeout, this, &ExporterRegistry::exporterProgressChanged);
+    progressTimer.setInterval(100);
+}
+
+ExporterRegistry::~ExporterRegistry() {
+    cancelExports();
+    threadPool.waitForDone();
+}
 
 bool ExporterRegistry::processData(std::shared_ptr<PPresult> &data, ExporterInterface *const &exporter) {
     if (!exporter->samples(data)) {
@@ -39,6 +52,12 @@ void ExporterRegistry::registerExporter(ExporterInterface *exporter) {
 }
 
 void ExporterRegistry::setExporterEnabled(ExporterInterface *exporter, bool enabled) {
+    // The exporter is in use by a worker thread
+    if (runningExporters.count(exporter)) {
+        emit exporterStatusChanged(exporter->name(), tr("Export in progress"));
+        return;
+    }
+
     bool wasInList = false;
     enabledExporters.remove_if([exporter, &wasInList](ExporterInterface *inlist) {
         if (inlist == exporter) {
@@ -67,16 +86,68 @@ void ExporterRegistry::setExporterEnabled(ExporterInterface *exporter, bool enab
     }
 }
 
+namespace {
+/// Runs ExporterInterface::save() in a thread of the pool.
+class ExportTask : public QRunnable {
+  public:
+    ExportTask(ExporterRegistry *registry, ExporterInterface *exporter, std::shared_ptr<ExportControl> control)
+        : registry(registry), exporter(exporter), control(std::move(control)) {}
+    void run() override { emit registry->saveFinished(exporter, exporter->save(control.get())); }
+
+  private:
+    ExporterRegistry *registry;
+    ExporterInterface *exporter;
+    std::shared_ptr<ExportControl> control;
+};
+} // namespace
+
 void ExporterRegistry::checkForWaitingExporters() {
-    for (ExporterInterface *exporter : waitToSaveExporters) {
-        if (exporter->save()) {
-            emit exporterStatusChanged(exporter->name(), tr("Data saved"));
-        } else {
+    // The dialogs of prepareSave() run an event loop that may call this again
+    std::set<ExporterInterface *> waiting;
+    waiting.swap(waitToSaveExporters);
+    for (ExporterInterface *exporter : waiting) {
+        if (!exporter->prepareSave()) {
             emit exporterStatusChanged(exporter->name(), tr("No data exported"));
+            exporter->create(this);
+            continue;
         }
-        exporter->create(this);
+        std::shared_ptr<ExportControl> control = std::make_shared<ExportControl>();
+        runningExporters[exporter] = control;
+        threadPool.start(new ExportTask(this, exporter, control));
+        emit exporterStatusChanged(exporter->name(), tr("Exporting..."));
     }
-    waitToSaveExporters.clear();
+    if (!runningExporters.empty() && !progressTimer.isActive()) progressTimer.start();
+}
+
+void ExporterRegistry::exportFinished(ExporterInterface *exporter, bool saved) {
+    auto running = runningExporters.find(exporter);
+    if (running == runningExporters.end()) return;
+    const bool canceled = running->second->isCanceled();
+    runningExporters.erase(running);
+    if (runningExporters.empty()) progressTimer.stop();
+
+    if (canceled) {
+        emit exporterStatusChanged(exporter->name(), tr("Export canceled"));
+    } else if (saved) {
+        emit exporterStatusChanged(exporter->name(), tr("Data saved"));
+    } else {
+        emit exporterStatusChanged(exporter->name(), tr("No data exported"));
+    }
+    exporter->create(this);
+    emit exporterProgressChanged();
+}
+
+unsigned ExporterRegistry::runningExports() const { return (unsigned)runningExporters.size(); }
+
+float ExporterRegistry::exportProgress() const {
+    if (runningExporters.empty()) return 0.0f;
+    float sum = 0.0f;
+    for (const auto &running : runningExporters) sum += running.second->progress();
+    return sum / runningExporters.size();
+}
+
+void ExporterRegistry::cancelExports() {
+    for (const auto &running : runningExporters) running.second->cancel();
 }
 
 std::vector<ExporterInterface *>::const_iterator ExporterRegistry::begin() { return exporters.begin(); }
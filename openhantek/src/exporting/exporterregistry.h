@@ -3,6 +3,10 @@
 #pragma once
 
 #include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+#include <list>
+#include <map>
 #include <memory>
 #include <set>
 #include <vector>
@@ -19,12 +23,15 @@ struct ControlSpecification;
 
 // Exporter forwards
 class ExporterInterface;
+class ExportControl;
 
 class ExporterRegistry : public QObject {
     Q_OBJECT
   public:
     explicit ExporterRegistry(const Dso::ControlSpecification *deviceSpecification, DsoSettings *settings,
                               QObject *parent = nullptr);
+    /// Cancels the running exports and waits for them.
+    ~ExporterRegistry();
 
     // Sample input. This will proably be performed in the post processing
     // thread context. Do not open GUI dialogs or interrupt the control flow.
@@ -34,8 +41,16 @@ class ExporterRegistry : public QObject {
     void registerExporter(ExporterInterface *exporter);
     void setExporterEnabled(ExporterInterface *exporter, bool enabled);
 
+    /// Asks the waiting exporters for the destination and starts saving in the worker threads.
     void checkForWaitingExporters();
 
+    /// @return The number of exports that are being saved at the moment.
+    unsigned runningExports() const;
+    /// @return The average progress of the running exports (0..1).
+    float exportProgress() const;
+    /// Cancels all running exports.
+    void cancelExports();
+
     // Iterate over this class object
     std::vector<ExporterInterface *>::const_iterator begin();
     std::vector<ExporterInterface *>::const_iterator end();
@@ -51,6 +66,12 @@ class ExporterRegistry : public QObject {
     std::list<ExporterInterface *> enabledExporters;
     /// List of exporters that wait to be called back by the user to save their work
     std::set<ExporterInterface *> waitToSaveExporters;
+    /// Exporters that are saving in a worker thread at the moment
+    std::map<ExporterInterface *, std::shared_ptr<ExportControl>> runningExporters;
+    /// Worker threads for ExporterInterface::save()
+    QThreadPool threadPool;
+    /// Reports the progress of the running exports
+    QTimer progressTimer;
 
     /// Process data from addRawSamples() or input() in the given exporter. Add the
     /// exporter to waitToSaveExporters if it finishes.
@@ -58,7 +79,14 @@ class ExporterRegistry : public QObject {
     /// @return Return true if the exporter has finished and want to be removed from the
     ///     enabledExporters list.
     bool processData(std::shared_ptr<PPresult> &data, ExporterInterface *const &exporter);
+    /// Called in the GUI thread when an exporter has finished saving.
+    void exportFinished(ExporterInterface *exporter, bool saved);
   signals:
     void exporterStatusChanged(const QString &exporterName, const QString &status);
+    /// An exporter is waiting to be saved or the progress of the running exports changed
     void exporterProgressChanged();
+    /// Emitted by the worker thread, see exportFinished()
+    void saveFinished(ExporterInterface *exporter, bool saved);
 };
+
+Q_DECLARE_METATYPE(ExporterInterface *)
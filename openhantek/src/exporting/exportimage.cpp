@@ -10,11 +10,16 @@
 
 #include <QCoreApplication>
 #include <QFileDialog>
+#include <QImage>
 #include <QPrinter>
 
 ExporterImage::ExporterImage() {}
 
-void ExporterImage::create(ExporterRegistry *registry) { this->registry = registry; data.reset(); }
+void ExporterImage::create(ExporterRegistry *registry) {
+    this->registry = registry;
+    data.reset();
+    paintDevice.reset();
+}
 
 QIcon ExporterImage::icon() { return iconFont->icon(fa::image); }
 
@@ -27,7 +32,7 @@ bool ExporterImage::samples(const std::shared_ptr<PPresult> data) {
     return false;
 }
 
-bool ExporterImage::save() {
+bool ExporterImage::prepareSave() {
     QStringList filters;
     filters << QCoreApplication::tr("Portable Document Format (*.pdf)")
             << QCoreApplication::tr("Image (*.png *.xpm *.jpg)");
@@ -37,33 +42,41 @@ bool ExporterImage::save() {
     fileDialog.setAcceptMode(QFileDialog::AcceptSave);
     if (fileDialog.exec() != QDialog::Accepted) return false;
 
-    bool isPdf = filters.indexOf(fileDialog.selectedNameFilter()) == 0;
-    std::unique_ptr<QPaintDevice> paintDevice;
+    isPdf = filters.indexOf(fileDialog.selectedNameFilter()) == 0;
+    fileName = fileDialog.selectedFiles().first();
 
-    const DsoSettingsColorValues *colorValues = &(registry->settings->view.print);
+    scope = registry->settings->scope;
+    colorValues = registry->settings->view.print;
+    zoom = registry->settings->view.zoom;
 
     if (!isPdf) {
-        // We need a QPixmap for image-export
-        QPixmap *qPixmap = new QPixmap(registry->settings->exporting.imageSize);
-        qPixmap->fill(colorValues->background);
-        paintDevice = std::unique_ptr<QPaintDevice>(qPixmap);
+        // We need a QImage for image-export, unlike a QPixmap it can be painted outside of the GUI thread
+        QImage *image = new QImage(registry->settings->exporting.imageSize, QImage::Format_ARGB32_Premultiplied);
+        image->fill(colorValues.background);
+        paintDevice = std::unique_ptr<QPaintDevice>(image);
     } else {
         // We need a QPrinter for printing, pdf- and ps-export
         std::unique_ptr<QPrinter> printer = std::unique_ptr<QPrinter>(new QPrinter(QPrinter::HighResolution));
-        printer->setOrientation(registry->settings->view.zoom ? QPrinter::Portrait : QPrinter::Landscape);
+        printer->setOrientation(zoom ? QPrinter::Portrait : QPrinter::Landscape);
         printer->setPageMargins(20, 20, 20, 20, QPrinter::Millimeter);
-        printer->setOutputFileName(fileDialog.selectedFiles().first());
+        printer->setOutputFileName(fileName);
         printer->setOutputFormat(QPrinter::PdfFormat);
         paintDevice = std::move(printer);
     }
 
-    if (!paintDevice) return false;
+    return paintDevice != nullptr;
+}
+
+bool ExporterImage::save(ExportControl *control) {
+    if (control->isCanceled()) return false;
 
-    LegacyExportDrawer::exportSamples(data.get(), paintDevice.get(), registry->deviceSpecification, registry->settings,
-                                      false, colorValues);
+    LegacyExportDrawer::exportSamples(data.get(), paintDevice.get(), registry->deviceSpecification, &scope, zoom,
+                                      false, &colorValues, &gridCache);
 
-    if (!isPdf) static_cast<QPixmap *>(paintDevice.get())->save(fileDialog.selectedFiles().first());
-    return true;
+    bool saved = true;
+    if (!isPdf) saved = static_cast<QImage *>(paintDevice.get())->save(fileName);
+    control->setProgress(1.0f);
+    return saved;
 }
 
 float ExporterImage::progress() { return data ? 1.0f : 0; }
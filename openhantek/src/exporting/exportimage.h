@@ -2,6 +2,11 @@
 
 #pragma once
 #include "exporterinterface.h"
+#include "legacyexportdrawer.h"
+#include "scopesettings.h"
+#include "viewsettings.h"
+
+#include <QPaintDevice>
 
 class ExporterImage : public ExporterInterface
 {
@@ -12,8 +17,17 @@ public:
     virtual QString name() override;
     virtual Type type() override;
     virtual bool samples(const std::shared_ptr<PPresult>data) override;
-    virtual bool save() override;
+    virtual bool prepareSave() override;
+    virtual bool save(ExportControl *control) override;
     virtual float progress() override;
 private:
     std::shared_ptr<PPresult> data;
+    /// The settings when the export was started, save() runs in a thread of its own
+    DsoSettingsScope scope;
+    DsoSettingsColorValues colorValues;
+    bool zoom = false;
+    LegacyExportDrawer::GridCache gridCache; ///< The grid layer is kept between the saves of this exporter
+    std::unique_ptr<QPaintDevice> paintDevice; ///< The image or the pdf printer, created by prepareSave()
+    QString fileName;
+    bool isPdf = false;
 };
@@ -14,7 +14,11 @@
 
 ExporterPrint::ExporterPrint() {}
 
-void ExporterPrint::create(ExporterRegistry *registry) { this->registry = registry; data.reset(); }
+void ExporterPrint::create(ExporterRegistry *registry) {
+    this->registry = registry;
+    data.reset();
+    printer.reset();
+}
 
 QIcon ExporterPrint::icon() { return iconFont->icon(fa::print); }
 
@@ -27,22 +31,29 @@ bool ExporterPrint::samples(const std::shared_ptr<PPresult> data) {
     return false;
 }
 
-bool ExporterPrint::save() {
+bool ExporterPrint::prepareSave() {
+    scope = registry->settings->scope;
+    colorValues = registry->settings->view.print;
+    zoom = registry->settings->view.zoom;
+
     // We need a QPrinter for printing, pdf- and ps-export
-    std::unique_ptr<QPrinter> printer = std::unique_ptr<QPrinter>(new QPrinter(QPrinter::HighResolution));
-    printer->setOrientation(registry->settings->view.zoom ? QPrinter::Portrait : QPrinter::Landscape);
+    printer = std::unique_ptr<QPrinter>(new QPrinter(QPrinter::HighResolution));
+    printer->setOrientation(zoom ? QPrinter::Portrait : QPrinter::Landscape);
     printer->setPageMargins(20, 20, 20, 20, QPrinter::Millimeter);
 
     // Show the printing dialog
     QPrintDialog dialog(printer.get());
     dialog.setWindowTitle(QCoreApplication::tr("Print oscillograph"));
-    if (dialog.exec() != QDialog::Accepted) { return false; }
+    return dialog.exec() == QDialog::Accepted;
+}
 
-    const DsoSettingsColorValues *colorValues = &(registry->settings->view.print);
+bool ExporterPrint::save(ExportControl *control) {
+    if (control->isCanceled()) return false;
 
-    LegacyExportDrawer::exportSamples(data.get(), printer.get(), registry->deviceSpecification, registry->settings,
-                                      true, colorValues);
+    LegacyExportDrawer::exportSamples(data.get(), printer.get(), registry->deviceSpecification, &scope, zoom, true,
+                                      &colorValues);
 
+    control->setProgress(1.0f);
     return true;
 }
 
@@ -2,6 +2,10 @@
 
 #pragma once
 #include "exporterinterface.h"
+#include "scopesettings.h"
+#include "viewsettings.h"
+
+class QPrinter;
 
 class ExporterPrint : public ExporterInterface
 {
@@ -12,8 +16,14 @@ public:
     virtual QString name() override;
     virtual Type type() override;
     virtual bool samples(const std::shared_ptr<PPresult>data) override;
-    virtual bool save() override;
+    virtual bool prepareSave() override;
+    virtual bool save(ExportControl *control) override;
     virtual float progress() override;
 private:
     std::shared_ptr<PPresult> data;
+    /// The settings when the export was started, save() runs in a thread of its own
+    DsoSettingsScope scope;
+    DsoSettingsColorValues colorValues;
+    bool zoom = false;
+    std::unique_ptr<QPrinter> printer; ///< Set up by the print dialog in prepareSave()
 };
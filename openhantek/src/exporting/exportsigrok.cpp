@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include "exportsigrok.h"
+#include "exporterregistry.h"
+#include "iconfont/QtAwesome.h"
+#include "post/ppresult.h"
+#include "settings.h"
+
+#include <QCoreApplication>
+#include <QFileDialog>
+
+#include <algorithm>
+#include <cmath>
+
+/// Samples per channel in one chunk of the archive (4 MB)
+#define SIGROK_CHUNK_SAMPLES (1024 * 1024)
+
+ExporterSigrok::ExporterSigrok() {}
+
+void ExporterSigrok::create(ExporterRegistry *registry) {
+    this->registry = registry;
+    channels.clear();
+    channelNames.clear();
+    sampleRate = 0;
+    buffers.clear();
+    chunks = 0;
+    archive.reset();
+    archiveFile.reset();
+    recordingFailed = false;
+}
+
+QIcon ExporterSigrok::icon() { return iconFont->icon(fa::filezipo); }
+
+QString ExporterSigrok::name() { return QCoreApplication::tr("Record sigrok session"); }
+
+ExporterInterface::Type ExporterSigrok::type() { return Type::ContinousExport; }
+
+bool ExporterSigrok::writeChunk() {
+    if (buffers.empty() || buffers.front().empty()) return true;
+    ++chunks;
+    for (size_t index = 0; index < buffers.size(); ++index) {
+        const QByteArray entryName = QString("analog-1-%1-%2").arg(index + 1).arg(chunks).toLatin1();
+        if (!archive->addFile(entryName, reinterpret_cast<const char *>(buffers[index].data()),
+                              buffers[index].size() * sizeof(float)))
+            return false;
+        buffers[index].clear();
+    }
+    return true;
+}
+
+bool ExporterSigrok::samples(const std::shared_ptr<PPresult> data) {
+    // The first frame decides about the channels and the sample rate
+    if (channels.empty()) {
+        const DsoSettingsScope &scope = registry->settings->scope;
+        for (ChannelID channel = 0; channel < scope.voltage.size() && channel < data->channelCount(); ++channel) {
+            if (!scope.voltage[channel].used || !data->data(channel)) continue;
+            channels.push_back(channel);
+            channelNames.push_back(scope.voltage[channel].name);
+            if (!sampleRate && data->data(channel)->voltage.interval > 0)
+                sampleRate = (uint64_t)std::llround(1.0 / data->data(channel)->voltage.interval);
+        }
+        // Nothing to export, wait for the next frame
+        if (channels.empty()) return true;
+
+        buffers.resize(channels.size());
+        for (std::vector<float> &buffer : buffers) buffer.reserve(SIGROK_CHUNK_SAMPLES);
+        archiveFile.reset(new QTemporaryFile());
+        recordingFailed = !archiveFile->open();
+        if (!recordingFailed) {
+            archive.reset(new ZipWriter(archiveFile.get()));
+            recordingFailed = !archive->addFile("version", "2", 1);
+        }
+    }
+    if (recordingFailed) return false;
+
+    // Channels without samples in this frame are padded, so all channels keep the same length
+    size_t frameLength = 0;
+    for (ChannelID channel : channels) {
+        if (data->data(channel)) frameLength = std::max(frameLength, data->data(channel)->voltage.sample.size());
+    }
+    for (size_t position = 0; position < frameLength;) {
+        const size_t count = std::min(frameLength - position, SIGROK_CHUNK_SAMPLES - buffers.front().size());
+        for (size_t index = 0; index < channels.size(); ++index) {
+            const DataChannel *channelData = data->data(channels[index]);
+            const std::vector<double> empty;
+            const std::vector<double> &samples = channelData ? channelData->voltage.sample : empty;
+            std::vector<float> &buffer = buffers[index];
+            for (size_t sample = position; sample < position + count; ++sample)
+                buffer.push_back(sample < samples.size() ? (float)samples[sample] : 0.0f);
+        }
+        position += count;
+        if (buffers.front().size() >= SIGROK_CHUNK_SAMPLES && !writeChunk()) {
+            recordingFailed = true;
+            return false;
+        }
+    }
+
+    return archive->size() < registry->settings->exporting.exportSizeBytes;
+}
+
+bool ExporterSigrok::prepareSave() {
+    QStringList filters;
+    filters << QCoreApplication::tr("sigrok session (*.sr)");
+
+    QFileDialog fileDialog(nullptr, QCoreApplication::tr("Export file..."), QString(), filters.join(";;"));
+    fileDialog.setFileMode(QFileDialog::AnyFile);
+    fileDialog.setAcceptMode(QFileDialog::AcceptSave);
+    fileDialog.setDefaultSuffix("sr");
+    if (fileDialog.exec() != QDialog::Accepted) return false;
+
+    fileName = fileDialog.selectedFiles().first();
+    return archive && !recordingFailed;
+}
+
+bool ExporterSigrok::save(ExportControl *control) {
+    QByteArray metadata = "[global]\nsigrok version=0.5.1\n\n[device 1]\n";
+    metadata += "samplerate=" + QByteArray::number((qulonglong)sampleRate) + "\n";
+    metadata += "total analog=" + QByteArray::number((int)channels.size()) + "\n";
+    for (size_t index = 0; index < channels.size(); ++index)
+        metadata += "analog" + QByteArray::number((int)index + 1) + "=" + channelNames[index].toUtf8() + "\n";
+
+    if (!writeChunk() || !archive->addFile("metadata", metadata.constData(), (size_t)metadata.size()) ||
+        !archive->finish())
+        return false;
+    control->setProgress(0.5f);
+    if (control->isCanceled()) return false;
+
+    // The temporary file is removed by the rename, or when the exporter is reset if it fails
+    if (QFile::exists(fileName)) QFile::remove(fileName);
+    if (!archiveFile->rename(fileName)) return false;
+    archiveFile->setAutoRemove(false);
+    control->setProgress(1.0f);
+    return true;
+}
+
+float ExporterSigrok::progress() {
+    if (!archive) return 0;
+    return std::max(1e-6f, std::min(1.0f, (float)archive->size() / registry->settings->exporting.exportSizeBytes));
+}
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+#include "exporterinterface.h"
+#include "hantekprotocol/types.h"
+#include "zipwriter.h"
+
+#include <QTemporaryFile>
+
+#include <vector>
+
+/// \brief Records the used voltage channels as sigrok session (.sr) file, e.g. for PulseView.
+/// The session is a zip archive with a version and a metadata file and the analog samples as 32 bit floats
+/// in chunks "analog-1-<channel>-<chunk>". While recording, the samples of every channel are collected up to
+/// a chunk, which is then appended to the archive in a temporary file. So the memory use stays bounded, no
+/// matter how long the capture is. Saving only adds the last chunks and the metadata and moves the archive
+/// to its destination. The channels and the sample rate are taken from the first frame.
+class ExporterSigrok : public ExporterInterface
+{
+public:
+    ExporterSigrok();
+    virtual void create(ExporterRegistry *registry) override;
+    virtual QIcon icon() override;
+    virtual QString name() override;
+    virtual Type type() override;
+    virtual bool samples(const std::shared_ptr<PPresult>data) override;
+    virtual bool prepareSave() override;
+    virtual bool save(ExportControl *control) override;
+    virtual float progress() override;
+private:
+    /// Appends the collected samples of all channels as the next chunk.
+    bool writeChunk();
+
+    std::vector<ChannelID> channels;         ///< The exported channels
+    std::vector<QString> channelNames;
+    uint64_t sampleRate = 0;
+    std::vector<std::vector<float>> buffers; ///< The samples of the current chunk per channel, all of equal size
+    unsigned chunks = 0;                     ///< Written chunks per channel
+    std::unique_ptr<QTemporaryFile> archiveFile;
+    std::unique_ptr<ZipWriter> archive;
+    bool recordingFailed = false;
+
+    QString fileName;
+};
@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include "exportwav.h"
+#include "exporterregistry.h"
+#include "hantekdso/controlspecification.h"
+#include "iconfont/QtAwesome.h"
+#include "post/ppresult.h"
+#include "settings.h"
+#include "utils/samplecodec.h"
+#include "viewconstants.h"
+
+#include <QCoreApplication>
+#include <QFileDialog>
+
+#include <algorithm>
+#include <cmath>
+
+/// Frames that are converted and written at once
+#define WAV_CHUNK_FRAMES 65536
+
+ExporterWAV::ExporterWAV(Type exportType) : exportType(exportType) {}
+
+void ExporterWAV::create(ExporterRegistry *registry) {
+    this->registry = registry;
+    channels.clear();
+    scales.clear();
+    sampleRate = 0;
+    frameBuffer.clear();
+    recording.reset();
+    recordedBytes = 0;
+    recordingFailed = false;
+    encoded.clear();
+    padded.clear();
+    decoded.clear();
+}
+
+QIcon ExporterWAV::icon() { return iconFont->icon(fa::fileaudioo); }
+
+QString ExporterWAV::name() {
+    return exportType == Type::SnapshotExport ? QCoreApplication::tr("Export WAV")
+                                              : QCoreApplication::tr("Record WAV");
+}
+
+ExporterInterface::Type ExporterWAV::type() { return exportType; }
+
+void ExporterWAV::interleave(const PPresult *data) {
+    size_t frames = 0;
+    for (ChannelID channel : channels) {
+        if (data->data(channel)) frames = std::max(frames, data->data(channel)->voltage.sample.size());
+    }
+    frameBuffer.assign(frames * channels.size(), 0.0f);
+    for (size_t index = 0; index < channels.size(); ++index) {
+        const DataChannel *channelData = data->data(channels[index]);
+        if (!channelData) continue;
+        const std::vector<double> &samples = channelData->voltage.sample;
+        float *output = frameBuffer.data() + index;
+        for (size_t position = 0; position < samples.size(); ++position, output += channels.size())
+            *output = (float)samples[position];
+    }
+}
+
+bool ExporterWAV::samples(const std::shared_ptr<PPresult> data) {
+    // The first frame decides about the channels and the sample rate
+    if (channels.empty()) {
+        const DsoSettingsScope &scope = registry->settings->scope;
+        for (ChannelID channel = 0; channel < scope.voltage.size() && channel < data->channelCount(); ++channel) {
+            if (!scope.voltage[channel].used || !data->data(channel)) continue;
+            channels.push_back(channel);
+            scales.push_back((float)(1.0 / (scope.gain(channel) * DIVS_VOLTAGE)));
+            if (!sampleRate && data->data(channel)->voltage.interval > 0)
+                sampleRate = (uint32_t)std::lround(1.0 / data->data(channel)->voltage.interval);
+        }
+        // Nothing to export, wait for the next frame
+        if (channels.empty()) return true;
+    }
+
+    if (exportType == Type::SnapshotExport) {
+        interleave(data.get());
+        return false;
+    }
+
+    if (!recording) {
+        recording.reset(new QTemporaryFile());
+        recordingFailed = !recording->open();
+    }
+    if (!recordingFailed && !appendFrame(data.get())) recordingFailed = true;
+    return !recordingFailed && recordedBytes < registry->settings->exporting.exportSizeBytes;
+}
+
+double ExporterWAV::quantizationStep(ChannelID channel) const {
+    // The same gain as chosen by HantekDsoControl::setGain()
+    const Dso::ControlSpecification *specification = registry->deviceSpecification;
+    if (channel >= specification->channels || specification->gain.empty()) return 0;
+    const double gain = registry->settings->scope.gain(channel) * DIVS_VOLTAGE;
+    unsigned gainID;
+    for (gainID = 0; gainID < specification->gain.size() - 1; ++gainID)
+        if (specification->gain[gainID].gainSteps >= gain) break;
+
+    if (channel >= specification->voltageLimit.size() || gainID >= specification->voltageLimit[channel].size() ||
+        !specification->voltageLimit[channel][gainID])
+        return 0;
+    return specification->gain[gainID].gainSteps / specification->voltageLimit[channel][gainID];
+}
+
+bool ExporterWAV::appendFrame(const PPresult *data) {
+    size_t frames = 0;
+    for (ChannelID channel : channels) {
+        if (data->data(channel)) frames = std::max(frames, data->data(channel)->voltage.sample.size());
+    }
+    const uint32_t frameLength = (uint32_t)frames;
+    if (recording->write(reinterpret_cast<const char *>(&frameLength), sizeof(frameLength)) != sizeof(frameLength))
+        return false;
+
+    for (ChannelID channel : channels) {
+        const DataChannel *channelData = data->data(channel);
+        const double *samples = channelData ? channelData->voltage.sample.data() : nullptr;
+        if (!channelData || channelData->voltage.sample.size() < frames) {
+            padded.assign(frames, 0.0);
+            if (channelData)
+                std::copy(channelData->voltage.sample.begin(), channelData->voltage.sample.end(), padded.begin());
+            samples = padded.data();
+        }
+        encoded.clear();
+        encodeSamples(samples, frames, quantizationStep(channel), encoded);
+
+        const uint32_t size = (uint32_t)encoded.size();
+        if (recording->write(reinterpret_cast<const char *>(&size), sizeof(size)) != sizeof(size) ||
+            recording->write(reinterpret_cast<const char *>(encoded.data()), size) != size)
+            return false;
+    }
+    recordedBytes += (uint64_t)frames * channels.size() * sizeof(float);
+    return true;
+}
+
+bool ExporterWAV::readFrame(std::vector<float> &frame) {
+    uint32_t frames;
+    if (recording->read(reinterpret_cast<char *>(&frames), sizeof(frames)) != sizeof(frames)) return false;
+    frame.resize((size_t)frames * channels.size());
+    decoded.resize(frames);
+
+    for (size_t index = 0; index < channels.size(); ++index) {
+        uint32_t size;
+        if (recording->read(reinterpret_cast<char *>(&size), sizeof(size)) != sizeof(size)) return false;
+        encoded.resize(size);
+        if (recording->read(reinterpret_cast<char *>(encoded.data()), size) != size ||
+            decodeSamples(encoded.data(), size, decoded.data(), frames) != size)
+            return false;
+        float *output = frame.data() + index;
+        for (size_t position = 0; position < frames; ++position, output += channels.size())
+            *output = decoded[position];
+    }
+    return true;
+}
+
+bool ExporterWAV::writeSamples(WavWriter &writer, float *samples, size_t count) {
+    if (format == WavWriter::Format::INT16) {
+        for (size_t index = 0; index < count; ++index) samples[index] *= scales[index % channels.size()];
+    }
+    return writer.write(samples, count / channels.size());
+}
+
+bool ExporterWAV::prepareSave() {
+    QStringList filters;
+    filters << QCoreApplication::tr("WAV, 32 bit float (*.wav)") << QCoreApplication::tr("WAV, 16 bit integer (*.wav)");
+
+    QFileDialog fileDialog(nullptr, QCoreApplication::tr("Export file..."), QString(), filters.join(";;"));
+    fileDialog.setFileMode(QFileDialog::AnyFile);
+    fileDialog.setAcceptMode(QFileDialog::AcceptSave);
+    fileDialog.setDefaultSuffix("wav");
+    if (fileDialog.exec() != QDialog::Accepted) return false;
+
+    fileName = fileDialog.selectedFiles().first();
+    format = filters.indexOf(fileDialog.selectedNameFilter()) == 1 ? WavWriter::Format::INT16
+                                                                     : WavWriter::Format::FLOAT32;
+    return !channels.empty() && sampleRate > 0 && !recordingFailed;
+}
+
+bool ExporterWAV::save(ExportControl *control) {
+    WavWriter writer(fileName, (unsigned)channels.size(), sampleRate, format);
+    if (!writer.open()) return false;
+
+    // Snapshots are written in chunks of the frame, recordings frame by frame
+    const uint64_t totalSamples =
+        exportType == Type::SnapshotExport ? frameBuffer.size() : recordedBytes / sizeof(float);
+    const size_t chunkSamples = WAV_CHUNK_FRAMES * channels.size();
+    std::vector<float> chunk;
+    if (recording) recording->seek(0);
+
+    for (uint64_t done = 0; done < totalSamples;) {
+        if (recording) {
+            if (!readFrame(chunk)) {
+                writer.remove();
+                return false;
+            }
+        } else {
+            const size_t count = (size_t)std::min<uint64_t>(chunkSamples, totalSamples - done);
+            chunk.assign(frameBuffer.begin() + done, frameBuffer.begin() + done + count);
+        }
+        if (!writeSamples(writer, chunk.data(), chunk.size())) {
+            writer.remove();
+            return false;
+        }
+        done += chunk.size();
+        control->setProgress((float)done / totalSamples);
+        if (control->isCanceled()) {
+            writer.remove();
+            return false;
+        }
+    }
+
+    return writer.close();
+}
+
+float ExporterWAV::progress() {
+    if (exportType == Type::SnapshotExport) return frameBuffer.empty() ? 0 : 1.0f;
+    if (!recordedBytes) return 0;
+    return std::max(1e-6f, std::min(1.0f, (float)recordedBytes / registry->settings->exporting.exportSizeBytes));
+}
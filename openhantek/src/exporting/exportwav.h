@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+#include "exporterinterface.h"
+#include "hantekprotocol/types.h"
+#include "wavwriter.h"
+
+#include <QTemporaryFile>
+
+#include <vector>
+
+/// \brief Exports the used voltage channels as a multichannel WAV file.
+/// As a snapshot exporter it saves one frame, as a continous exporter it records all frames until it is
+/// disabled or DsoSettingsExport::exportSizeBytes is reached. The recording is kept in a temporary file, so
+/// long captures don't need to fit into the memory. Every frame is stored as its length followed by the
+/// samples of each channel, compressed with encodeSamples() at the resolution of the ADC. This takes a
+/// fraction of the disk space and bandwidth of plain floats and still saves the same values. In roll mode the
+/// frames continue each other, triggered frames are simply concatenated.
+/// The channels and the sample rate are taken from the first frame. 16 bit files map the vertical range of
+/// a channel (gain * DIVS_VOLTAGE) to the full scale, which keeps all bits of the ADC.
+class ExporterWAV : public ExporterInterface
+{
+public:
+    explicit ExporterWAV(Type exportType);
+    virtual void create(ExporterRegistry *registry) override;
+    virtual QIcon icon() override;
+    virtual QString name() override;
+    virtual Type type() override;
+    virtual bool samples(const std::shared_ptr<PPresult>data) override;
+    virtual bool prepareSave() override;
+    virtual bool save(ExportControl *control) override;
+    virtual float progress() override;
+private:
+    /// Writes the used channels of the frame interleaved into frameBuffer.
+    void interleave(const PPresult *data);
+    /// The voltage of one ADC value of a device channel, 0 for math channels.
+    double quantizationStep(ChannelID channel) const;
+    /// Appends the compressed frame to the recording.
+    bool appendFrame(const PPresult *data);
+    /// Reads the next frame of the recording into frame, interleaved.
+    bool readFrame(std::vector<float> &frame);
+    /// Scales the interleaved samples for 16 bit files and writes them.
+    bool writeSamples(WavWriter &writer, float *samples, size_t count);
+
+    const Type exportType;
+    std::vector<ChannelID> channels; ///< The exported channels
+    std::vector<float> scales;       ///< 16 bit: Factor that maps the range of each channel to -1..1
+    uint32_t sampleRate = 0;
+    std::vector<float> frameBuffer;  ///< Snapshot: The frame
+    std::unique_ptr<QTemporaryFile> recording; ///< Continous: All frames, compressed
+    uint64_t recordedBytes = 0;      ///< Continous: The size of the recorded samples in the WAV file
+    std::vector<uint8_t> encoded;    ///< The compressed samples of a channel
+    std::vector<double> padded;      ///< A channel that is shorter than the frame, padded with zeros
+    std::vector<float> decoded;      ///< The decompressed samples of a channel
+    bool recordingFailed = false;
+
+    QString fileName;
+    WavWriter::Format format = WavWriter::Format::FLOAT32;
+};
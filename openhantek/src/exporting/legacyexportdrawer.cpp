@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include <QCoreApplication>
 #include <QImage>
@@ -13,6 +15,7 @@
 #include "controlspecification.h"
 #include "post/graphgenerator.h"
 #include "post/ppresult.h"
+#include "post/spectrogram.h"
 #include "settings.h"
 #include "utils/printutils.h"
 #include "viewconstants.h"
@@ -21,245 +24,459 @@
 
 bool LegacyExportDrawer::exportSamples(const PPresult *result, QPaintDevice* paintDevice,
                              const Dso::ControlSpecification *deviceSpecification,
-                             const DsoSettings *settings, bool isPrinter, const DsoSettingsColorValues *colorValues) {
-    // Create a painter for our device
-    QPainter painter(paintDevice);
-
+                             const DsoSettingsScope *scope, bool zoom, bool isPrinter,
+                             const DsoSettingsColorValues *colorValues, GridCache *gridCache) {
     // Get line height
     QFont font;
     QFontMetrics fontMetrics(font, paintDevice);
     double lineHeight = fontMetrics.height();
+    const QSize size(paintDevice->width(), paintDevice->height());
+
+    std::vector<Label> labels;
+    double scopeHeight =
+        collectLabels(result, size, lineHeight, deviceSpecification, scope, zoom, colorValues, labels);
+
+    // Images are rasterized directly, the painter only adds the grid layer and the labels
+    QImage *image = dynamic_cast<QImage *>(paintDevice);
+    if (image && !isPrinter &&
+        (image->format() == QImage::Format_ARGB32_Premultiplied || image->format() == QImage::Format_RGB32)) {
+        drawGraphsRaster(image, result, scope, zoom, colorValues, scopeHeight, lineHeight);
+
+        QPainter painter(image);
+        painter.setBrush(Qt::SolidPattern);
+        if (gridCache) {
+            std::lock_guard<std::mutex> lock(gridCache->mutex);
+            if (gridCache->image.isNull() || gridCache->size != size || gridCache->lineHeight != lineHeight ||
+                gridCache->scopeHeight != scopeHeight || gridCache->zoom != zoom ||
+                gridCache->axes != colorValues->axes || gridCache->border != colorValues->border ||
+                gridCache->grid != colorValues->grid) {
+                gridCache->size = size;
+                gridCache->lineHeight = lineHeight;
+                gridCache->scopeHeight = scopeHeight;
+                gridCache->zoom = zoom;
+                gridCache->axes = colorValues->axes;
+                gridCache->border = colorValues->border;
+                gridCache->grid = colorValues->grid;
+                gridCache->image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+                gridCache->image.fill(Qt::transparent);
+                QPainter gridPainter(&gridCache->image);
+                drawGrids(gridPainter, colorValues, lineHeight, scopeHeight, size.width(), isPrinter, zoom);
+                gridPainter.end();
+            }
+            painter.drawImage(0, 0, gridCache->image);
+        } else {
+            drawGrids(painter, colorValues, lineHeight, scopeHeight, size.width(), isPrinter, zoom);
+        }
+        drawLabels(painter, labels);
+        painter.end();
+        return true;
+    }
 
+    // Create a painter for our device
+    QPainter painter(paintDevice);
     painter.setBrush(Qt::SolidPattern);
+    drawLabels(painter, labels);
+    drawGraphs(painter, result, scope, zoom, colorValues, size.width(), scopeHeight, lineHeight);
+    drawGrids(painter, colorValues, lineHeight, scopeHeight, size.width(), isPrinter, zoom);
+    painter.end();
 
+    return true;
+}
+
+double LegacyExportDrawer::collectLabels(const PPresult *result, const QSize &size, double lineHeight,
+                                         const Dso::ControlSpecification *deviceSpecification,
+                                         const DsoSettingsScope *scope, bool zoom,
+                                         const DsoSettingsColorValues *colorValues, std::vector<Label> &labels) {
     // Draw the settings table
-    double stretchBase = (double)(paintDevice->width() - lineHeight * 10) / 4;
+    double stretchBase = (double)(size.width() - lineHeight * 10) / 4;
 
     // Print trigger details
-    painter.setPen(colorValues->voltage[settings->scope.trigger.source]);
-    QString levelString = valueToString(settings->scope.voltage[settings->scope.trigger.source].trigger, UNIT_VOLTS, 3);
-    QString pretriggerString = tr("%L1%").arg((int)(settings->scope.trigger.position * 100 + 0.5));
-    painter.drawText(QRectF(0, 0, lineHeight * 10, lineHeight),
-                     tr("%1  %2  %3  %4")
-                         .arg(settings->scope.voltage[settings->scope.trigger.source].name,
-                              Dso::slopeString(settings->scope.trigger.slope), levelString, pretriggerString));
+    QString levelString = valueToString(scope->voltage[scope->trigger.source].trigger, UNIT_VOLTS, 3);
+    QString pretriggerString = tr("%L1%").arg((int)(scope->trigger.position * 100 + 0.5));
+    labels.push_back({QRectF(0, 0, lineHeight * 10, lineHeight),
+                      tr("%1  %2  %3  %4")
+                          .arg(scope->voltage[scope->trigger.source].name,
+                               Dso::slopeString(scope->trigger.slope), levelString, pretriggerString),
+                      colorValues->voltage[scope->trigger.source], false});
+
+    // Print sample count
+    labels.push_back({QRectF(lineHeight * 10, 0, stretchBase, lineHeight), tr("%1 S").arg(result->sampleCount()),
+                      colorValues->text, true});
+    // Print samplerate
+    labels.push_back({QRectF(lineHeight * 10 + stretchBase, 0, stretchBase, lineHeight),
+                      valueToString(scope->horizontal.samplerate, UNIT_SAMPLES) + tr("/s"), colorValues->text,
+                      true});
+    // Print timebase
+    labels.push_back({QRectF(lineHeight * 10 + stretchBase * 2, 0, stretchBase, lineHeight),
+                      valueToString(scope->horizontal.timebase, UNIT_SECONDS, 0) + tr("/div"),
+                      colorValues->text, true});
+    // Print frequencybase
+    labels.push_back({QRectF(lineHeight * 10 + stretchBase * 3, 0, stretchBase, lineHeight),
+                      valueToString(scope->horizontal.frequencybase, UNIT_HERTZ, 0) + tr("/div"),
+                      colorValues->text, true});
+
+    // Draw the measurement table
+    stretchBase = (double)(size.width() - lineHeight * 6) / 10;
+    int channelCount = 0;
+    for (int channel = scope->voltage.size() - 1; channel >= 0; channel--) {
+        if ((scope->voltage[channel].used || scope->spectrum[channel].used) &&
+            result->data(channel)) {
+            ++channelCount;
+            double top = (double)size.height() - channelCount * lineHeight;
+
+            // Print label
+            labels.push_back({QRectF(0, top, lineHeight * 4, lineHeight), scope->voltage[channel].name,
+                              colorValues->voltage[channel], false});
+            // Print coupling/math mode
+            if ((unsigned int)channel < deviceSpecification->channels)
+                labels.push_back({QRectF(lineHeight * 4, top, lineHeight * 2, lineHeight),
+                                  Dso::couplingString(scope->coupling(channel, deviceSpecification)),
+                                  colorValues->voltage[channel], false});
+            else
+                labels.push_back({QRectF(lineHeight * 4, top, lineHeight * 2, lineHeight),
+                                  Dso::mathModeString(Dso::getMathMode(scope->voltage[channel])),
+                                  colorValues->voltage[channel], false});
+
+            // Print voltage gain
+            labels.push_back({QRectF(lineHeight * 6, top, stretchBase * 2, lineHeight),
+                              valueToString(scope->gain(channel), UNIT_VOLTS, 0) + tr("/div"),
+                              colorValues->voltage[channel], true});
+            // Print spectrum magnitude
+            if (scope->spectrum[channel].used) {
+                labels.push_back({QRectF(lineHeight * 6 + stretchBase * 2, top, stretchBase * 2, lineHeight),
+                                  valueToString(scope->spectrum[channel].magnitude, UNIT_DECIBEL, 0) +
+                                      tr("/div"),
+                                  colorValues->spectrum[channel], true});
+            }
+
+            // Amplitude string representation (4 significant digits)
+            labels.push_back({QRectF(lineHeight * 6 + stretchBase * 4, top, stretchBase * 3, lineHeight),
+                              valueToString(result->data(channel)->computeAmplitude(), UNIT_VOLTS, 4),
+                              colorValues->text, true});
+            // Frequency string representation (5 significant digits)
+            labels.push_back({QRectF(lineHeight * 6 + stretchBase * 7, top, stretchBase * 3, lineHeight),
+                              valueToString(result->data(channel)->frequency, UNIT_HERTZ, 5), colorValues->text,
+                              true});
+        }
+    }
+
+    // Draw the marker table
+    stretchBase = (double)(size.width() - lineHeight * 10) / 4;
+
+    // Calculate variables needed for zoomed scope
+    double m1 = scope->getMarker(0);
+    double m2 = scope->getMarker(1);
+    double divs = fabs(m2 - m1);
+    double time = divs * scope->horizontal.timebase;
 
     double scopeHeight;
+    if (zoom) {
+        scopeHeight = (double)(size.height() - (channelCount + 5) * lineHeight) / 2;
+        double top = 2.5 * lineHeight + scopeHeight;
+
+        labels.push_back({QRectF(0, top, stretchBase, lineHeight), tr("Zoom x%L1").arg(DIVS_TIME / divs, -1, 'g', 3),
+                          colorValues->text, false});
+
+        labels.push_back({QRectF(lineHeight * 10, top, stretchBase, lineHeight), valueToString(time, UNIT_SECONDS, 4),
+                          colorValues->text, true});
+        labels.push_back({QRectF(lineHeight * 10 + stretchBase, top, stretchBase, lineHeight),
+                          valueToString(1.0 / time, UNIT_HERTZ, 4), colorValues->text, true});
+
+        labels.push_back({QRectF(lineHeight * 10 + stretchBase * 2, top, stretchBase, lineHeight),
+                          valueToString(time / DIVS_TIME, UNIT_SECONDS, 3) + tr("/div"), colorValues->text, true});
+        labels.push_back({QRectF(lineHeight * 10 + stretchBase * 3, top, stretchBase, lineHeight),
+                          valueToString(divs * scope->horizontal.frequencybase / DIVS_TIME, UNIT_HERTZ, 3) +
+                              tr("/div"),
+                          colorValues->text, true});
+    } else {
+        scopeHeight = (double)size.height() - (channelCount + 4) * lineHeight;
+        double top = 2.5 * lineHeight + scopeHeight;
+
+        labels.push_back({QRectF(0, top, stretchBase, lineHeight), tr("Marker 1/2"), colorValues->text, false});
+
+        labels.push_back({QRectF(lineHeight * 10, top, stretchBase * 2, lineHeight),
+                          valueToString(time, UNIT_SECONDS, 4), colorValues->text, true});
+        labels.push_back({QRectF(lineHeight * 10 + stretchBase * 2, top, stretchBase * 2, lineHeight),
+                          valueToString(1.0 / time, UNIT_HERTZ, 4), colorValues->text, true});
+    }
+    return scopeHeight;
+}
 
-    { // DataAnalyser mutex lock
-        // Print sample count
-        painter.setPen(colorValues->text);
-        painter.drawText(QRectF(lineHeight * 10, 0, stretchBase, lineHeight), tr("%1 S").arg(result->sampleCount()),
-                         QTextOption(Qt::AlignRight));
-        // Print samplerate
-        painter.drawText(QRectF(lineHeight * 10 + stretchBase, 0, stretchBase, lineHeight),
-                         valueToString(settings->scope.horizontal.samplerate, UNIT_SAMPLES) + tr("/s"),
-                         QTextOption(Qt::AlignRight));
-        // Print timebase
-        painter.drawText(QRectF(lineHeight * 10 + stretchBase * 2, 0, stretchBase, lineHeight),
-                         valueToString(settings->scope.horizontal.timebase, UNIT_SECONDS, 0) + tr("/div"),
-                         QTextOption(Qt::AlignRight));
-        // Print frequencybase
-        painter.drawText(QRectF(lineHeight * 10 + stretchBase * 3, 0, stretchBase, lineHeight),
-                         valueToString(settings->scope.horizontal.frequencybase, UNIT_HERTZ, 0) + tr("/div"),
-                         QTextOption(Qt::AlignRight));
-
-        // Draw the measurement table
-        stretchBase = (double)(paintDevice->width() - lineHeight * 6) / 10;
-        int channelCount = 0;
-        for (int channel = settings->scope.voltage.size() - 1; channel >= 0; channel--) {
-            if ((settings->scope.voltage[channel].used || settings->scope.spectrum[channel].used) &&
-                result->data(channel)) {
-                ++channelCount;
-                double top = (double)paintDevice->height() - channelCount * lineHeight;
-
-                // Print label
-                painter.setPen(colorValues->voltage[channel]);
-                painter.drawText(QRectF(0, top, lineHeight * 4, lineHeight), settings->scope.voltage[channel].name);
-                // Print coupling/math mode
-                if ((unsigned int)channel < deviceSpecification->channels)
-                    painter.drawText(QRectF(lineHeight * 4, top, lineHeight * 2, lineHeight),
-                                     Dso::couplingString(settings->scope.coupling(channel, deviceSpecification)));
-                else
-                    painter.drawText(
-                        QRectF(lineHeight * 4, top, lineHeight * 2, lineHeight),
-                        Dso::mathModeString(Dso::getMathMode(settings->scope.voltage[channel])));
-
-                // Print voltage gain
-                painter.drawText(QRectF(lineHeight * 6, top, stretchBase * 2, lineHeight),
-                                 valueToString(settings->scope.gain(channel), UNIT_VOLTS, 0) + tr("/div"),
-                                 QTextOption(Qt::AlignRight));
-                // Print spectrum magnitude
-                if (settings->scope.spectrum[channel].used) {
-                    painter.setPen(colorValues->spectrum[channel]);
-                    painter.drawText(QRectF(lineHeight * 6 + stretchBase * 2, top, stretchBase * 2, lineHeight),
-                                     valueToString(settings->scope.spectrum[channel].magnitude, UNIT_DECIBEL, 0) +
-                                         tr("/div"),
-                                     QTextOption(Qt::AlignRight));
-                }
+void LegacyExportDrawer::drawLabels(QPainter &painter, const std::vector<Label> &labels) {
+    for (const Label &label : labels) {
+        painter.setPen(label.color);
+        if (label.alignRight)
+            painter.drawText(label.rect, label.text, QTextOption(Qt::AlignRight));
+        else
+            painter.drawText(label.rect, label.text);
+    }
+}
 
-                // Amplitude string representation (4 significant digits)
-                painter.setPen(colorValues->text);
-                painter.drawText(QRectF(lineHeight * 6 + stretchBase * 4, top, stretchBase * 3, lineHeight),
-                                 valueToString(result->data(channel)->computeAmplitude(), UNIT_VOLTS, 4),
-                                 QTextOption(Qt::AlignRight));
-                // Frequency string representation (5 significant digits)
-                painter.drawText(QRectF(lineHeight * 6 + stretchBase * 7, top, stretchBase * 3, lineHeight),
-                                 valueToString(result->data(channel)->frequency, UNIT_HERTZ, 5),
-                                 QTextOption(Qt::AlignRight));
-            }
-        }
+QMatrix LegacyExportDrawer::scopeMatrix(int scopeWidth, double scopeHeight, double lineHeight, bool zoomed,
+                                        double zoomFactor, double zoomOffset) {
+    if (!zoomed)
+        return QMatrix((scopeWidth - 1) / DIVS_TIME, 0, 0, -(scopeHeight - 1) / DIVS_VOLTAGE,
+                       (double)(scopeWidth - 1) / 2, (scopeHeight - 1) / 2 + lineHeight * 1.5);
+    // DIVS_TIME / zoomFactor x DIVS_VOLTAGE matrix for the zoomed oscillograph
+    return QMatrix((scopeWidth - 1) / DIVS_TIME * zoomFactor, 0, 0, -(scopeHeight - 1) / DIVS_VOLTAGE,
+                   (double)(scopeWidth - 1) / 2 - zoomOffset * zoomFactor * (scopeWidth - 1) / DIVS_TIME,
+                   (scopeHeight - 1) * 1.5 + lineHeight * 4);
+}
 
-        // Draw the marker table
-        stretchBase = (double)(paintDevice->width() - lineHeight * 10) / 4;
-        painter.setPen(colorValues->text);
-
-        // Calculate variables needed for zoomed scope
-        double m1 = settings->scope.getMarker(0);
-        double m2 = settings->scope.getMarker(1);
-        double divs = fabs(m2 - m1);
-        double time = divs * settings->scope.horizontal.timebase;
-        double zoomFactor = DIVS_TIME / divs;
-        double zoomOffset = (m1 + m2) / 2;
-
-        if (settings->view.zoom) {
-            scopeHeight = (double)(paintDevice->height() - (channelCount + 5) * lineHeight) / 2;
-            double top = 2.5 * lineHeight + scopeHeight;
-
-            painter.drawText(QRectF(0, top, stretchBase, lineHeight),
-                             tr("Zoom x%L1").arg(DIVS_TIME / divs, -1, 'g', 3));
-
-            painter.drawText(QRectF(lineHeight * 10, top, stretchBase, lineHeight),
-                             valueToString(time, UNIT_SECONDS, 4), QTextOption(Qt::AlignRight));
-            painter.drawText(QRectF(lineHeight * 10 + stretchBase, top, stretchBase, lineHeight),
-                             valueToString(1.0 / time, UNIT_HERTZ, 4), QTextOption(Qt::AlignRight));
-
-            painter.drawText(QRectF(lineHeight * 10 + stretchBase * 2, top, stretchBase, lineHeight),
-                             valueToString(time / DIVS_TIME, UNIT_SECONDS, 3) + tr("/div"),
-                             QTextOption(Qt::AlignRight));
-            painter.drawText(QRectF(lineHeight * 10 + stretchBase * 3, top, stretchBase, lineHeight),
-                             valueToString(divs * settings->scope.horizontal.frequencybase / DIVS_TIME, UNIT_HERTZ, 3) +
-                                 tr("/div"),
-                             QTextOption(Qt::AlignRight));
-        } else {
-            scopeHeight = (double)paintDevice->height() - (channelCount + 4) * lineHeight;
-            double top = 2.5 * lineHeight + scopeHeight;
+namespace {
+/// \brief The visible samples [first, last] of a graph, last < first if none is visible.
+void visibleRange(double horizontalFactor, size_t sampleCount, bool zoomed, double zoomFactor, double zoomOffset,
+                  unsigned &first, unsigned &last) {
+    // How many samples are visible?
+    double centerPosition, centerOffset;
+    if (zoomed) {
+        centerPosition = (zoomOffset + DIVS_TIME / 2) / horizontalFactor;
+        centerOffset = DIVS_TIME / horizontalFactor / zoomFactor / 2;
+    } else {
+        centerPosition = DIVS_TIME / 2 / horizontalFactor;
+        centerOffset = DIVS_TIME / horizontalFactor / 2;
+    }
+    first = (unsigned)qMax((int)(centerPosition - centerOffset), 0);
+    const int lastPosition = qMin((int)(centerPosition + centerOffset), (int)sampleCount - 1);
+    if (lastPosition < (int)first) {
+        first = 1;
+        last = 0;
+    } else
+        last = (unsigned)lastPosition;
+}
+} // namespace
 
-            painter.drawText(QRectF(0, top, stretchBase, lineHeight), tr("Marker 1/2"));
+void LegacyExportDrawer::drawGraphs(QPainter &painter, const PPresult *result, const DsoSettingsScope *scope,
+                                    bool zoom, const DsoSettingsColorValues *colorValues, int scopeWidth,
+                                    double scopeHeight, double lineHeight) {
+    double m1 = scope->getMarker(0);
+    double m2 = scope->getMarker(1);
+    double zoomFactor = DIVS_TIME / fabs(m2 - m1);
+    double zoomOffset = (m1 + m2) / 2;
 
-            painter.drawText(QRectF(lineHeight * 10, top, stretchBase * 2, lineHeight),
-                             valueToString(time, UNIT_SECONDS, 4), QTextOption(Qt::AlignRight));
-            painter.drawText(QRectF(lineHeight * 10 + stretchBase * 2, top, stretchBase * 2, lineHeight),
-                             valueToString(1.0 / time, UNIT_HERTZ, 4), QTextOption(Qt::AlignRight));
-        }
+    // Draw the graphs
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setBrush(Qt::NoBrush);
 
-        // Set DIVS_TIME x DIVS_VOLTAGE matrix for oscillograph
-        painter.setMatrix(QMatrix((paintDevice->width() - 1) / DIVS_TIME, 0, 0, -(scopeHeight - 1) / DIVS_VOLTAGE,
-                                  (double)(paintDevice->width() - 1) / 2, (scopeHeight - 1) / 2 + lineHeight * 1.5),
-                          false);
+    for (int zoomed = 0; zoomed < (zoom ? 2 : 1); ++zoomed) {
+        painter.setMatrix(scopeMatrix(scopeWidth, scopeHeight, lineHeight, zoomed, zoomFactor, zoomOffset), false);
+
+        switch (scope->horizontal.format) {
+        case Dso::GraphFormat::TY:
+            // Add graphs for channels
+            for (ChannelID channel = 0; channel < scope->voltage.size(); ++channel) {
+                if (scope->voltage[channel].used && result->data(channel)) {
+                    painter.setPen(QPen(colorValues->voltage[channel], 0));
+
+                    // What's the horizontal distance between sampling points?
+                    double horizontalFactor =
+                        result->data(channel)->voltage.interval / scope->horizontal.timebase;
+                    unsigned int firstPosition, lastPosition;
+                    visibleRange(horizontalFactor, result->data(channel)->voltage.sample.size(), zoomed, zoomFactor,
+                                 zoomOffset, firstPosition, lastPosition);
+                    if (lastPosition < firstPosition) continue;
+
+                    // Draw graph
+                    QPointF *graph = new QPointF[lastPosition - firstPosition + 1];
+
+                    for (unsigned int position = firstPosition; position <= lastPosition; ++position)
+                        graph[position - firstPosition] = QPointF(position * horizontalFactor - DIVS_TIME / 2,
+                                                                  result->data(channel)->voltage.sample[position] /
+                                                                          scope->gain(channel) +
+                                                                      scope->voltage[channel].offset);
+
+                    painter.drawPolyline(graph, lastPosition - firstPosition + 1);
+                    delete[] graph;
+                }
+            }
 
-        // Draw the graphs
-        painter.setRenderHint(QPainter::Antialiasing);
-        painter.setBrush(Qt::NoBrush);
-
-        for (int zoomed = 0; zoomed < (settings->view.zoom ? 2 : 1); ++zoomed) {
-            switch (settings->scope.horizontal.format) {
-            case Dso::GraphFormat::TY:
-                // Add graphs for channels
-                for (ChannelID channel = 0; channel < settings->scope.voltage.size(); ++channel) {
-                    if (settings->scope.voltage[channel].used && result->data(channel)) {
-                        painter.setPen(QPen(colorValues->voltage[channel], 0));
-
-                        // What's the horizontal distance between sampling points?
-                        double horizontalFactor =
-                            result->data(channel)->voltage.interval / settings->scope.horizontal.timebase;
-                        // How many samples are visible?
-                        double centerPosition, centerOffset;
-                        if (zoomed) {
-                            centerPosition = (zoomOffset + DIVS_TIME / 2) / horizontalFactor;
-                            centerOffset = DIVS_TIME / horizontalFactor / zoomFactor / 2;
-                        } else {
-                            centerPosition = DIVS_TIME / 2 / horizontalFactor;
-                            centerOffset = DIVS_TIME / horizontalFactor / 2;
-                        }
-                        unsigned int firstPosition = qMax((int)(centerPosition - centerOffset), 0);
-                        unsigned int lastPosition = qMin((int)(centerPosition + centerOffset),
-                                                         (int)result->data(channel)->voltage.sample.size() - 1);
-
-                        // Draw graph
-                        QPointF *graph = new QPointF[lastPosition - firstPosition + 1];
-
-                        for (unsigned int position = firstPosition; position <= lastPosition; ++position)
-                            graph[position - firstPosition] = QPointF(position * horizontalFactor - DIVS_TIME / 2,
-                                                                      result->data(channel)->voltage.sample[position] /
-                                                                              settings->scope.gain(channel) +
-                                                                          settings->scope.voltage[channel].offset);
-
-                        painter.drawPolyline(graph, lastPosition - firstPosition + 1);
-                        delete[] graph;
-                    }
+            // Add waterfalls below the spectrum graphs, the image rows run against the y axis
+            for (ChannelID channel = 0; channel < scope->spectrum.size(); ++channel) {
+                if (scope->spectrum[channel].used && result->data(channel) &&
+                    result->data(channel)->spectrogram) {
+                    painter.drawImage(QRectF(-DIVS_TIME / 2, -DIVS_VOLTAGE / 2, DIVS_TIME, DIVS_VOLTAGE),
+                                      result->data(channel)->spectrogram->toImage(colorValues->spectrum[channel])
+                                          .mirrored());
                 }
+            }
 
-                // Add spectrum graphs
-                for (ChannelID channel = 0; channel < settings->scope.spectrum.size(); ++channel) {
-                    if (settings->scope.spectrum[channel].used && result->data(channel)) {
-                        painter.setPen(QPen(colorValues->spectrum[channel], 0));
-
-                        // What's the horizontal distance between sampling points?
-                        double horizontalFactor =
-                            result->data(channel)->spectrum.interval / settings->scope.horizontal.frequencybase;
-                        // How many samples are visible?
-                        double centerPosition, centerOffset;
-                        if (zoomed) {
-                            centerPosition = (zoomOffset + DIVS_TIME / 2) / horizontalFactor;
-                            centerOffset = DIVS_TIME / horizontalFactor / zoomFactor / 2;
-                        } else {
-                            centerPosition = DIVS_TIME / 2 / horizontalFactor;
-                            centerOffset = DIVS_TIME / horizontalFactor / 2;
-                        }
-                        unsigned int firstPosition = qMax((int)(centerPosition - centerOffset), 0);
-                        unsigned int lastPosition = qMin((int)(centerPosition + centerOffset),
-                                                         (int)result->data(channel)->spectrum.sample.size() - 1);
-
-                        // Draw graph
-                        QPointF *graph = new QPointF[lastPosition - firstPosition + 1];
-
-                        for (unsigned int position = firstPosition; position <= lastPosition; ++position)
-                            graph[position - firstPosition] =
-                                QPointF(position * horizontalFactor - DIVS_TIME / 2,
-                                        result->data(channel)->spectrum.sample[position] /
-                                                settings->scope.spectrum[channel].magnitude +
-                                            settings->scope.spectrum[channel].offset);
-
-                        painter.drawPolyline(graph, lastPosition - firstPosition + 1);
-                        delete[] graph;
-                    }
+            // Add spectrum graphs
+            for (ChannelID channel = 0; channel < scope->spectrum.size(); ++channel) {
+                if (scope->spectrum[channel].used && result->data(channel)) {
+                    painter.setPen(QPen(colorValues->spectrum[channel], 0));
+
+                    // What's the horizontal distance between sampling points?
+                    double horizontalFactor =
+                        result->data(channel)->spectrum.interval / scope->horizontal.frequencybase;
+                    unsigned int firstPosition, lastPosition;
+                    visibleRange(horizontalFactor, result->data(channel)->spectrum.sample.size(), zoomed, zoomFactor,
+                                 zoomOffset, firstPosition, lastPosition);
+                    if (lastPosition < firstPosition) continue;
+
+                    // Draw graph
+                    QPointF *graph = new QPointF[lastPosition - firstPosition + 1];
+
+                    for (unsigned int position = firstPosition; position <= lastPosition; ++position)
+                        graph[position - firstPosition] =
+                            QPointF(position * horizontalFactor - DIVS_TIME / 2,
+                                    result->data(channel)->spectrum.sample[position] /
+                                            scope->spectrum[channel].magnitude +
+                                        scope->spectrum[channel].offset);
+
+                    painter.drawPolyline(graph, lastPosition - firstPosition + 1);
+                    delete[] graph;
                 }
-                break;
+            }
+            break;
+
+        case Dso::GraphFormat::XY:
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+void LegacyExportDrawer::drawGraphsRaster(QImage *image, const PPresult *result, const DsoSettingsScope *scope,
+                                          bool zoom, const DsoSettingsColorValues *colorValues, double scopeHeight,
+                                          double lineHeight) {
+    if (scope->horizontal.format != Dso::GraphFormat::TY) return;
 
-            case Dso::GraphFormat::XY:
-                break;
+    double m1 = scope->getMarker(0);
+    double m2 = scope->getMarker(1);
+    double zoomFactor = DIVS_TIME / fabs(m2 - m1);
+    double zoomOffset = (m1 + m2) / 2;
 
-            default:
-                break;
+    for (int zoomed = 0; zoomed < (zoom ? 2 : 1); ++zoomed) {
+        const QMatrix matrix = scopeMatrix(image->width(), scopeHeight, lineHeight, zoomed, zoomFactor, zoomOffset);
+        const double top = matrix.dy() + matrix.m22() * DIVS_VOLTAGE / 2;
+        const double bottom = matrix.dy() - matrix.m22() * DIVS_VOLTAGE / 2;
+        auto addTrace = [&](std::vector<Trace> &traces, const SampleValues &values, double base, double scale,
+                            double offset, const QColor &color) {
+            const double horizontalFactor = values.interval / base;
+            if (!(horizontalFactor > 0)) return;
+            Trace trace;
+            visibleRange(horizontalFactor, values.sample.size(), zoomed, zoomFactor, zoomOffset, trace.first,
+                         trace.last);
+            if (trace.last < trace.first) return;
+            trace.samples = &values.sample;
+            trace.x0 = matrix.dx() - matrix.m11() * DIVS_TIME / 2;
+            trace.dx = matrix.m11() * horizontalFactor;
+            trace.y0 = matrix.dy() + matrix.m22() * offset;
+            trace.dy = matrix.m22() / scale;
+            trace.top = top;
+            trace.bottom = bottom;
+            trace.color = qPremultiply(color.rgba());
+            traces.push_back(trace);
+        };
+
+        // Voltage graphs
+        std::vector<Trace> traces;
+        for (ChannelID channel = 0; channel < scope->voltage.size(); ++channel) {
+            if (scope->voltage[channel].used && result->data(channel))
+                addTrace(traces, result->data(channel)->voltage, scope->horizontal.timebase,
+                         scope->gain(channel), scope->voltage[channel].offset,
+                         colorValues->voltage[channel]);
+        }
+        rasterizeTracesParallel(image, traces);
+
+        // Waterfalls below the spectrum graphs, the image rows run against the y axis
+        for (ChannelID channel = 0; channel < scope->spectrum.size(); ++channel) {
+            if (scope->spectrum[channel].used && result->data(channel) &&
+                result->data(channel)->spectrogram) {
+                QPainter painter(image);
+                painter.setMatrix(matrix, false);
+                painter.drawImage(QRectF(-DIVS_TIME / 2, -DIVS_VOLTAGE / 2, DIVS_TIME, DIVS_VOLTAGE),
+                                  result->data(channel)->spectrogram->toImage(colorValues->spectrum[channel]).mirrored());
             }
+        }
 
-            // Set DIVS_TIME / zoomFactor x DIVS_VOLTAGE matrix for zoomed
-            // oscillograph
-            painter.setMatrix(QMatrix((paintDevice->width() - 1) / DIVS_TIME * zoomFactor, 0, 0,
-                                      -(scopeHeight - 1) / DIVS_VOLTAGE,
-                                      (double)(paintDevice->width() - 1) / 2 -
-                                          zoomOffset * zoomFactor * (paintDevice->width() - 1) / DIVS_TIME,
-                                      (scopeHeight - 1) * 1.5 + lineHeight * 4),
-                              false);
+        // Spectrum graphs
+        traces.clear();
+        for (ChannelID channel = 0; channel < scope->spectrum.size(); ++channel) {
+            if (scope->spectrum[channel].used && result->data(channel))
+                addTrace(traces, result->data(channel)->spectrum, scope->horizontal.frequencybase,
+                         scope->spectrum[channel].magnitude, scope->spectrum[channel].offset,
+                         colorValues->spectrum[channel]);
         }
-    } // dataanalyser mutex release
+        rasterizeTracesParallel(image, traces);
+    }
+}
 
-    drawGrids(painter, colorValues, lineHeight, scopeHeight, paintDevice->width(),
-              isPrinter, settings->view.zoom);
-    painter.end();
+void LegacyExportDrawer::rasterizeTraces(uchar *bits, int bytesPerLine, int height, const std::vector<Trace> &traces,
+                                         int columnBegin, int columnEnd) {
+    for (const Trace &trace : traces) {
+        const double *samples = trace.samples->data();
+        const double xFirst = trace.x0 + trace.first * trace.dx;
+        const double xLast = trace.x0 + trace.last * trace.dx;
+        // The value of the polyline at the pixel position x
+        auto valueAt = [&](double x) {
+            const double position = (x - trace.x0) / trace.dx;
+            unsigned index = (unsigned)std::max((double)trace.first, std::floor(position));
+            if (index >= trace.last) return samples[trace.last];
+            return samples[index] + (position - index) * (samples[index + 1] - samples[index]);
+        };
+
+        const int rowMin = std::max(0, (int)std::ceil(trace.top - 0.5));
+        const int rowMax = std::min(height - 1, (int)std::floor(trace.bottom + 0.5));
+        const int first = std::max(columnBegin, (int)std::ceil(xFirst - 0.5));
+        const int last = std::min(columnEnd - 1, (int)std::floor(xLast + 0.5));
+        const unsigned alpha = qAlpha(trace.color);
+
+        for (int column = first; column <= last; ++column) {
+            // The range of the polyline within this column, the edges connect it to the neighbours
+            const double left = std::max(column - 0.5, xFirst);
+            const double right = std::min(column + 0.5, xLast);
+            double minimum = valueAt(left);
+            double maximum = minimum;
+            const double rightValue = valueAt(right);
+            minimum = std::min(minimum, rightValue);
+            maximum = std::max(maximum, rightValue);
+            const unsigned begin = (unsigned)std::max((double)trace.first, std::ceil((left - trace.x0) / trace.dx));
+            const unsigned end = (unsigned)std::min((double)trace.last, std::floor((right - trace.x0) / trace.dx));
+            for (unsigned index = begin; index <= end && index <= trace.last; ++index) {
+                minimum = std::min(minimum, samples[index]);
+                maximum = std::max(maximum, samples[index]);
+            }
 
-    return true;
+            // The y axis points downwards, dy is negative
+            const double y1 = trace.y0 + trace.dy * minimum;
+            const double y2 = trace.y0 + trace.dy * maximum;
+            const int rowBegin = std::max(rowMin, (int)std::floor(std::min(y1, y2) + 0.5));
+            const int rowEnd = std::min(rowMax, (int)std::floor(std::max(y1, y2) + 0.5));
+            for (int row = rowBegin; row <= rowEnd; ++row) {
+                QRgb *pixel = reinterpret_cast<QRgb *>(bits + (size_t)row * bytesPerLine) + column;
+                if (alpha == 255) {
+                    *pixel = trace.color;
+                } else {
+                    const unsigned inverse = 255 - alpha;
+                    *pixel = qRgba(qRed(trace.color) + qRed(*pixel) * inverse / 255,
+                                   qGreen(trace.color) + qGreen(*pixel) * inverse / 255,
+                                   qBlue(trace.color) + qBlue(*pixel) * inverse / 255,
+                                   alpha + qAlpha(*pixel) * inverse / 255);
+                }
+            }
+        }
+    }
+}
+
+void LegacyExportDrawer::rasterizeTracesParallel(QImage *image, const std::vector<Trace> &traces) {
+    if (traces.empty()) return;
+    uchar *bits = image->bits();
+    const int bytesPerLine = image->bytesPerLine();
+    const int width = image->width();
+    const int height = image->height();
+
+    // Tiles of whole pixel columns don't overlap, every thread draws all traces into its own tile
+    const int tileCount = std::max(1, std::min((int)std::thread::hardware_concurrency(), width / 64));
+    const int tileWidth = (width + tileCount - 1) / tileCount;
+    std::vector<std::thread> threads;
+    for (int tile = 1; tile < tileCount; ++tile)
+        threads.emplace_back(&LegacyExportDrawer::rasterizeTraces, bits, bytesPerLine, height, std::cref(traces),
+                             tile * tileWidth, std::min(width, (tile + 1) * tileWidth));
+    rasterizeTraces(bits, bytesPerLine, height, traces, 0, std::min(width, tileWidth));
+    for (std::thread &thread : threads) thread.join();
 }
 
 void LegacyExportDrawer::drawGrids(QPainter &painter, const DsoSettingsColorValues *colorValues, double lineHeight, double scopeHeight,
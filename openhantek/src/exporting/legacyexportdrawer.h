@@ -2,18 +2,26 @@
 
 #pragma once
 
+#include <QImage>
 #include <QPainter>
 #include <QPrinter>
 #include <QSize>
 #include <memory>
+#include <mutex>
+#include <vector>
 #include "exportsettings.h"
 
-class DsoSettings;
+struct DsoSettingsScope;
 class PPresult;
 struct DsoSettingsColorValues;
 namespace Dso { struct ControlSpecification; }
 
 /// \brief Exports the oscilloscope screen to a file or prints it.
+/// Printers and pdf files get vector graphics, every sample is a point of a polyline. Images are rasterized
+/// directly instead: Each pixel column of a graph covers the minimum to maximum of the samples that fall into
+/// it, so the work grows with the sample count but not the drawing. The columns are split into tiles that
+/// are rendered in parallel. The grid is drawn into a transparent layer that the caller may keep for the next
+/// export, as long as the size, colors and zoom stay the same. The labels change with every frame.
 /// TODO
 /// Rewrite image exporter with OpenGL drawn grid and graphs
 ///
@@ -24,12 +32,63 @@ namespace Dso { struct ControlSpecification; }
 /// https://dangelog.wordpress.com/2013/02/10/using-fbos-instead-of-pbuffers-in-qt-5-2/
 class LegacyExportDrawer {
   public:
+    /// \brief The grid layer of the last image export, owned by the exporter.
+    struct GridCache {
+        std::mutex mutex; ///< Guards against overlapping saves of the owning exporter
+        QSize size;
+        double lineHeight = 0;
+        double scopeHeight = 0;
+        bool zoom = false;
+        QColor axes, border, grid;
+        QImage image;
+    };
+
     /// Draw the graphs coming from source and labels to the destination paintdevice.
+    /// \param gridCache Keeps the grid layer of images for the next call, nullptr to draw it every time.
     static bool exportSamples(const PPresult *source, QPaintDevice* dest,
                        const Dso::ControlSpecification* deviceSpecification,
-                       const DsoSettings *settings, bool isPrinter, const DsoSettingsColorValues *colorValues);
+                       const DsoSettingsScope *scope, bool zoom, bool isPrinter,
+                       const DsoSettingsColorValues *colorValues, GridCache *gridCache = nullptr);
 
   private:
+    /// \brief A text of the settings, measurement or marker tables.
+    struct Label {
+        QRectF rect;
+        QString text;
+        QColor color;
+        bool alignRight;
+    };
+
+    /// \brief Polyline of a graph in pixel coordinates: Sample i is at (x0 + i * dx, y0 + samples[i] * dy).
+    struct Trace {
+        const std::vector<double> *samples;
+        unsigned first, last; ///< The visible samples
+        double x0, dx;
+        double y0, dy;
+        double top, bottom; ///< Pixel rows of the scope screen, the graph is clipped to them
+        QRgb color;         ///< Premultiplied
+    };
+
+    /// Collect the texts above and below the scope screens.
+    /// \return The height of a scope screen.
+    static double collectLabels(const PPresult *result, const QSize &size, double lineHeight,
+                                const Dso::ControlSpecification *deviceSpecification, const DsoSettingsScope *scope,
+                                bool zoom, const DsoSettingsColorValues *colorValues, std::vector<Label> &labels);
+    static void drawLabels(QPainter &painter, const std::vector<Label> &labels);
+    /// The DIVS_TIME x DIVS_VOLTAGE matrix of the normal (zoomed = false) or zoomed oscillograph.
+    static QMatrix scopeMatrix(int scopeWidth, double scopeHeight, double lineHeight, bool zoomed, double zoomFactor,
+                               double zoomOffset);
+    /// Draw the graphs as polylines, used for vector output.
+    static void drawGraphs(QPainter &painter, const PPresult *result, const DsoSettingsScope *scope, bool zoom,
+                           const DsoSettingsColorValues *colorValues, int scopeWidth, double scopeHeight,
+                           double lineHeight);
+    /// Rasterize the graphs directly into the image.
+    static void drawGraphsRaster(QImage *image, const PPresult *result, const DsoSettingsScope *scope, bool zoom,
+                                 const DsoSettingsColorValues *colorValues, double scopeHeight, double lineHeight);
+    /// Draw the traces into the pixel columns [columnBegin, columnEnd) of a 32 bit premultiplied image.
+    static void rasterizeTraces(uchar *bits, int bytesPerLine, int height, const std::vector<Trace> &traces,
+                                int columnBegin, int columnEnd);
+    static void rasterizeTracesParallel(QImage *image, const std::vector<Trace> &traces);
     static void drawGrids(QPainter &painter, const DsoSettingsColorValues *colorValues, double lineHeight, double scopeHeight,
                    int scopeWidth, bool isPrinter, bool zoom);
 };
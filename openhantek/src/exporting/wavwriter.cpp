@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "wavwriter.h"
+
+namespace {
+const qint64 RIFF_SIZE_OFFSET = 4;  ///< Offset of the RIFF size
+const qint64 DS64_OFFSET = 12;      ///< Offset of the JUNK / ds64 chunk
+const qint64 DS64_SIZE = 28;        ///< Payload of the ds64 chunk without a table
+const qint64 DATA_SIZE_OFFSET = 78; ///< Offset of the data chunk size
+const qint64 HEADER_SIZE = 82;      ///< RIFF, ds64/JUNK, fmt (18 bytes payload) and data chunk header
+
+void put16(char *destination, uint16_t value) { qToLittleEndian(value, reinterpret_cast<uchar *>(destination)); }
+void put32(char *destination, uint32_t value) { qToLittleEndian(value, reinterpret_cast<uchar *>(destination)); }
+void put64(char *destination, uint64_t value) { qToLittleEndian(value, reinterpret_cast<uchar *>(destination)); }
+} // namespace
+
+WavWriter::WavWriter(const QString &fileName, unsigned channels, uint32_t sampleRate, Format format)
+    : file(fileName), channels(channels), sampleRate(sampleRate), format(format) {}
+
+bool WavWriter::open() {
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    dataBytes = 0;
+
+    const unsigned bytesPerSample = format == Format::INT16 ? 2 : 4;
+    char header[HEADER_SIZE];
+    std::memset(header, 0, sizeof(header));
+    std::memcpy(header, "RIFF", 4);
+    std::memcpy(header + 8, "WAVE", 4);
+    std::memcpy(header + DS64_OFFSET, "JUNK", 4);
+    put32(header + DS64_OFFSET + 4, DS64_SIZE);
+    char *fmt = header + DS64_OFFSET + 8 + DS64_SIZE;
+    std::memcpy(fmt, "fmt ", 4);
+    put32(fmt + 4, 18);
+    put16(fmt + 8, format == Format::INT16 ? 1 : 3); // WAVE_FORMAT_PCM or WAVE_FORMAT_IEEE_FLOAT
+    put16(fmt + 10, (uint16_t)channels);
+    put32(fmt + 12, sampleRate);
+    put32(fmt + 16, sampleRate * channels * bytesPerSample);
+    put16(fmt + 20, (uint16_t)(channels * bytesPerSample));
+    put16(fmt + 22, (uint16_t)(bytesPerSample * 8));
+    std::memcpy(header + DATA_SIZE_OFFSET - 4, "data", 4);
+    return file.write(header, HEADER_SIZE) == HEADER_SIZE;
+}
+
+bool WavWriter::write(const float *samples, size_t frames) {
+    const size_t count = frames * channels;
+    qint64 bytes;
+    if (format == Format::FLOAT32) {
+        // WAV is little endian like the supported hosts, the samples are written as they are
+        static_assert(sizeof(float) == 4, "WAV float samples have 32 bits");
+        bytes = (qint64)(count * sizeof(float));
+        if (file.write(reinterpret_cast<const char *>(samples), bytes) != bytes) return false;
+    } else {
+        converted.resize(count);
+        for (size_t index = 0; index < count; ++index) {
+            const float value = std::min(1.0f, std::max(-1.0f, samples[index]));
+            converted[index] = qToLittleEndian((int16_t)std::lrint(value * 32767.0f));
+        }
+        bytes = (qint64)(count * sizeof(int16_t));
+        if (file.write(reinterpret_cast<const char *>(converted.data()), bytes) != bytes) return false;
+    }
+    dataBytes += (uint64_t)bytes;
+    return true;
+}
+
+bool WavWriter::close() {
+    // Chunks have an even size
+    if (dataBytes & 1) {
+        if (file.write("", 1) != 1) return false;
+    }
+    const uint64_t riffBytes = HEADER_SIZE - 8 + dataBytes + (dataBytes & 1);
+    char size[8];
+    if (riffBytes <= 0xffffffffu) {
+        put32(size, (uint32_t)riffBytes);
+        if (!file.seek(RIFF_SIZE_OFFSET) || file.write(size, 4) != 4) return false;
+        put32(size, (uint32_t)dataBytes);
+        if (!file.seek(DATA_SIZE_OFFSET) || file.write(size, 4) != 4) return false;
+    } else {
+        char ds64[8 + DS64_SIZE];
+        std::memset(ds64, 0, sizeof(ds64));
+        std::memcpy(ds64, "ds64", 4);
+        put32(ds64 + 4, DS64_SIZE);
+        put64(ds64 + 8, riffBytes);
+        put64(ds64 + 16, dataBytes);
+        put64(ds64 + 24, dataBytes / (channels * (format == Format::INT16 ? 2 : 4)));
+        if (!file.seek(0) || file.write("RF64\xff\xff\xff\xff", 8) != 8) return false;
+        if (!file.seek(DS64_OFFSET) || file.write(ds64, sizeof(ds64)) != (qint64)sizeof(ds64)) return false;
+        put32(size, 0xffffffffu);
+        if (!file.seek(DATA_SIZE_OFFSET) || file.write(size, 4) != 4) return false;
+    }
+    file.close();
+    return file.error() == QFile::NoError;
+}
+
+void WavWriter::remove() {
+    file.close();
+    file.remove();
+}
@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <QFile>
+#include <QString>
+
+#include <cstdint>
+#include <vector>
+
+/// \brief Writes interleaved samples into a WAV file, switching to RF64 for files above 4 GB.
+/// The header reserves a JUNK chunk of the size of the RF64 ds64 chunk. The samples are streamed to the file
+/// and close() fills in the sizes. If the data exceeds the 32 bit sizes of a RIFF file, the header is turned
+/// into an RF64 header by replacing the JUNK chunk with the ds64 chunk (EBU Tech 3306), otherwise the file is
+/// a plain WAV file that every tool reads.
+class WavWriter {
+  public:
+    enum class Format {
+        INT16,  ///< 16 bit PCM, the samples -1..1 are scaled to the full range
+        FLOAT32 ///< 32 bit IEEE float, the samples are written unchanged
+    };
+
+    WavWriter(const QString &fileName, unsigned channels, uint32_t sampleRate, Format format);
+
+    /// \brief Creates the file and writes the header.
+    bool open();
+    /// \brief Appends frames of interleaved samples, one sample per channel and frame.
+    bool write(const float *samples, size_t frames);
+    /// \brief Completes the header and closes the file.
+    bool close();
+    /// \brief Closes and deletes the incomplete file.
+    void remove();
+
+  private:
+    QFile file;
+    unsigned channels;
+    uint32_t sampleRate;
+    Format format;
+    uint64_t dataBytes = 0;
+    std::vector<int16_t> converted; ///< INT16: Reused conversion buffer
+};
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include <QDateTime>
+#include <QtEndian>
+
+#include "zipwriter.h"
+
+namespace {
+const uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+const uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+const uint32_t END_SIGNATURE = 0x06054b50;
+const uint32_t ZIP64_END_SIGNATURE = 0x06064b50;
+const uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+const uint16_t VERSION_STORED = 10; ///< Version needed to extract stored entries
+const uint16_t VERSION_ZIP64 = 45;  ///< Version needed to extract Zip64 archives
+
+void append16(QByteArray &data, uint16_t value) {
+    uchar bytes[2];
+    qToLittleEndian(value, bytes);
+    data.append(reinterpret_cast<const char *>(bytes), 2);
+}
+
+void append32(QByteArray &data, uint32_t value) {
+    uchar bytes[4];
+    qToLittleEndian(value, bytes);
+    data.append(reinterpret_cast<const char *>(bytes), 4);
+}
+
+void append64(QByteArray &data, uint64_t value) {
+    uchar bytes[8];
+    qToLittleEndian(value, bytes);
+    data.append(reinterpret_cast<const char *>(bytes), 8);
+}
+
+/// \brief Lookup table of the reflected CRC-32 polynomial.
+struct CrcTable {
+    CrcTable() {
+        for (uint32_t index = 0; index < 256; ++index) {
+            uint32_t value = index;
+            for (int bit = 0; bit < 8; ++bit) value = (value & 1) ? 0xedb88320u ^ (value >> 1) : value >> 1;
+            values[index] = value;
+        }
+    }
+    uint32_t values[256];
+};
+} // namespace
+
+ZipWriter::ZipWriter(QIODevice *device) : device(device) {
+    const QDateTime now = QDateTime::currentDateTime();
+    dosTime = (uint16_t)((now.time().hour() << 11) | (now.time().minute() << 5) | (now.time().second() / 2));
+    dosDate = (uint16_t)(((now.date().year() - 1980) << 9) | (now.date().month() << 5) | now.date().day());
+}
+
+uint32_t ZipWriter::crc32(const char *data, size_t size, uint32_t crc) {
+    static const CrcTable table;
+    crc = ~crc;
+    for (size_t index = 0; index < size; ++index)
+        crc = table.values[(crc ^ (uint8_t)data[index]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+bool ZipWriter::write(const QByteArray &data) {
+    if (device->write(data) != data.size()) return false;
+    offset += (uint64_t)data.size();
+    return true;
+}
+
+bool ZipWriter::addFile(const QByteArray &name, const char *data, size_t size) {
+    // The entries hold chunks of a capture, they never reach the 4 GB that would need Zip64 sizes
+    if ((uint64_t)size >= 0xffffffffu) return false;
+
+    Entry entry = {name, crc32(data, size), (uint32_t)size, offset};
+
+    QByteArray header;
+    append32(header, LOCAL_HEADER_SIGNATURE);
+    append16(header, VERSION_STORED);
+    append16(header, 0); // Flags
+    append16(header, 0); // Stored
+    append16(header, dosTime);
+    append16(header, dosDate);
+    append32(header, entry.crc);
+    append32(header, entry.size); // Compressed size
+    append32(header, entry.size);
+    append16(header, (uint16_t)name.size());
+    append16(header, 0); // Extra field length
+    header.append(name);
+    if (!write(header)) return false;
+
+    if (device->write(data, (qint64)size) != (qint64)size) return false;
+    offset += size;
+    entries.push_back(entry);
+    return true;
+}
+
+bool ZipWriter::finish() {
+    const uint64_t directoryOffset = offset;
+    for (const Entry &entry : entries) {
+        const bool zip64 = entry.offset >= 0xffffffffu;
+        QByteArray header;
+        append32(header, CENTRAL_HEADER_SIGNATURE);
+        append16(header, VERSION_ZIP64); // Version made by: MS-DOS attributes
+        append16(header, zip64 ? VERSION_ZIP64 : VERSION_STORED);
+        append16(header, 0); // Flags
+        append16(header, 0); // Stored
+        append16(header, dosTime);
+        append16(header, dosDate);
+        append32(header, entry.crc);
+        append32(header, entry.size);
+        append32(header, entry.size);
+        append16(header, (uint16_t)entry.name.size());
+        append16(header, zip64 ? 12 : 0); // Extra field length
+        append16(header, 0);              // Comment length
+        append16(header, 0);              // Disk
+        append16(header, 0);              // Internal attributes
+        append32(header, 0);              // External attributes
+        append32(header, zip64 ? 0xffffffffu : (uint32_t)entry.offset);
+        header.append(entry.name);
+        if (zip64) {
+            append16(header, 0x0001); // Zip64 extended information
+            append16(header, 8);
+            append64(header, entry.offset);
+        }
+        if (!write(header)) return false;
+    }
+    const uint64_t directorySize = offset - directoryOffset;
+
+    QByteArray end;
+    const bool zip64 = entries.size() >= 0xffff || directoryOffset >= 0xffffffffu || directorySize >= 0xffffffffu;
+    if (zip64) {
+        const uint64_t zip64EndOffset = offset;
+        append32(end, ZIP64_END_SIGNATURE);
+        append64(end, 44); // Size of the remaining record
+        append16(end, VERSION_ZIP64);
+        append16(end, VERSION_ZIP64);
+        append32(end, 0); // Disk
+        append32(end, 0); // Disk of the central directory
+        append64(end, entries.size());
+        append64(end, entries.size());
+        append64(end, directorySize);
+        append64(end, directoryOffset);
+        append32(end, ZIP64_LOCATOR_SIGNATURE);
+        append32(end, 0); // Disk of the Zip64 end record
+        append64(end, zip64EndOffset);
+        append32(end, 1); // Number of disks
+    }
+    append32(end, END_SIGNATURE);
+    append16(end, 0); // Disk
+    append16(end, 0); // Disk of the central directory
+    append16(end, zip64 ? 0xffff : (uint16_t)entries.size());
+    append16(end, zip64 ? 0xffff : (uint16_t)entries.size());
+    append32(end, zip64 ? 0xffffffffu : (uint32_t)directorySize);
+    append32(end, zip64 ? 0xffffffffu : (uint32_t)directoryOffset);
+    append16(end, 0); // Comment length
+    return write(end);
+}
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+
+#include <cstdint>
+#include <vector>
+
+/// \brief Writes a zip archive entry by entry, without keeping the archive in memory.
+/// The entries are stored without compression, every entry is written completely by one addFile() call,
+/// so the sizes and checksums are known in the local headers. Archives above 4 GB or with more than 65535
+/// entries get the Zip64 records.
+class ZipWriter {
+  public:
+    /// \param device The opened output, written sequentially from its current position (usually 0).
+    explicit ZipWriter(QIODevice *device);
+
+    /// \brief Appends an entry.
+    /// \param name The file name within the archive.
+    bool addFile(const QByteArray &name, const char *data, size_t size);
+    /// \brief Writes the central directory, no entries can be added afterwards.
+    bool finish();
+
+    /// \return The bytes written so far.
+    uint64_t size() const { return offset; }
+
+    /// \brief The CRC-32 checksum of zip, gzip and png.
+    static uint32_t crc32(const char *data, size_t size, uint32_t crc = 0);
+
+  private:
+    struct Entry {
+        QByteArray name;
+        uint32_t crc;
+        uint32_t size;
+        uint64_t offset; ///< Position of the local header
+    };
+
+    bool write(const QByteArray &data);
+
+    QIODevice *device;
+    std::vector<Entry> entries;
+    uint64_t offset = 0;
+    uint16_t dosTime;
+    uint16_t dosDate;
+};
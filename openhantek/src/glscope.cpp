@@ -11,6 +11,7 @@
 #include <QMouseEvent>
 #include <QOpenGLShaderProgram>
 #include <QPainter>
+#include <QVector4D>
 
 #include <QOpenGLFunctions>
 
@@ -18,6 +19,7 @@
 
 #include "post/graphgenerator.h"
 #include "post/ppresult.h"
+#include "post/spectrogram.h"
 #include "scopesettings.h"
 #include "viewconstants.h"
 #include "viewsettings.h"
@@ -66,7 +68,27 @@ GlScope::GlScope(DsoSettingsScope *scope, DsoSettingsView *view, QWidget *parent
     vaMarker.resize(cursorInfo.size());
 }
 
-GlScope::~GlScope() {/* virtual destructor necessary */}
+// Single channel texture formats of desktop OpenGL, not declared by the OpenGL ES headers
+#ifndef GL_RED
+#define GL_RED 0x1903
+#endif
+#ifndef GL_R8
+#define GL_R8 0x8229
+#endif
+#ifndef GL_PROGRAM_POINT_SIZE
+#define GL_PROGRAM_POINT_SIZE 0x8642
+#endif
+
+/// Size of the palette of the dot shaders, the voltage and spectrum colors of all channels have to fit.
+static const unsigned DOT_PALETTE_SIZE = 16;
+
+GlScope::~GlScope() {
+    if (spectrogramTextures.empty()) return;
+    makeCurrent();
+    for (SpectrogramTexture &texture : spectrogramTextures)
+        if (texture.texture) context()->functions()->glDeleteTextures(1, &texture.texture);
+    doneCurrent();
+}
 
 QPointF GlScope::eventToPosition(QMouseEvent *event) {
     QPointF position((double)(event->x() - width() / 2) * DIVS_TIME / (double)width(),
@@ -273,6 +295,234 @@ void GlScope::initializeGL() {
 
     m_program = std::move(program);
     shaderCompileSuccess = true;
+
+    initializeSpectrogram();
+    initializeDots();
+}
+
+void GlScope::initializeDots() {
+    if (scope->voltage.size() + scope->spectrum.size() > DOT_PALETTE_SIZE) return;
+
+    auto program = std::unique_ptr<QOpenGLShaderProgram>(new QOpenGLShaderProgram(context()));
+
+    const char *vshaderES = R"(
+          #version 100
+          attribute highp vec3 vertex;
+          attribute highp float colorIndex;
+          uniform mat4 matrix;
+          uniform highp vec4 palette[16];
+          uniform highp float brightness;
+          uniform highp float pointSize;
+          varying highp vec4 color;
+          void main()
+          {
+              gl_Position = matrix * vec4(vertex, 1.0);
+              gl_PointSize = pointSize;
+              highp vec4 channelColor = palette[int(colorIndex + 0.5)];
+              color = vec4(channelColor.rgb * brightness, channelColor.a);
+          }
+    )";
+    const char *fshaderES = R"(
+          #version 100
+          varying highp vec4 color;
+          void main() { gl_FragColor = color; }
+    )";
+
+    const char *vshaderDesktop = R"(
+          #version 150
+          in highp vec3 vertex;
+          in highp float colorIndex;
+          uniform mat4 matrix;
+          uniform highp vec4 palette[16];
+          uniform highp float brightness;
+          uniform highp float pointSize;
+          out highp vec4 color;
+          void main()
+          {
+              gl_Position = matrix * vec4(vertex, 1.0);
+              gl_PointSize = pointSize;
+              highp vec4 channelColor = palette[int(colorIndex + 0.5)];
+              color = vec4(channelColor.rgb * brightness, channelColor.a);
+          }
+    )";
+    const char *fshaderDesktop = R"(
+          #version 150
+          in highp vec4 color;
+          out vec4 flatColor;
+          void main() { flatColor = color; }
+    )";
+
+    bool usesOpenGL = QSurfaceFormat::defaultFormat().renderableType() == QSurfaceFormat::OpenGL;
+    if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex, usesOpenGL ? vshaderDesktop : vshaderES) ||
+        !program->addShaderFromSourceCode(QOpenGLShader::Fragment, usesOpenGL ? fshaderDesktop : fshaderES) ||
+        !program->link()) {
+        qWarning() << "Failed to compile the dot shaders, dots are drawn per channel:" << program->log();
+        return;
+    }
+
+    dotVertexLocation = program->attributeLocation("vertex");
+    dotColorIndexLocation = program->attributeLocation("colorIndex");
+    dotMatrixLocation = program->uniformLocation("matrix");
+    dotPaletteLocation = program->uniformLocation("palette");
+    dotBrightnessLocation = program->uniformLocation("brightness");
+    dotSizeLocation = program->uniformLocation("pointSize");
+    if (dotVertexLocation == -1 || dotColorIndexLocation == -1 || dotMatrixLocation == -1 ||
+        dotPaletteLocation == -1 || dotBrightnessLocation == -1 || dotSizeLocation == -1) {
+        qWarning() << "Failed to locate dot shader variable";
+        return;
+    }
+
+    // Desktop OpenGL ignores gl_PointSize otherwise, OpenGL ES always uses it
+    if (usesOpenGL) context()->functions()->glEnable(GL_PROGRAM_POINT_SIZE);
+
+    m_dotProgram = std::move(program);
+}
+
+void GlScope::updateDotPalette() {
+    QVector4D palette[DOT_PALETTE_SIZE];
+    unsigned index = 0;
+    for (const QColor &color : view->screen.voltage)
+        palette[index++] = QVector4D((float)color.redF(), (float)color.greenF(), (float)color.blueF(),
+                                     (float)color.alphaF());
+    for (const QColor &color : view->screen.spectrum)
+        palette[index++] = QVector4D((float)color.redF(), (float)color.greenF(), (float)color.blueF(),
+                                     (float)color.alphaF());
+    m_dotProgram->setUniformValueArray(dotPaletteLocation, palette, (int)DOT_PALETTE_SIZE);
+}
+
+void GlScope::initializeSpectrogram() {
+    auto program = std::unique_ptr<QOpenGLShaderProgram>(new QOpenGLShaderProgram(context()));
+
+    const char *vshaderES = R"(
+          #version 100
+          attribute highp vec3 vertex;
+          attribute highp vec2 texCoord;
+          uniform mat4 matrix;
+          varying highp vec2 position;
+          void main()
+          {
+              gl_Position = matrix * vec4(vertex, 1.0);
+              position = texCoord;
+          }
+    )";
+    const char *fshaderES = R"(
+          #version 100
+          uniform sampler2D spectrogram;
+          uniform highp vec4 colour;
+          uniform highp float newestRow;
+          varying highp vec2 position;
+          void main()
+          {
+              highp float intensity = texture2D(spectrogram, vec2(position.x, fract(newestRow + position.y))).r;
+              gl_FragColor = vec4(colour.rgb, colour.a * intensity);
+          }
+    )";
+
+    const char *vshaderDesktop = R"(
+          #version 150
+          in highp vec3 vertex;
+          in highp vec2 texCoord;
+          uniform mat4 matrix;
+          out highp vec2 position;
+          void main()
+          {
+              gl_Position = matrix * vec4(vertex, 1.0);
+              position = texCoord;
+          }
+    )";
+    const char *fshaderDesktop = R"(
+          #version 150
+          uniform sampler2D spectrogram;
+          uniform highp vec4 colour;
+          uniform highp float newestRow;
+          in highp vec2 position;
+          out vec4 flatColor;
+          void main()
+          {
+              highp float intensity = texture(spectrogram, vec2(position.x, fract(newestRow + position.y))).r;
+              flatColor = vec4(colour.rgb, colour.a * intensity);
+          }
+    )";
+
+    bool usesOpenGL = QSurfaceFormat::defaultFormat().renderableType() == QSurfaceFormat::OpenGL;
+    if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex, usesOpenGL ? vshaderDesktop : vshaderES) ||
+        !program->addShaderFromSourceCode(QOpenGLShader::Fragment, usesOpenGL ? fshaderDesktop : fshaderES) ||
+        !program->link()) {
+        qWarning() << "Failed to compile the waterfall shaders, the waterfall is disabled:" << program->log();
+        return;
+    }
+
+    int vertex = program->attributeLocation("vertex");
+    int texCoord = program->attributeLocation("texCoord");
+    spectrogramMatrixLocation = program->uniformLocation("matrix");
+    spectrogramColorLocation = program->uniformLocation("colour");
+    spectrogramNewestRowLocation = program->uniformLocation("newestRow");
+    if (vertex == -1 || texCoord == -1 || spectrogramMatrixLocation == -1 || spectrogramColorLocation == -1 ||
+        spectrogramNewestRowLocation == -1) {
+        qWarning() << "Failed to locate waterfall shader variable";
+        return;
+    }
+
+    // The screen, counter-clockwise for the back face culling. The vertical texture coordinate runs
+    // from the newest row at the top (0) to the oldest row at the bottom (-1) and is wrapped in the shader.
+    const GLfloat quad[] = {-DIVS_TIME / 2, -DIVS_VOLTAGE / 2, 0, 0, -1, //
+                            DIVS_TIME / 2,  -DIVS_VOLTAGE / 2, 0, 1, -1, //
+                            DIVS_TIME / 2,  DIVS_VOLTAGE / 2,  0, 1, 0,  //
+                            -DIVS_TIME / 2, DIVS_VOLTAGE / 2,  0, 0, 0};
+    m_vaoSpectrogram.create();
+    QOpenGLVertexArrayObject::Binder b(&m_vaoSpectrogram);
+    m_spectrogramQuad.create();
+    m_spectrogramQuad.bind();
+    m_spectrogramQuad.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_spectrogramQuad.allocate(quad, sizeof(quad));
+    program->enableAttributeArray(vertex);
+    program->setAttributeBuffer(vertex, GL_FLOAT, 0, 3, 5 * sizeof(GLfloat));
+    program->enableAttributeArray(texCoord);
+    program->setAttributeBuffer(texCoord, GL_FLOAT, 3 * sizeof(GLfloat), 2, 5 * sizeof(GLfloat));
+
+    m_spectrogramProgram = std::move(program);
+}
+
+void GlScope::updateSpectrogram(const PPresult *data) {
+    if (!m_spectrogramProgram) return;
+    auto *gl = context()->functions();
+    const bool usesOpenGL = QSurfaceFormat::defaultFormat().renderableType() == QSurfaceFormat::OpenGL;
+
+    spectrogramTextures.resize(data->channelCount());
+    for (ChannelID channel = 0; channel < data->channelCount(); ++channel) {
+        SpectrogramTexture &texture = spectrogramTextures[channel];
+        const DataChannel *channelData = data->data(channel);
+
+        // Drop the history together with the SpectrogramGenerator
+        if (!channelData->spectrogram || channelData->spectrogramRow.size() != Spectrogram::WIDTH) {
+            if (texture.texture) gl->glDeleteTextures(1, &texture.texture);
+            texture = SpectrogramTexture();
+            continue;
+        }
+
+        gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        if (!texture.texture || texture.rows != channelData->spectrogram->rows()) {
+            if (!texture.texture) gl->glGenTextures(1, &texture.texture);
+            texture.rows = channelData->spectrogram->rows();
+            texture.newestRow = texture.rows - 1;
+            gl->glBindTexture(GL_TEXTURE_2D, texture.texture);
+            gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            const std::vector<uint8_t> empty(Spectrogram::WIDTH * texture.rows, 0);
+            gl->glTexImage2D(GL_TEXTURE_2D, 0, usesOpenGL ? GL_R8 : GL_LUMINANCE, (GLsizei)Spectrogram::WIDTH,
+                             (GLsizei)texture.rows, 0, usesOpenGL ? GL_RED : GL_LUMINANCE, GL_UNSIGNED_BYTE,
+                             empty.data());
+        } else
+            gl->glBindTexture(GL_TEXTURE_2D, texture.texture);
+
+        // One row per frame
+        texture.newestRow = (texture.newestRow + 1) % texture.rows;
+        gl->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, (GLint)texture.newestRow, (GLsizei)Spectrogram::WIDTH, 1,
+                            usesOpenGL ? GL_RED : GL_LUMINANCE, GL_UNSIGNED_BYTE, channelData->spectrogramRow.data());
+    }
+    gl->glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void GlScope::showData(std::shared_ptr<PPresult> data) {
@@ -288,7 +538,11 @@ void GlScope::showData(std::shared_ptr<PPresult> data) {
     m_GraphHistory.splice(m_GraphHistory.begin(), m_GraphHistory, std::prev(m_GraphHistory.end()));
 
     // Add new entry
-    m_GraphHistory.front().writeData(data.get(), m_program.get(), vertexLocation);
+    const bool dots = m_dotProgram && view->interpolation == Dso::INTERPOLATION_OFF;
+    m_GraphHistory.front().writeData(data.get(), m_program.get(), vertexLocation, dots);
+    if (dots)
+        m_GraphHistory.front().writeDots(data.get(), m_dotProgram.get(), dotVertexLocation, dotColorIndexLocation);
+    updateSpectrogram(data.get());
     // doneCurrent();
 
     update();
@@ -368,17 +622,40 @@ void GlScope::paintGL() {
     m_program->bind();
 
     // Apply zoom settings via matrix transformation
+    QMatrix4x4 matrix = pmvMatrix;
     if (zoomed) {
         QMatrix4x4 m;
         m.scale(QVector3D(DIVS_TIME / (GLfloat)fabs(scope->getMarker(1) - scope->getMarker(0)), 1.0f, 1.0f));
         m.translate((GLfloat) - (scope->getMarker(0) + scope->getMarker(1)) / 2, 0.0f, 0.0f);
-        m_program->setUniformValue(matrixLocation, pmvMatrix * m);
+        matrix = pmvMatrix * m;
+        m_program->setUniformValue(matrixLocation, matrix);
+    }
+
+    // The waterfall is the background of the spectrum graphs
+    if (scope->horizontal.format == Dso::GraphFormat::TY) {
+        for (ChannelID channel = 0; channel < spectrogramTextures.size(); ++channel)
+            drawSpectrogram(channel, matrix);
+        m_program->bind();
     }
 
     drawMarkers();
 
+    // The envelope is only drawn for the latest graph, below the voltage graphs
+    if (!m_GraphHistory.empty()) {
+        for (ChannelID channel = 0; channel < scope->voltage.size(); ++channel)
+            drawEnvelopeChannelGraph(channel, m_GraphHistory.front());
+    }
+
+    if (m_dotProgram) {
+        m_dotProgram->bind();
+        updateDotPalette();
+        m_dotProgram->setUniformValue(dotSizeLocation, (GLfloat)view->dotSize);
+        m_program->bind();
+    }
+
     unsigned historyIndex = 0;
     for (Graph &graph : m_GraphHistory) {
+        if (graph.dotCount) drawDots(graph, (int)historyIndex, matrix);
         for (ChannelID channel = 0; channel < scope->voltage.size(); ++channel) {
             if (scope->horizontal.format == Dso::GraphFormat::TY) {
                 drawSpectrumChannelGraph(channel, graph, (int)historyIndex);
@@ -570,8 +847,19 @@ void GlScope::drawMarkers() {
     m_vaoMarker.release();
 }
 
+void GlScope::drawDots(Graph &graph, int historyIndex, const QMatrix4x4 &matrix) {
+    m_dotProgram->bind();
+    m_dotProgram->setUniformValue(dotMatrixLocation, matrix);
+    // Same as QColor::darker(100 + 10 * historyIndex), which scales the value of the color
+    m_dotProgram->setUniformValue(dotBrightnessLocation, (GLfloat)(100.0 / (100 + 10 * historyIndex)));
+    QOpenGLVertexArrayObject::Binder b(&graph.vaoDots);
+    context()->functions()->glDrawArrays(GL_POINTS, 0, graph.dotCount);
+    m_program->bind();
+}
+
 void GlScope::drawVoltageChannelGraph(ChannelID channel, Graph &graph, int historyIndex) {
-    if (!scope->voltage[channel].used) return;
+    if (!scope->voltage[channel].used || channel >= graph.vaoVoltage.size() || graph.vaoVoltage[channel].second == 0)
+        return;
 
     m_program->setUniformValue(colorLocation, view->screen.voltage[channel].darker(100 + 10 * historyIndex));
     Graph::VaoCount &v = graph.vaoVoltage[channel];
@@ -582,7 +870,9 @@ void GlScope::drawVoltageChannelGraph(ChannelID channel, Graph &graph, int histo
 }
 
 void GlScope::drawSpectrumChannelGraph(ChannelID channel, Graph &graph, int historyIndex) {
-    if (!scope->spectrum[channel].used) return;
+    if (!scope->spectrum[channel].used || channel >= graph.vaoSpectrum.size() ||
+        graph.vaoSpectrum[channel].second == 0)
+        return;
 
     m_program->setUniformValue(colorLocation, view->screen.spectrum[channel].darker(100 + 10 * historyIndex));
     Graph::VaoCount &v = graph.vaoSpectrum[channel];
@@ -591,3 +881,44 @@ void GlScope::drawSpectrumChannelGraph(ChannelID channel, Graph &graph, int hist
     const GLenum dMode = (view->interpolation == Dso::INTERPOLATION_OFF) ? GL_POINTS : GL_LINE_STRIP;
     context()->functions()->glDrawArrays(dMode, 0, v.second);
 }
+
+void GlScope::drawEnvelopeChannelGraph(ChannelID channel, Graph &graph) {
+    if (!scope->voltage[channel].used || channel >= graph.vaoEnvelope.size()) return;
+    Graph::VaoCount &v = graph.vaoEnvelope[channel];
+    if (v.second == 0) return;
+
+    QColor color = view->screen.voltage[channel];
+    color.setAlphaF(0.25);
+    m_program->setUniformValue(colorLocation, color);
+
+    // The band winding flips for inverted channels and must not write depth, so that
+    // the voltage graph on the same plane is still drawn on top of it.
+    auto *gl = context()->functions();
+    gl->glDisable(GL_CULL_FACE);
+    gl->glDepthMask(GL_FALSE);
+    QOpenGLVertexArrayObject::Binder b(v.first);
+    gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, v.second);
+    gl->glDepthMask(GL_TRUE);
+    gl->glEnable(GL_CULL_FACE);
+}
+
+void GlScope::drawSpectrogram(ChannelID channel, const QMatrix4x4 &matrix) {
+    const SpectrogramTexture &texture = spectrogramTextures[channel];
+    if (!texture.texture || !scope->spectrum[channel].used) return;
+
+    m_spectrogramProgram->bind();
+    m_spectrogramProgram->setUniformValue(spectrogramMatrixLocation, matrix);
+    m_spectrogramProgram->setUniformValue(spectrogramColorLocation, view->screen.spectrum[channel]);
+    // Center of the newest row
+    m_spectrogramProgram->setUniformValue(spectrogramNewestRowLocation,
+                                          (GLfloat)((texture.newestRow + 0.5) / texture.rows));
+
+    auto *gl = context()->functions();
+    gl->glActiveTexture(GL_TEXTURE0);
+    gl->glBindTexture(GL_TEXTURE_2D, texture.texture);
+    gl->glDepthMask(GL_FALSE);
+    QOpenGLVertexArrayObject::Binder b(&m_vaoSpectrogram);
+    gl->glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    gl->glDepthMask(GL_TRUE);
+    gl->glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -77,6 +77,17 @@ class GlScope : public QOpenGLWidget {
 
     void drawVoltageChannelGraph(ChannelID channel, Graph &graph, int historyIndex);
     void drawSpectrumChannelGraph(ChannelID channel, Graph &graph, int historyIndex);
+    void drawEnvelopeChannelGraph(ChannelID channel, Graph &graph);
+    /// \brief Compiles the shaders that draw the dots of all channels with one draw call.
+    void initializeDots();
+    /// \brief Uploads the colors of all channels into the palette of the dot shader.
+    void updateDotPalette();
+    void drawDots(Graph &graph, int historyIndex, const QMatrix4x4 &matrix);
+    /// \brief Compiles the waterfall shaders and creates the quad that covers the screen.
+    void initializeSpectrogram();
+    /// \brief Uploads the newest waterfall row of every channel into its texture ring.
+    void updateSpectrogram(const PPresult *data);
+    void drawSpectrogram(ChannelID channel, const QMatrix4x4 &matrix);
     QPointF eventToPosition(QMouseEvent *event);
   signals:
     void markerMoved(unsigned cursorIndex, unsigned marker);
@@ -114,6 +125,31 @@ class GlScope : public QOpenGLWidget {
     std::list<Graph> m_GraphHistory;
     unsigned currentGraphInHistory = 0;
 
+    // Waterfall: One texture per channel is used as ring buffer of spectrum rows. Only the newest row is
+    // uploaded per frame, the rotation of the ring is done with texture coordinates in the shader.
+    struct SpectrogramTexture {
+        GLuint texture = 0;
+        unsigned rows = 0;      ///< Height of the texture
+        unsigned newestRow = 0; ///< Row written last
+    };
+    std::vector<SpectrogramTexture> spectrogramTextures;
+    std::unique_ptr<QOpenGLShaderProgram> m_spectrogramProgram;
+    QOpenGLBuffer m_spectrogramQuad;
+    QOpenGLVertexArrayObject m_vaoSpectrogram;
+    int spectrogramMatrixLocation;
+    int spectrogramColorLocation;
+    int spectrogramNewestRowLocation;
+
+    // Dots without interpolation: Every vertex selects its channel color from a palette uniform, so that
+    // the graphs of one phosphor level are drawn with a single glDrawArrays.
+    std::unique_ptr<QOpenGLShaderProgram> m_dotProgram;
+    int dotVertexLocation;
+    int dotColorIndexLocation;
+    int dotMatrixLocation;
+    int dotPaletteLocation;
+    int dotBrightnessLocation;
+    int dotSizeLocation;
+
     // OpenGL shader, matrix, var-locations
     bool shaderCompileSuccess = false;
     QString errorMessage;
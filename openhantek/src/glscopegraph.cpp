@@ -1,16 +1,22 @@
 #include "glscopegraph.h"
 #include <QDebug>
+#include <cstddef>
 
-Graph::Graph() : buffer(QOpenGLBuffer::VertexBuffer) {
+Graph::Graph() : buffer(QOpenGLBuffer::VertexBuffer), dotBuffer(QOpenGLBuffer::VertexBuffer) {
     buffer.create();
     buffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
 }
 
-void Graph::writeData(PPresult *data, QOpenGLShaderProgram *program, int vertexLocation) {
+void Graph::writeData(PPresult *data, QOpenGLShaderProgram *program, int vertexLocation, bool dots) {
+    static const ChannelGraph noGraph;
+
     // Determine memory
     int neededMemory = 0;
-    for (ChannelGraph &cg : data->vaChannelVoltage) neededMemory += cg.size() * sizeof(QVector3D);
-    for (ChannelGraph &cg : data->vaChannelSpectrum) neededMemory += cg.size() * sizeof(QVector3D);
+    if (!dots) {
+        for (ChannelGraph &cg : data->vaChannelVoltage) neededMemory += cg.size() * sizeof(QVector3D);
+        for (ChannelGraph &cg : data->vaChannelSpectrum) neededMemory += cg.size() * sizeof(QVector3D);
+    }
+    for (ChannelGraph &cg : data->vaChannelEnvelope) neededMemory += cg.size() * sizeof(QVector3D);
 
     buffer.bind();
     program->bind();
@@ -25,6 +31,7 @@ void Graph::writeData(PPresult *data, QOpenGLShaderProgram *program, int vertexL
     int offset = 0;
     vaoVoltage.resize(data->vaChannelVoltage.size());
     vaoSpectrum.resize(data->vaChannelSpectrum.size());
+    vaoEnvelope.resize(data->vaChannelEnvelope.size());
     for (ChannelID channel = 0; channel < vaoVoltage.size(); ++channel) {
         int dataSize;
 
@@ -35,7 +42,7 @@ void Graph::writeData(PPresult *data, QOpenGLShaderProgram *program, int vertexL
                 v.first = new QOpenGLVertexArrayObject;
                 if (!v.first->create()) throw new std::runtime_error("QOpenGLVertexArrayObject create failed");
             }
-            ChannelGraph &gVoltage = data->vaChannelVoltage[channel];
+            const ChannelGraph &gVoltage = dots ? noGraph : data->vaChannelVoltage[channel];
             v.first->bind();
             dataSize = int(gVoltage.size() * sizeof(QVector3D));
             buffer.write(offset, gVoltage.data(), dataSize);
@@ -53,7 +60,7 @@ void Graph::writeData(PPresult *data, QOpenGLShaderProgram *program, int vertexL
                 s.first = new QOpenGLVertexArrayObject;
                 if (!s.first->create()) throw new std::runtime_error("QOpenGLVertexArrayObject create failed");
             }
-            ChannelGraph &gSpectrum = data->vaChannelSpectrum[channel];
+            const ChannelGraph &gSpectrum = dots ? noGraph : data->vaChannelSpectrum[channel];
             s.first->bind();
             dataSize = int(gSpectrum.size() * sizeof(QVector3D));
             buffer.write(offset, gSpectrum.data(), dataSize);
@@ -63,9 +70,63 @@ void Graph::writeData(PPresult *data, QOpenGLShaderProgram *program, int vertexL
             s.second = (int)gSpectrum.size();
             offset += dataSize;
         }
+
+        // Envelope of the voltage channel
+        if (channel < vaoEnvelope.size()) {
+            VaoCount &e = vaoEnvelope[channel];
+            if (!e.first) {
+                e.first = new QOpenGLVertexArrayObject;
+                if (!e.first->create()) throw new std::runtime_error("QOpenGLVertexArrayObject create failed");
+            }
+            ChannelGraph &gEnvelope = data->vaChannelEnvelope[channel];
+            e.first->bind();
+            dataSize = int(gEnvelope.size() * sizeof(QVector3D));
+            buffer.write(offset, gEnvelope.data(), dataSize);
+            program->enableAttributeArray(vertexLocation);
+            program->setAttributeBuffer(vertexLocation, GL_FLOAT, offset, 3, 0);
+            e.first->release();
+            e.second = (int)gEnvelope.size();
+            offset += dataSize;
+        }
     }
 
     buffer.release();
+    if (!dots) dotCount = 0;
+}
+
+void Graph::writeDots(PPresult *data, QOpenGLShaderProgram *program, int vertexLocation, int colorIndexLocation) {
+    dots.clear();
+    const GLfloat spectrumColors = (GLfloat)data->vaChannelVoltage.size();
+    for (ChannelID channel = 0; channel < data->vaChannelVoltage.size(); ++channel)
+        for (const QVector3D &vertex : data->vaChannelVoltage[channel])
+            dots.push_back({vertex.x(), vertex.y(), vertex.z(), (GLfloat)channel});
+    for (ChannelID channel = 0; channel < data->vaChannelSpectrum.size(); ++channel)
+        for (const QVector3D &vertex : data->vaChannelSpectrum[channel])
+            dots.push_back({vertex.x(), vertex.y(), vertex.z(), spectrumColors + channel});
+
+    if (!dotBuffer.isCreated()) {
+        dotBuffer.create();
+        dotBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    }
+    if (!vaoDots.isCreated() && !vaoDots.create())
+        throw new std::runtime_error("QOpenGLVertexArrayObject create failed");
+
+    program->bind();
+    vaoDots.bind();
+    dotBuffer.bind();
+    const int neededMemory = int(dots.size() * sizeof(Dot));
+    if (neededMemory > allocatedDotMem) {
+        dotBuffer.allocate(neededMemory);
+        allocatedDotMem = neededMemory;
+    }
+    dotBuffer.write(0, dots.data(), neededMemory);
+    program->enableAttributeArray(vertexLocation);
+    program->setAttributeBuffer(vertexLocation, GL_FLOAT, 0, 3, sizeof(Dot));
+    program->enableAttributeArray(colorIndexLocation);
+    program->setAttributeBuffer(colorIndexLocation, GL_FLOAT, offsetof(Dot, colorIndex), 1, sizeof(Dot));
+    vaoDots.release();
+    dotBuffer.release();
+    dotCount = (GLsizei)dots.size();
 }
 
 Graph::~Graph() {
@@ -77,5 +138,11 @@ Graph::~Graph() {
         vao.first->destroy();
         delete vao.first;
     }
+    for (auto &vao : vaoEnvelope) {
+        vao.first->destroy();
+        delete vao.first;
+    }
+    if (vaoDots.isCreated()) vaoDots.destroy();
+    if (dotBuffer.isCreated()) dotBuffer.destroy();
     if (buffer.isCreated()) { buffer.destroy(); }
 }
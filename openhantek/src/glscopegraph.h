@@ -16,7 +16,13 @@ struct Graph {
     Graph(const Graph &) = delete;
     Graph(const Graph &&) = delete;
     ~Graph();
-    void writeData(PPresult *data, QOpenGLShaderProgram *program, int vertexLocation);
+    /// \brief Uploads the graphs of the post processing result.
+    /// \param dots true if the voltage and spectrum graphs are uploaded with writeDots() instead.
+    void writeData(PPresult *data, QOpenGLShaderProgram *program, int vertexLocation, bool dots = false);
+    /// \brief Uploads the voltage and spectrum graphs of all channels into one buffer of colored dots.
+    /// Every vertex carries the index of its color in the palette of the dot shader, so that all channels
+    /// are drawn with a single draw call.
+    void writeDots(PPresult *data, QOpenGLShaderProgram *program, int vertexLocation, int colorIndexLocation);
     typedef std::pair<QOpenGLVertexArrayObject *, GLsizei> VaoCount;
 
   public:
@@ -24,4 +30,16 @@ struct Graph {
     QOpenGLBuffer buffer;
     std::vector<VaoCount> vaoVoltage;
     std::vector<VaoCount> vaoSpectrum;
+    std::vector<VaoCount> vaoEnvelope;
+
+    /// \brief Vertex of the dot buffer.
+    struct Dot {
+        GLfloat x, y, z;
+        GLfloat colorIndex; ///< Voltage channels first, then the spectrum channels
+    };
+    int allocatedDotMem = 0;
+    QOpenGLBuffer dotBuffer;
+    QOpenGLVertexArrayObject vaoDots;
+    GLsizei dotCount = 0;
+    std::vector<Dot> dots; ///< Staging area of the dot buffer
 };
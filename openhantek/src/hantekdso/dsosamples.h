@@ -5,11 +5,13 @@
 #include <QReadLocker>
 #include <QReadWriteLock>
 #include <QWriteLocker>
+#include <cstdint>
 #include <vector>
 
 struct DSOsamples {
     std::vector<std::vector<double>> data; ///< Pointer to input data from device
     double samplerate = 0.0;               ///< The samplerate of the input data
     bool append = false;                   ///< true, if waiting data should be appended
+    int64_t timestamp = 0;                 ///< Host time of the first sample in ns, see hostTimestamp()
     mutable QReadWriteLock lock;
 };
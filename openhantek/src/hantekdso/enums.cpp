@@ -4,6 +4,9 @@
 namespace Dso {
     Enum<Dso::TriggerMode, Dso::TriggerMode::HARDWARE_SOFTWARE, Dso::TriggerMode::SINGLE> TriggerModeEnum;
     Enum<Dso::Slope, Dso::Slope::Positive, Dso::Slope::Negative> SlopeEnum;
+    Enum<Dso::TriggerType, Dso::TriggerType::Edge, Dso::TriggerType::Timeout> TriggerTypeEnum;
+    Enum<Dso::PulseCondition, Dso::PulseCondition::Shorter, Dso::PulseCondition::Inside> PulseConditionEnum;
+    Enum<Dso::WindowCondition, Dso::WindowCondition::Enter, Dso::WindowCondition::Exit> WindowConditionEnum;
     Enum<Dso::GraphFormat, Dso::GraphFormat::TY, Dso::GraphFormat::XY> GraphFormatEnum;
 
     /// \brief Return string representation of the given channel mode.
@@ -77,6 +80,53 @@ namespace Dso {
         }
     }
 
+    /// \brief Return string representation of the given software trigger type.
+    /// \param type The ::TriggerType that should be returned as string.
+    /// \return The string that should be used in labels etc.
+    QString triggerTypeString(TriggerType type) {
+        switch (type) {
+        case TriggerType::Edge:
+            return QCoreApplication::tr("Edge");
+        case TriggerType::PulseWidth:
+            return QCoreApplication::tr("Pulse width");
+        case TriggerType::Runt:
+            return QCoreApplication::tr("Runt");
+        case TriggerType::Window:
+            return QCoreApplication::tr("Window");
+        case TriggerType::Timeout:
+            return QCoreApplication::tr("Timeout");
+        }
+        return QString();
+    }
+
+    /// \brief Return string representation of the given pulse width condition.
+    /// \param condition The ::PulseCondition that should be returned as string.
+    /// \return The string that should be used in labels etc.
+    QString pulseConditionString(PulseCondition condition) {
+        switch (condition) {
+        case PulseCondition::Shorter:
+            return QCoreApplication::tr("Shorter");
+        case PulseCondition::Longer:
+            return QCoreApplication::tr("Longer");
+        case PulseCondition::Inside:
+            return QCoreApplication::tr("Inside range");
+        }
+        return QString();
+    }
+
+    /// \brief Return string representation of the given window trigger condition.
+    /// \param condition The ::WindowCondition that should be returned as string.
+    /// \return The string that should be used in labels etc.
+    QString windowConditionString(WindowCondition condition) {
+        switch (condition) {
+        case WindowCondition::Enter:
+            return QCoreApplication::tr("Enter");
+        case WindowCondition::Exit:
+            return QCoreApplication::tr("Exit");
+        }
+        return QString();
+    }
+
     /// \brief Return string representation of the given graph interpolation mode.
     /// \param interpolation The ::InterpolationMode that should be returned as
     /// string.
@@ -88,7 +138,7 @@ namespace Dso {
         case INTERPOLATION_LINEAR:
             return QCoreApplication::tr("Linear");
         case INTERPOLATION_SINC:
-            return QCoreApplication::tr("Sinc");
+            return QCoreApplication::tr("Sin(x)/x");
         default:
             return QString();
         }
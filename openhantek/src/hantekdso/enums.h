@@ -45,6 +45,34 @@ enum class Slope : uint8_t {
 };
 extern Enum<Dso::Slope, Dso::Slope::Positive, Dso::Slope::Negative> SlopeEnum;
 
+/// \enum TriggerType
+/// \brief The events the software trigger is looking for.
+enum class TriggerType {
+    Edge,       ///< The signal crosses the trigger level
+    PulseWidth, ///< A pulse beyond the trigger level ends and its width fulfills the pulse condition
+    Runt,       ///< A pulse passes the trigger level but returns without reaching the second level
+    Window,     ///< The signal enters or leaves the band between the trigger level and the second level
+    Timeout     ///< The signal stays beyond the trigger level for longer than the trigger time
+};
+extern Enum<Dso::TriggerType, Dso::TriggerType::Edge, Dso::TriggerType::Timeout> TriggerTypeEnum;
+
+/// \enum PulseCondition
+/// \brief The comparison of the pulse width with the trigger time(s).
+enum class PulseCondition {
+    Shorter, ///< Shorter than the trigger time
+    Longer,  ///< Longer than the trigger time
+    Inside   ///< Between the trigger time and the upper trigger time
+};
+extern Enum<Dso::PulseCondition, Dso::PulseCondition::Shorter, Dso::PulseCondition::Inside> PulseConditionEnum;
+
+/// \enum WindowCondition
+/// \brief The direction of the window trigger.
+enum class WindowCondition {
+    Enter, ///< The signal enters the window
+    Exit   ///< The signal leaves the window
+};
+extern Enum<Dso::WindowCondition, Dso::WindowCondition::Enter, Dso::WindowCondition::Exit> WindowConditionEnum;
+
 /// \enum InterpolationMode
 /// \brief The different interpolation modes for the graphs.
 enum InterpolationMode {
@@ -59,11 +87,15 @@ QString graphFormatString(GraphFormat format);
 QString couplingString(Coupling coupling);
 QString triggerModeString(TriggerMode mode);
 QString slopeString(Slope slope);
+QString triggerTypeString(TriggerType type);
+QString pulseConditionString(PulseCondition condition);
+QString windowConditionString(WindowCondition condition);
 QString interpolationModeString(InterpolationMode interpolation);
 }
 
 Q_DECLARE_METATYPE(Dso::TriggerMode)
 Q_DECLARE_METATYPE(Dso::Slope)
+Q_DECLARE_METATYPE(Dso::TriggerType)
 Q_DECLARE_METATYPE(Dso::Coupling)
 Q_DECLARE_METATYPE(Dso::GraphFormat)
 Q_DECLARE_METATYPE(Dso::ChannelMode)
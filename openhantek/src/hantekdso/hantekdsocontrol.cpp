@@ -17,6 +17,7 @@
 #include "hantekprotocol/controlStructs.h"
 #include "models/modelDSO6022.h"
 #include "usb/usbdevice.h"
+#include "utils/hostclock.h"
 
 using namespace Hantek;
 using namespace Dso;
@@ -215,11 +216,17 @@ std::vector<unsigned char> HantekDsoControl::getSamples(unsigned &previousSample
 }
 
 void HantekDsoControl::convertRawDataToSamples(const std::vector<unsigned char> &rawData) {
+    const int64_t received = hostTimestamp();
     const size_t totalSampleCount = (specification->sampleSize > 8) ? rawData.size() / 2 : rawData.size();
 
     QWriteLocker locker(&result.lock);
     result.samplerate = controlsettings.samplerate.current;
     result.append = isRollMode();
+    // The record ends about when it has been transferred, devices with hardware trigger may have finished it
+    // up to one polling cycle earlier
+    const size_t channelSampleCount = isFastRate() ? totalSampleCount : totalSampleCount / specification->channels;
+    result.timestamp = received;
+    if (result.samplerate > 0.0) result.timestamp -= int64_t(channelSampleCount / result.samplerate * 1e9);
     // Prepare result buffers
     result.data.resize(specification->channels);
     for (ChannelID channelCounter = 0; channelCounter < specification->channels; ++channelCounter)
@@ -1045,6 +1052,7 @@ Dso::ErrorCode HantekDsoControl::stringCommand(const QString &commandString) {
 
 void HantekDsoControl::addCommand(BulkCommand *newCommand, bool pending) {
     newCommand->pending = pending;
+    if (pending) setupBulkCommands.push_back(newCommand);
     command[(uint8_t)newCommand->code] = newCommand;
     newCommand->next = firstBulkCommand;
     firstBulkCommand = newCommand;
@@ -1054,6 +1062,7 @@ const BulkCommand *HantekDsoControl::getCommand(BulkCode code) const { return co
 
 void HantekDsoControl::addCommand(ControlCommand *newCommand, bool pending) {
     newCommand->pending = pending;
+    if (pending) setupControlCommands.push_back(newCommand);
     control[newCommand->code] = newCommand;
     newCommand->next = firstControlCommand;
     firstControlCommand = newCommand;
@@ -1061,9 +1070,34 @@ void HantekDsoControl::addCommand(ControlCommand *newCommand, bool pending) {
 
 const ControlCommand *HantekDsoControl::getCommand(ControlCode code) const { return control[(uint8_t)code]; }
 
+Dso::ErrorCode HantekDsoControl::resumeCommunication() {
+    // Connecting has reset the packet length
+    if (specification->fixedUSBinLength) device->overwriteInPacketLength(specification->fixedUSBinLength);
+
+    for (BulkCommand *setupCommand : setupBulkCommands) setupCommand->pending = true;
+    for (ControlCommand *setupCommand : setupControlCommands) setupCommand->pending = true;
+
+    // Start with a new capture
+    this->captureState = CAPTURE_WAITING;
+    this->rollState = RollState::STARTSAMPLING;
+    this->_samplingStarted = false;
+    this->lastTriggerMode = (Dso::TriggerMode)-1;
+    this->cycleCounter = 0;
+
+    Dso::ErrorCode errorCode = retrieveChannelLevelData();
+    if (errorCode != Dso::ErrorCode::NONE) return errorCode;
+
+    if (!running) run();
+    return Dso::ErrorCode::NONE;
+}
+
 void HantekDsoControl::run() {
     int errorCode = 0;
 
+    // Stop on errors and lost connections, resumeCommunication() starts again
+    running = false;
+    if (!device->isConnected()) return;
+
     // Send all pending bulk commands
     BulkCommand *command = firstBulkCommand;
     while (command) {
@@ -1301,6 +1335,7 @@ void HantekDsoControl::run() {
     }
 
     this->updateInterval();
+    running = true;
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 4, 0))
     QTimer::singleShot(cycleTime, this, &HantekDsoControl::run);
 #else
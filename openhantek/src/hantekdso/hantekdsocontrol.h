@@ -50,6 +50,12 @@ class HantekDsoControl : public QObject {
     /// there.
     void run();
 
+    /// \brief Continues after the device has been connected again, see USBDevice::reconnectDevice().
+    /// Sends the setup commands and the current settings to the device again and restarts the
+    /// processing, if it has been stopped by the lost connection.
+    /// \return See ::Dso::ErrorCode.
+    Dso::ErrorCode resumeCommunication();
+
     /// \brief Gets the physical channel count for this oscilloscope.
     /// \return The number of physical channels.
     unsigned getChannelCount() const;
@@ -178,6 +184,9 @@ class HantekDsoControl : public QObject {
     BulkCommand *firstBulkCommand = nullptr;
     ControlCommand *control[255] = {0};
     ControlCommand *firstControlCommand = nullptr;
+    /// The commands that are sent when the device is set up, sent again after a reconnection
+    std::vector<BulkCommand *> setupBulkCommands;
+    std::vector<ControlCommand *> setupControlCommands;
 
     // Communication with device
     USBDevice *device;     ///< The USB device for the oscilloscope
@@ -200,6 +209,7 @@ class HantekDsoControl : public QObject {
     int cycleCounter = 0;
     int startCycle = 0;
     int cycleTime = 0;
+    bool running = false; ///< true, if run() is scheduled to be called again
 
     /// \brief Send a bulk command to the oscilloscope.
     /// \param command The command, that should be sent.
@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include "frameserver.h"
+
+#include <QCoreApplication>
+#include <QFile>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "client/ohprotocol.h"
+#include "post/ppresult.h"
+#include "scopesettings.h"
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/// Number of frames in the ring
+#define FRAME_SERVER_SLOTS 8
+/// Bytes per slot (16 MB), only the pages that are written are actually used
+#define FRAME_SERVER_SLOT_SIZE (16 * 1024 * 1024)
+/// Offset of the first slot, behind the oh_ring_header
+#define FRAME_SERVER_SLOT_OFFSET 4096
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+inline uint64_t align8(uint64_t value) { return (value + 7) & ~(uint64_t)7; }
+
+#ifdef Q_OS_UNIX
+/// \brief Creates anonymous shared memory, nothing is left behind in the file system.
+/// \return The file descriptor or -1 with errno set.
+int createSharedMemory() {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    int fd = memfd_create("openhantek-ring", MFD_CLOEXEC);
+    // The kernel is older than the C library
+    if (fd >= 0 || errno != ENOSYS) return fd;
+#endif
+    // A named object that is removed again at once
+    static std::atomic<unsigned> counter(0);
+    const QByteArray name = "/openhantek-ring-" + QByteArray::number(getpid()) + '-' + QByteArray::number(++counter);
+    int fd = shm_open(name.constData(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd >= 0) shm_unlink(name.constData());
+    return fd;
+}
+#endif
+} // namespace
+
+FrameServer::FrameServer(const DsoSettingsScope *scope, QObject *parent) : QObject(parent), scope(scope) {}
+
+FrameServer::~FrameServer() {
+#ifdef Q_OS_UNIX
+    if (acceptThread.joinable()) {
+        // The thread returns when the pipe is closed
+        close(stopPipe[1]);
+        stopPipe[1] = -1;
+        acceptThread.join();
+    }
+    for (int client : clients) close(client);
+    for (int fd : stopPipe) {
+        if (fd >= 0) close(fd);
+    }
+    if (listenSocket >= 0) {
+        close(listenSocket);
+        unlink(socketPath.constData());
+    }
+    if (ring) munmap(ring, ringSize);
+    if (ringFile >= 0) close(ringFile);
+#endif
+}
+
+bool FrameServer::start(const QString &socketPath, QString &errorMessage) {
+#ifdef Q_OS_UNIX
+    this->socketPath = QFile::encodeName(socketPath);
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    if ((size_t)this->socketPath.size() >= sizeof(address.sun_path)) {
+        errorMessage = QCoreApplication::translate("FrameServer", "The socket path is too long");
+        return false;
+    }
+
+    // The clients get the descriptor of the ring
+    ringFile = createSharedMemory();
+    if (ringFile < 0) {
+        errorMessage = QCoreApplication::translate("FrameServer", "Can't create the shared memory: %1")
+                           .arg(QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+    ringSize = FRAME_SERVER_SLOT_OFFSET + (size_t)FRAME_SERVER_SLOTS * FRAME_SERVER_SLOT_SIZE;
+    void *memory = MAP_FAILED;
+    if (ftruncate(ringFile, (off_t)ringSize) == 0)
+        memory = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, ringFile, 0);
+    if (memory == MAP_FAILED) {
+        errorMessage = QCoreApplication::translate("FrameServer", "Can't create the shared memory: %1")
+                           .arg(QString::fromLocal8Bit(strerror(errno)));
+        ring = nullptr;
+        return false;
+    }
+    ring = static_cast<uint8_t *>(memory);
+    oh_ring_header *header = reinterpret_cast<oh_ring_header *>(ring);
+    header->magic = OH_PROTOCOL_MAGIC;
+    header->version = OH_PROTOCOL_VERSION;
+    header->slot_count = FRAME_SERVER_SLOTS;
+    header->slot_offset = FRAME_SERVER_SLOT_OFFSET;
+    header->slot_size = FRAME_SERVER_SLOT_SIZE;
+    header->latest = 0;
+
+    // Replace the socket of a previous session
+    struct stat status;
+    if (stat(this->socketPath.constData(), &status) == 0 && S_ISSOCK(status.st_mode))
+        unlink(this->socketPath.constData());
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, this->socketPath.constData());
+    listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSocket < 0 || bind(listenSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+        listen(listenSocket, 8) < 0 || pipe(stopPipe) < 0) {
+        errorMessage = QCoreApplication::translate("FrameServer", "Can't listen on %1: %2")
+                           .arg(socketPath, QString::fromLocal8Bit(strerror(errno)));
+        if (listenSocket >= 0) close(listenSocket);
+        listenSocket = -1;
+        return false;
+    }
+    fcntl(listenSocket, F_SETFD, FD_CLOEXEC);
+
+    acceptThread = std::thread(&FrameServer::run, this);
+    return true;
+#else
+    Q_UNUSED(socketPath);
+    errorMessage = QCoreApplication::translate("FrameServer", "The frame server is only available on Unix systems");
+    return false;
+#endif
+}
+
+void FrameServer::run() {
+#ifdef Q_OS_UNIX
+    std::vector<pollfd> descriptors;
+    for (;;) {
+        descriptors.clear();
+        descriptors.push_back({stopPipe[0], POLLIN, 0});
+        descriptors.push_back({listenSocket, POLLIN, 0});
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            for (int client : clients) descriptors.push_back({client, POLLIN, 0});
+        }
+        if (poll(descriptors.data(), descriptors.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (descriptors[0].revents) return;
+
+        // Clients don't send anything, readable means they are gone
+        for (size_t index = 2; index < descriptors.size(); ++index) {
+            if (!descriptors[index].revents) continue;
+            char buffer[64];
+            if (recv(descriptors[index].fd, buffer, sizeof(buffer), MSG_DONTWAIT) > 0) continue;
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            clients.erase(std::remove(clients.begin(), clients.end(), descriptors[index].fd), clients.end());
+            close(descriptors[index].fd);
+        }
+
+        if (descriptors[1].revents & POLLIN) {
+            const int client = accept(listenSocket, nullptr, nullptr);
+            if (client < 0) continue;
+            fcntl(client, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+            const int on = 1;
+            setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+            // Hello message with the ring as SCM_RIGHTS
+            oh_hello hello = {OH_PROTOCOL_MAGIC, OH_PROTOCOL_VERSION, ringSize};
+            iovec iov = {&hello, sizeof(hello)};
+            char control[CMSG_SPACE(sizeof(int))];
+            memset(control, 0, sizeof(control));
+            msghdr message;
+            memset(&message, 0, sizeof(message));
+            message.msg_iov = &iov;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(cmsg), &ringFile, sizeof(int));
+            if (sendmsg(client, &message, MSG_NOSIGNAL) != (ssize_t)sizeof(hello)) {
+                close(client);
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            clients.push_back(client);
+        }
+    }
+#endif
+}
+
+void FrameServer::writeFrame(const PPresult *data, uint8_t *slot, uint64_t number) {
+#ifdef Q_OS_UNIX
+    oh_frame_header *frame = reinterpret_cast<oh_frame_header *>(slot);
+    oh_channel_header *channelHeaders = reinterpret_cast<oh_channel_header *>(frame + 1);
+
+    // The published channels and their sample arrays
+    std::vector<ChannelID> channels;
+    unsigned arrays = 0;
+    for (ChannelID channel = 0; channel < data->channelCount() && channel < scope->voltage.size(); ++channel) {
+        if (!scope->voltage[channel].used && !scope->spectrum[channel].used) continue;
+        channels.push_back(channel);
+        arrays += scope->voltage[channel].used + scope->spectrum[channel].used;
+    }
+
+    // Frames that don't fit are cut, every array gets the same share of the slot
+    const uint64_t dataOffset = align8(sizeof(oh_frame_header) + channels.size() * sizeof(oh_channel_header));
+    uint64_t needed = dataOffset;
+    for (ChannelID channel : channels) {
+        const DataChannel *channelData = data->data(channel);
+        if (scope->voltage[channel].used) needed += align8(channelData->voltage.sample.size() * sizeof(float));
+        if (scope->spectrum[channel].used) needed += align8(channelData->spectrum.sample.size() * sizeof(float));
+    }
+    const bool truncated = needed > FRAME_SERVER_SLOT_SIZE;
+    const uint64_t share =
+        truncated && arrays ? ((FRAME_SERVER_SLOT_SIZE - dataOffset) / arrays / sizeof(float)) & ~(uint64_t)1 : 0;
+
+    __atomic_store_n(&frame->sequence, 2 * number - 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    frame->number = number;
+    frame->timestamp = data->timestamp;
+    frame->flags = (data->append ? OH_FRAME_ROLL : 0u) | (data->softwareTriggerTriggered ? OH_FRAME_TRIGGERED : 0u) |
+                   (truncated ? OH_FRAME_TRUNCATED : 0u);
+    frame->channel_count = (uint32_t)channels.size();
+
+    uint64_t offset = dataOffset;
+    auto copySamples = [&](const std::vector<double> &samples, uint64_t &sampleOffset, uint64_t &count) {
+        count = truncated ? std::min<uint64_t>(samples.size(), share) : samples.size();
+        sampleOffset = offset;
+        float *output = reinterpret_cast<float *>(slot + offset);
+        for (uint64_t index = 0; index < count; ++index) output[index] = (float)samples[index];
+        offset += align8(count * sizeof(float));
+    };
+    for (size_t index = 0; index < channels.size(); ++index) {
+        const ChannelID channel = channels[index];
+        const DataChannel *channelData = data->data(channel);
+        oh_channel_header &header = channelHeaders[index];
+        memset(&header, 0, sizeof(header));
+        const QByteArray name = scope->voltage[channel].name.toUtf8().left(sizeof(header.name) - 1);
+        memcpy(header.name, name.constData(), (size_t)name.size());
+        header.channel = channel;
+        header.frequency = channelData->frequency;
+        header.voltage_interval = channelData->voltage.interval;
+        header.spectrum_interval = channelData->spectrum.interval;
+        if (scope->voltage[channel].used) {
+            header.flags |= OH_CHANNEL_VOLTAGE;
+            copySamples(channelData->voltage.sample, header.voltage_offset, header.voltage_count);
+        }
+        if (scope->spectrum[channel].used) {
+            header.flags |= OH_CHANNEL_SPECTRUM;
+            copySamples(channelData->spectrum.sample, header.spectrum_offset, header.spectrum_count);
+        }
+    }
+
+    __atomic_store_n(&frame->sequence, 2 * number, __ATOMIC_RELEASE);
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(slot);
+    Q_UNUSED(number);
+#endif
+}
+
+void FrameServer::input(std::shared_ptr<PPresult> data) {
+#ifdef Q_OS_UNIX
+    if (!ring) return;
+    const uint64_t number = ++frameNumber;
+    writeFrame(data.get(), ring + FRAME_SERVER_SLOT_OFFSET + (number % FRAME_SERVER_SLOTS) * FRAME_SERVER_SLOT_SIZE,
+               number);
+    oh_ring_header *header = reinterpret_cast<oh_ring_header *>(ring);
+    __atomic_store_n(&header->latest, number, __ATOMIC_RELEASE);
+
+    // A full socket means the client is behind, it will find the newest frame anyway
+    const char wakeup = 0;
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    for (int client : clients) send(client, &wakeup, 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+#else
+    Q_UNUSED(data);
+#endif
+}
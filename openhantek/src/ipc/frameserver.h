@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class PPresult;
+struct DsoSettingsScope;
+
+/// \brief Publishes the processed frames to other programs on the same machine.
+/// The frames are copied into a ring of slots in shared memory, the clients read them in place. Every client
+/// that connects to the Unix domain socket gets the file descriptor of the ring and one byte per new frame.
+/// Writing the frame and the bytes never blocks: A slow client misses bytes and finds frames overwritten,
+/// it drops frames but doesn't slow down the acquisition. See client/ohprotocol.h for the layout and
+/// client/ohclient.h for the C client library. Only available on Unix systems.
+class FrameServer : public QObject {
+    Q_OBJECT
+  public:
+    explicit FrameServer(const DsoSettingsScope *scope, QObject *parent = nullptr);
+    ~FrameServer();
+
+    /// Creates the ring and starts accepting clients on the socket.
+    bool start(const QString &socketPath, QString &errorMessage);
+
+  public slots:
+    /// Copies the frame into the next slot and notifies the clients. Called in the post processing thread.
+    void input(std::shared_ptr<PPresult> data);
+
+  private:
+    /// Accepts clients and closes the disconnected ones, until the write end of stopPipe is closed.
+    void run();
+    void writeFrame(const PPresult *data, uint8_t *slot, uint64_t number);
+
+    const DsoSettingsScope *scope;
+    QByteArray socketPath;
+    int listenSocket = -1;
+    int stopPipe[2] = {-1, -1};
+    uint8_t *ring = nullptr;
+    size_t ringSize = 0;
+    int ringFile = -1;
+    uint64_t frameNumber = 0; ///< The last published frame
+
+    std::mutex clientsMutex;
+    std::vector<int> clients; ///< Sockets of the connected clients
+    std::thread acceptThread;
+};
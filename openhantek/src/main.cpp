@@ -8,35 +8,20 @@
 #include <QSurfaceFormat>
 #include <QTranslator>
 
+#include <algorithm>
 #include <iostream>
 #include <libusb-1.0/libusb.h>
 #include <memory>
+#include <vector>
 
-// Settings
-#include "settings.h"
-#include "viewconstants.h"
-
-// DSO core logic
-#include "dsomodel.h"
-#include "hantekdsocontrol.h"
+// Devices
+#include "devicesession.h"
+#include "devicewatcher.h"
 #include "usb/usbdevice.h"
-
-// Post processing
-#include "post/graphgenerator.h"
-#include "post/mathchannelgenerator.h"
-#include "post/postprocessing.h"
-#include "post/spectrumgenerator.h"
-
-// Exporter
-#include "exporting/exportcsv.h"
-#include "exporting/exporterprocessor.h"
-#include "exporting/exporterregistry.h"
-#include "exporting/exportimage.h"
-#include "exporting/exportprint.h"
+#include "utils/hostclock.h"
 
 // GUI
 #include "iconfont/QtAwesome.h"
-#include "mainwindow.h"
 #include "selectdevice/selectsupporteddevice.h"
 
 // OpenGL setup
@@ -48,38 +33,7 @@
 
 using namespace Hantek;
 
-/// \brief Initialize the device with the current settings.
-void applySettingsToDevice(HantekDsoControl *dsoControl, DsoSettingsScope *scope,
-                           const Dso::ControlSpecification *spec) {
-    bool mathUsed = scope->anyUsed(spec->channels);
-    for (ChannelID channel = 0; channel < spec->channels; ++channel) {
-        dsoControl->setCoupling(channel, scope->coupling(channel, spec));
-        dsoControl->setGain(channel, scope->gain(channel) * DIVS_VOLTAGE);
-        dsoControl->setOffset(channel, (scope->voltage[channel].offset / DIVS_VOLTAGE) + 0.5);
-        dsoControl->setTriggerLevel(channel, scope->voltage[channel].trigger);
-        dsoControl->setChannelUsed(channel, mathUsed | scope->anyUsed(channel));
-    }
-
-    if (scope->horizontal.samplerateSource == DsoSettingsScopeHorizontal::Samplerrate)
-        dsoControl->setSamplerate(scope->horizontal.samplerate);
-    else
-        dsoControl->setRecordTime(scope->horizontal.timebase * DIVS_TIME);
-
-    if (dsoControl->getAvailableRecordLengths().empty())
-        dsoControl->setRecordLength(scope->horizontal.recordLength);
-    else {
-        auto recLenVec = dsoControl->getAvailableRecordLengths();
-        ptrdiff_t index = std::distance(recLenVec.begin(),
-                                        std::find(recLenVec.begin(), recLenVec.end(), scope->horizontal.recordLength));
-        dsoControl->setRecordLength(index < 0 ? 1 : (unsigned)index);
-    }
-    dsoControl->setTriggerMode(scope->trigger.mode);
-    dsoControl->setPretriggerPosition(scope->trigger.position * scope->horizontal.timebase * DIVS_TIME);
-    dsoControl->setTriggerSlope(scope->trigger.slope);
-    dsoControl->setTriggerSource(scope->trigger.special, scope->trigger.source);
-}
-
-/// \brief Initialize resources and translations and show the main window.
+/// \brief Initialize resources and translations and show a main window for every selected device.
 int main(int argc, char *argv[]) {
     //////// Set application information ////////
     QCoreApplication::setOrganizationName("OpenHantek");
@@ -92,6 +46,8 @@ int main(int argc, char *argv[]) {
 #endif
 
     bool useGles = false;
+    QString serverSocket;
+    QString scpiAddress;
     {
         QCoreApplication parserApp(argc, argv);
         QCommandLineParser p;
@@ -99,8 +55,17 @@ int main(int argc, char *argv[]) {
         p.addVersionOption();
         QCommandLineOption useGlesOption("useGLES", QCoreApplication::tr("Use OpenGL ES instead of OpenGL"));
         p.addOption(useGlesOption);
+        QCommandLineOption serverOption(
+            "server", QCoreApplication::tr("Publish the processed frames to other programs on <socket>"), "socket");
+        p.addOption(serverOption);
+        QCommandLineOption scpiOption(
+            "scpi", QCoreApplication::tr("Accept SCPI commands on a TCP <port> of localhost or a local socket"),
+            "port|socket");
+        p.addOption(scpiOption);
         p.process(parserApp);
         useGles = p.isSet(useGlesOption);
+        serverSocket = p.value(serverOption);
+        scpiAddress = p.value(scpiOption);
     }
 
     GlScope::fixOpenGLversion(useGles ? QSurfaceFormat::OpenGLES : QSurfaceFormat::OpenGL);
@@ -125,90 +90,59 @@ int main(int argc, char *argv[]) {
         SelectSupportedDevice().showLibUSBFailedDialogModel(error);
         return -1;
     }
-    std::unique_ptr<USBDevice> device = SelectSupportedDevice().showSelectDeviceModal(context);
+    std::vector<std::unique_ptr<USBDevice>> devices = SelectSupportedDevice().showSelectDevicesModal(context);
 
     QString errorMessage;
-    if (device == nullptr || !device->connectDevice(errorMessage)) {
+    bool connected = !devices.empty();
+    for (const std::unique_ptr<USBDevice> &device : devices)
+        connected = connected && device->connectDevice(errorMessage);
+    if (!connected) {
+        devices.clear();
         libusb_exit(context);
         return -1;
     }
 
-    //////// Create DSO control object and move it to a separate thread ////////
-    QThread dsoControlThread;
-    dsoControlThread.setObjectName("dsoControlThread");
-    HantekDsoControl dsoControl(device.get());
-    dsoControl.moveToThread(&dsoControlThread);
-    QObject::connect(&dsoControlThread, &QThread::started, &dsoControl, &HantekDsoControl::run);
-    QObject::connect(&dsoControl, &HantekDsoControl::communicationError, QCoreApplication::instance(),
-                     &QCoreApplication::quit);
-    QObject::connect(device.get(), &USBDevice::deviceDisconnected, QCoreApplication::instance(),
-                     &QCoreApplication::quit);
-
-    //////// Create settings object ////////
-    DsoSettings settings(device->getModel()->spec());
-
-    //////// Create exporters ////////
-    ExporterRegistry exportRegistry(device->getModel()->spec(), &settings);
-
-    ExporterCSV exporterCSV;
-    ExporterImage exportImage;
-    ExporterPrint exportPrint;
-
-    ExporterProcessor samplesToExportRaw(&exportRegistry);
-
-    exportRegistry.registerExporter(&exporterCSV);
-    exportRegistry.registerExporter(&exportImage);
-    exportRegistry.registerExporter(&exportPrint);
-
-    //////// Create post processing objects ////////
-    QThread postProcessingThread;
-    postProcessingThread.setObjectName("postProcessingThread");
-    PostProcessing postProcessing(settings.scope.countChannels());
-
-    SpectrumGenerator spectrumGenerator(&settings.scope, &settings.post);
-    MathChannelGenerator mathchannelGenerator(&settings.scope, device->getModel()->spec()->channels);
-    GraphGenerator graphGenerator(&settings.scope, device->getModel()->spec()->isSoftwareTriggerDevice);
-
-    postProcessing.registerProcessor(&samplesToExportRaw);
-    postProcessing.registerProcessor(&mathchannelGenerator);
-    postProcessing.registerProcessor(&spectrumGenerator);
-    postProcessing.registerProcessor(&graphGenerator);
-
-    postProcessing.moveToThread(&postProcessingThread);
-    QObject::connect(&dsoControl, &HantekDsoControl::samplesAvailable, &postProcessing, &PostProcessing::input);
-    QObject::connect(&postProcessing, &PostProcessing::processingFinished, &exportRegistry, &ExporterRegistry::input,
-                     Qt::DirectConnection);
-
-    //////// Create main window ////////
+    // Start the clock of the frame time stamps
+    hostTimestamp();
+
+    //////// Create post processing threads, shared by the devices ////////
+    const size_t threadCount = std::max<size_t>(1, std::min<size_t>(devices.size(), QThread::idealThreadCount()));
+    std::vector<std::unique_ptr<QThread>> postProcessingThreads;
+    for (size_t index = 0; index < threadCount; ++index) {
+        postProcessingThreads.emplace_back(new QThread);
+        postProcessingThreads.back()->setObjectName(index ? QString("postProcessingThread-%1").arg(index + 1)
+                                                          : QString("postProcessingThread"));
+    }
+
+    //////// Create a session with control thread, post processing and main window for every device ////////
     iconFont->initFontAwesome();
-    MainWindow openHantekMainWindow(&dsoControl, &settings, &exportRegistry);
-    QObject::connect(&postProcessing, &PostProcessing::processingFinished, &openHantekMainWindow,
-                     &MainWindow::showNewData);
-    QObject::connect(&exportRegistry, &ExporterRegistry::exporterProgressChanged, &openHantekMainWindow,
-                     &MainWindow::exporterProgressChanged);
-    QObject::connect(&exportRegistry, &ExporterRegistry::exporterStatusChanged, &openHantekMainWindow,
-                     &MainWindow::exporterStatusChanged);
-    openHantekMainWindow.show();
-
-    applySettingsToDevice(&dsoControl, &settings.scope, device->getModel()->spec());
-
-    //////// Start DSO thread and go into GUI main loop
-    dsoControl.enableSampling(true);
-    postProcessingThread.start();
-    dsoControlThread.start();
+    std::vector<std::unique_ptr<DeviceSession>> sessions;
+    for (unsigned index = 0; index < devices.size(); ++index) {
+        sessions.emplace_back(new DeviceSession(std::move(devices[index]), index,
+                                                postProcessingThreads[index % threadCount].get(), serverSocket,
+                                                scpiAddress));
+    }
+
+    // Reconnect devices that are unplugged and plugged in again
+    std::unique_ptr<DeviceWatcher> deviceWatcher(new DeviceWatcher(context, sessions));
+
+    //////// Start DSO threads and go into GUI main loop
+    for (const std::unique_ptr<QThread> &thread : postProcessingThreads) thread->start();
+    for (const std::unique_ptr<DeviceSession> &session : sessions) session->start();
     int res = openHantekApplication.exec();
 
     //////// Clean up ////////
-    dsoControlThread.quit();
-    dsoControlThread.wait(10000);
+    deviceWatcher.reset();
+    for (const std::unique_ptr<DeviceSession> &session : sessions) session->stop();
 
-    postProcessingThread.quit();
-    postProcessingThread.wait(10000);
-
-    if (context && device != nullptr) { 
-        device.reset(); // causes libusb_close(), which must be called before libusb_exit() 
-        libusb_exit(context); 
+    for (const std::unique_ptr<QThread> &thread : postProcessingThreads) {
+        thread->quit();
+        thread->wait(10000);
     }
 
+    // Closes the devices, libusb_close() must be called before libusb_exit()
+    sessions.clear();
+    libusb_exit(context);
+
     return res;
 }
@@ -15,6 +15,7 @@
 #include "exporting/exporterinterface.h"
 #include "exporting/exporterregistry.h"
 #include "hantekdsocontrol.h"
+#include "remote/scpiserver.h"
 #include "usb/usbdevice.h"
 #include "viewconstants.h"
 
@@ -23,6 +24,8 @@
 #include <QFileDialog>
 #include <QLineEdit>
 #include <QMessageBox>
+#include <QProgressBar>
+#include <QToolButton>
 
 MainWindow::MainWindow(HantekDsoControl *dsoControl, DsoSettings *settings, ExporterRegistry *exporterRegistry,
                        QWidget *parent)
@@ -52,6 +55,18 @@ MainWindow::MainWindow(HantekDsoControl *dsoControl, DsoSettings *settings, Expo
     setDockOptions(dockOptions() | QMainWindow::GroupedDragging);
 #endif
 
+    exportProgressBar = new QProgressBar(this);
+    exportProgressBar->setRange(0, 100);
+    exportProgressBar->setMaximumWidth(150);
+    exportProgressBar->hide();
+    exportCancelButton = new QToolButton(this);
+    exportCancelButton->setIcon(iconFont->icon(fa::times));
+    exportCancelButton->setToolTip(tr("Cancel export"));
+    exportCancelButton->hide();
+    connect(exportCancelButton, &QToolButton::clicked, exporterRegistry, &ExporterRegistry::cancelExports);
+    ui->statusbar->addPermanentWidget(exportProgressBar);
+    ui->statusbar->addPermanentWidget(exportCancelButton);
+
     for (auto *exporter : *exporterRegistry) {
         QAction *action = new QAction(exporter->icon(), exporter->name(), this);
         action->setCheckable(exporter->type() == ExporterInterface::Type::ContinousExport);
@@ -69,10 +84,6 @@ MainWindow::MainWindow(HantekDsoControl *dsoControl, DsoSettings *settings, Expo
 
     // Docking windows
     // Create dock windows before the dso widget, they fix messed up settings
-    HorizontalDock *horizontalDock;
-    TriggerDock *triggerDock;
-    SpectrumDock *spectrumDock;
-    VoltageDock *voltageDock;
     horizontalDock = new HorizontalDock(scope, this);
     triggerDock = new TriggerDock(scope, spec, this);
     spectrumDock = new SpectrumDock(scope, this);
@@ -125,7 +136,7 @@ MainWindow::MainWindow(HantekDsoControl *dsoControl, DsoSettings *settings, Expo
             [dsoControl](unsigned long recordLength) { dsoControl->setRecordLength(recordLength); });
 
     connect(dsoControl, &HantekDsoControl::recordTimeChanged,
-            [this, settings, horizontalDock, dsoControl](double duration) {
+            [this, settings, dsoControl](double duration) {
                 if (settings->scope.horizontal.samplerateSource == DsoSettingsScopeHorizontal::Samplerrate &&
                     settings->scope.horizontal.recordLength != UINT_MAX) {
                     // The samplerate was set, let's adapt the timebase accordingly
@@ -139,7 +150,7 @@ MainWindow::MainWindow(HantekDsoControl *dsoControl, DsoSettings *settings, Expo
 
                 this->dsoWidget->updateTimebase(settings->scope.horizontal.timebase);
             });
-    connect(dsoControl, &HantekDsoControl::samplerateChanged, [this, horizontalDock](double samplerate) {
+    connect(dsoControl, &HantekDsoControl::samplerateChanged, [this](double samplerate) {
         if (mSettings->scope.horizontal.samplerateSource == DsoSettingsScopeHorizontal::Duration &&
             mSettings->scope.horizontal.recordLength != UINT_MAX) {
             // The timebase was set, let's adapt the samplerate accordingly
@@ -305,13 +316,74 @@ MainWindow::MainWindow(HantekDsoControl *dsoControl, DsoSettings *settings, Expo
 
 MainWindow::~MainWindow() { delete ui; }
 
+void MainWindow::connectRemoteControl(ScpiServer *scpiServer) {
+    // The server has changed the device already, the settings and the widgets have to follow
+    DsoSettingsScope *scope = &mSettings->scope;
+    connect(scpiServer, &ScpiServer::usedChanged, this, [this, scope](ChannelID channel, bool used) {
+        scope->voltage[channel].used = used;
+        voltageDock->setUsed(channel, used);
+        dsoWidget->updateVoltageUsed(channel, used);
+    });
+    connect(scpiServer, &ScpiServer::gainChanged, this, [this, scope](ChannelID channel, unsigned gainStepIndex) {
+        scope->voltage[channel].gainStepIndex = gainStepIndex;
+        voltageDock->setGain(channel, gainStepIndex);
+        dsoWidget->updateVoltageGain(channel);
+    });
+    // Stores the offset as well
+    connect(scpiServer, &ScpiServer::offsetChanged, dsoWidget, &DsoWidget::setOffset);
+    connect(scpiServer, &ScpiServer::triggerLevelChanged, this, [this, scope](ChannelID channel, double level) {
+        scope->voltage[channel].trigger = level;
+        dsoWidget->setTriggerLevel(channel, level);
+    });
+    connect(scpiServer, &ScpiServer::couplingChanged, this,
+            [this, scope](ChannelID channel, unsigned couplingOrMathIndex) {
+                scope->voltage[channel].couplingOrMathIndex = couplingOrMathIndex;
+                voltageDock->setCoupling(channel, couplingOrMathIndex);
+                dsoWidget->updateVoltageCoupling(channel);
+            });
+    connect(scpiServer, &ScpiServer::triggerChanged, this, [this, scope](const DsoSettingsScopeTrigger &trigger) {
+        // The software trigger isn't controlled remotely
+        scope->trigger.mode = trigger.mode;
+        scope->trigger.source = trigger.source;
+        scope->trigger.special = trigger.special;
+        scope->trigger.slope = trigger.slope;
+        triggerDock->setMode(trigger.mode);
+        triggerDock->setSource(trigger.special, trigger.source);
+        triggerDock->setSlope(trigger.slope);
+        dsoWidget->updateTriggerMode();
+        dsoWidget->updateTriggerSource();
+        dsoWidget->updateTriggerSlope();
+        dsoWidget->setTriggerPosition(trigger.position);
+    });
+    connect(scpiServer, &ScpiServer::horizontalChanged, this,
+            [this, scope](const DsoSettingsScopeHorizontal &horizontal) {
+                scope->horizontal.samplerateSource = horizontal.samplerateSource;
+                scope->horizontal.samplerate = horizontal.samplerate;
+                scope->horizontal.timebase = horizontal.timebase;
+                if (horizontal.samplerateSource == DsoSettingsScopeHorizontal::Samplerrate) {
+                    horizontalDock->setSamplerate(horizontal.samplerate);
+                    dsoWidget->updateSamplerate(horizontal.samplerate);
+                } else {
+                    horizontalDock->setTimebase(horizontal.timebase);
+                    dsoWidget->updateTimebase(horizontal.timebase);
+                }
+            });
+}
+
 void MainWindow::showNewData(std::shared_ptr<PPresult> data) { dsoWidget->showNew(data); }
 
 void MainWindow::exporterStatusChanged(const QString &exporterName, const QString &status) {
     ui->statusbar->showMessage(tr("%1: %2").arg(exporterName).arg(status));
 }
 
-void MainWindow::exporterProgressChanged() { exporterRegistry->checkForWaitingExporters(); }
+void MainWindow::exporterProgressChanged() {
+    exporterRegistry->checkForWaitingExporters();
+
+    const bool running = exporterRegistry->runningExports() > 0;
+    exportProgressBar->setVisible(running);
+    exportCancelButton->setVisible(running);
+    if (running) exportProgressBar->setValue((int)(exporterRegistry->exportProgress() * 100));
+}
 
 /// \brief Save the settings before exiting.
 /// \param event The close event that should be handled.
@@ -7,11 +7,14 @@ class SpectrumGenerator;
 class HantekDsoControl;
 class DsoSettings;
 class ExporterRegistry;
+class ScpiServer;
 class DsoWidget;
 class HorizontalDock;
 class TriggerDock;
 class SpectrumDock;
 class VoltageDock;
+class QProgressBar;
+class QToolButton;
 
 namespace Ui {
 class MainWindow;
@@ -27,6 +30,8 @@ class MainWindow : public QMainWindow {
     explicit MainWindow(HantekDsoControl *dsoControl, DsoSettings *mSettings, ExporterRegistry *exporterRegistry,
                         QWidget *parent = 0);
     ~MainWindow();
+    /// Shows the settings that are changed by remote commands.
+    void connectRemoteControl(ScpiServer *scpiServer);
   public slots:
     void showNewData(std::shared_ptr<PPresult> data);
     void exporterStatusChanged(const QString &exporterName, const QString &status);
@@ -41,7 +46,17 @@ class MainWindow : public QMainWindow {
     // Central widgets
     DsoWidget *dsoWidget;
 
+    // Docking windows
+    HorizontalDock *horizontalDock;
+    TriggerDock *triggerDock;
+    SpectrumDock *spectrumDock;
+    VoltageDock *voltageDock;
+
     // Settings used for the whole program
     DsoSettings *mSettings;
     ExporterRegistry *exporterRegistry;
+
+    // Progress of the running exports in the status bar
+    QProgressBar *exportProgressBar;
+    QToolButton *exportCancelButton;
 };
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include "envelopegenerator.h"
+#include "postprocessingsettings.h"
+#include "ppresult.h"
+#include "scopesettings.h"
+
+/// \brief Folds the extrema of a frame or a block of frames into the given extrema arrays.
+/// Written as a branch-free loop over plain arrays, so that the compiler is able to vectorize it.
+static void foldExtrema(double *minimum, double *maximum, const double *lowest, const double *highest,
+                        size_t count) {
+    for (size_t position = 0; position < count; ++position) {
+        minimum[position] = lowest[position] < minimum[position] ? lowest[position] : minimum[position];
+        maximum[position] = highest[position] > maximum[position] ? highest[position] : maximum[position];
+    }
+}
+
+/// \brief Writes the combined extrema of two frames or blocks of frames into the given extrema arrays.
+static void mergeExtrema(double *minimum, double *maximum, const double *lowest1, const double *highest1,
+                         const double *lowest2, const double *highest2, size_t count) {
+    for (size_t position = 0; position < count; ++position) {
+        minimum[position] = lowest1[position] < lowest2[position] ? lowest1[position] : lowest2[position];
+        maximum[position] = highest1[position] > highest2[position] ? highest1[position] : highest2[position];
+    }
+}
+
+EnvelopeGenerator::EnvelopeGenerator(const DsoSettingsScope *scope, const DsoSettingsPostProcessing *postprocessing,
+                                     bool isSoftwareTriggerDevice)
+    : scope(scope), postprocessing(postprocessing), isSoftwareTriggerDevice(isSoftwareTriggerDevice) {}
+
+void EnvelopeGenerator::ChannelEnvelope::reset() {
+    historyMin.clear();
+    historyMax.clear();
+    prefixMin.clear();
+    prefixMax.clear();
+    historyIndex = 0;
+    frames = 0;
+    count = 0;
+    interval = 0.0;
+}
+
+void EnvelopeGenerator::accumulate(ChannelEnvelope &envelope, const double *samples, size_t count,
+                                   unsigned maxFrames) {
+    envelope.count = count;
+    if (maxFrames == 0) {
+        // Unbounded: Fold the new frame into the running extrema
+        if (envelope.frames == 0) {
+            envelope.prefixMin.assign(samples, samples + count);
+            envelope.prefixMax.assign(samples, samples + count);
+        } else
+            foldExtrema(envelope.prefixMin.data(), envelope.prefixMax.data(), samples, samples, count);
+        ++envelope.frames;
+        return;
+    }
+
+    // Windowed: The frames are split into blocks of maxFrames frames, one block fills the ring buffer. The window
+    // of the last maxFrames frames starts in the previous block and ends in the current one, its extrema are the
+    // extrema of the current block so far and the extrema from the window start to the end of the previous block.
+    const unsigned slot = envelope.historyIndex;
+    if (slot == envelope.historyMin.size()) {
+        envelope.historyMin.emplace_back(samples, samples + count);
+        envelope.historyMax.emplace_back(samples, samples + count);
+    } else {
+        envelope.historyMin[slot].assign(samples, samples + count);
+        envelope.historyMax[slot].assign(samples, samples + count);
+    }
+    if (slot == 0) {
+        envelope.prefixMin.assign(samples, samples + count);
+        envelope.prefixMax.assign(samples, samples + count);
+    } else
+        foldExtrema(envelope.prefixMin.data(), envelope.prefixMax.data(), samples, samples, count);
+    envelope.historyIndex = (slot + 1) % maxFrames;
+    if (envelope.frames < maxFrames) ++envelope.frames;
+
+    if (slot + 1 == maxFrames) {
+        // The block is complete, turn its frames into the extrema up to its end for the next block
+        for (unsigned index = slot; index-- > 0;)
+            foldExtrema(envelope.historyMin[index].data(), envelope.historyMax[index].data(),
+                        envelope.historyMin[index + 1].data(), envelope.historyMax[index + 1].data(), count);
+    }
+}
+
+void EnvelopeGenerator::publish(const ChannelEnvelope &envelope, unsigned maxFrames, DataChannel *channelData) {
+    std::vector<double> &minimum = channelData->envelopeMin.sample;
+    std::vector<double> &maximum = channelData->envelopeMax.sample;
+    channelData->envelopeMin.interval = envelope.interval;
+    channelData->envelopeMax.interval = envelope.interval;
+
+    // The rest of the window is in the previous block, unless the current block has just been completed
+    const unsigned slot = envelope.historyIndex;
+    if (maxFrames && envelope.frames == maxFrames && slot != 0) {
+        minimum.resize(envelope.count);
+        maximum.resize(envelope.count);
+        mergeExtrema(minimum.data(), maximum.data(), envelope.prefixMin.data(), envelope.prefixMax.data(),
+                     envelope.historyMin[slot].data(), envelope.historyMax[slot].data(), envelope.count);
+    } else {
+        minimum = envelope.prefixMin;
+        maximum = envelope.prefixMax;
+    }
+}
+
+void EnvelopeGenerator::process(PPresult *result) {
+    if (!postprocessing->envelope) {
+        envelopes.clear();
+        return;
+    }
+
+    if (envelopes.size() != result->channelCount() || lastFrameSetting != postprocessing->envelopeFrames) {
+        envelopes.clear();
+        envelopes.resize(result->channelCount());
+        lastFrameSetting = postprocessing->envelopeFrames;
+    }
+
+    // Frames of software trigger devices are only comparable if they are aligned to the trigger point.
+    // Frames without a trigger event do not contribute to the envelope.
+    const unsigned preTrigSamples = result->preTrigSamples;
+    const unsigned postTrigSamples = result->postTrigSamples;
+    const unsigned swTriggerStart = result->swTriggerStart;
+    const bool aligned = !isSoftwareTriggerDevice || postTrigSamples > preTrigSamples;
+
+    for (ChannelID channel = 0; channel < result->channelCount(); ++channel) {
+        DataChannel *const channelData = result->modifyData(channel);
+        ChannelEnvelope &envelope = envelopes[channel];
+        const std::vector<double> &samples = channelData->voltage.sample;
+
+        if (!scope->voltage[channel].used || samples.empty()) {
+            envelope.reset();
+            continue;
+        }
+
+        if (aligned) {
+            size_t offset = 0;
+            size_t count = samples.size();
+            if (isSoftwareTriggerDevice) {
+                offset = swTriggerStart - preTrigSamples;
+                count = samples.size() - (postTrigSamples - preTrigSamples);
+            }
+
+            if (offset + count <= samples.size()) {
+                // Restart the envelope if the timebase or the record length has changed
+                if (envelope.interval != channelData->voltage.interval || envelope.count != count)
+                    envelope.reset();
+                envelope.interval = channelData->voltage.interval;
+                accumulate(envelope, samples.data() + offset, count, postprocessing->envelopeFrames);
+            }
+        }
+
+        if (envelope.frames) publish(envelope, postprocessing->envelopeFrames, channelData);
+    }
+}
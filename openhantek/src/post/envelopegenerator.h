@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <vector>
+
+#include "hantekprotocol/types.h"
+#include "processor.h"
+
+struct DsoSettingsScope;
+struct DsoSettingsPostProcessing;
+
+/// \brief Accumulates a min/max envelope (peak detect) of the voltage graphs.
+/// For every sample position the lowest and highest voltage seen during the last
+/// `envelopeFrames` frames (or since the last reset, if that is 0) is kept and
+/// published in DataChannel::envelopeMin/envelopeMax. The windowed extrema are computed like the van Herk/Gil-Werman
+/// filter, so every frame costs the same, whatever the number of frames in the window.
+class EnvelopeGenerator : public Processor {
+  public:
+    EnvelopeGenerator(const DsoSettingsScope *scope, const DsoSettingsPostProcessing *postprocessing,
+                      bool isSoftwareTriggerDevice);
+    virtual void process(PPresult *result) override;
+
+  private:
+    struct ChannelEnvelope {
+        /// Ring buffer of the last frames (windowed mode only). The slots of the current block hold the frames,
+        /// the slots of the previous block the extrema from the slot to the end of that block.
+        std::vector<std::vector<double>> historyMin, historyMax;
+        /// Extrema of the frames of the current block, of all frames in the unlimited mode
+        std::vector<double> prefixMin, prefixMax;
+        unsigned historyIndex = 0; ///< Next slot to be overwritten in history
+        unsigned frames = 0;       ///< Number of accumulated frames
+        size_t count = 0;          ///< Number of samples per frame
+        double interval = 0.0;     ///< Sample interval of the accumulated frames
+        void reset();
+    };
+
+    void accumulate(ChannelEnvelope &envelope, const double *samples, size_t count, unsigned maxFrames);
+    /// Writes the extrema of the accumulated frames into the buffers of the result.
+    void publish(const ChannelEnvelope &envelope, unsigned maxFrames, DataChannel *channelData);
+
+    const DsoSettingsScope *scope;
+    const DsoSettingsPostProcessing *postprocessing;
+    const bool isSoftwareTriggerDevice;
+    std::vector<ChannelEnvelope> envelopes;
+    unsigned lastFrameSetting = 0;
+};
@@ -0,0 +1,8 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include "fftwplanner.h"
+
+QMutex &fftwPlannerMutex() {
+    static QMutex mutex;
+    return mutex;
+}
@@ -0,0 +1,11 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <QMutex>
+
+/// \brief Guards the FFTW planner, which is not thread-safe.
+/// Plans are created and destroyed by the processors of every device, in several post processing threads.
+/// fftw(f)_plan_with_nthreads() sets global state for the next plan, so it is called under the lock as well.
+/// Executing a plan doesn't need the lock.
+QMutex &fftwPlannerMutex();
@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+#include "filterprocessor.h"
+#include "fftwplanner.h"
+
+#include "scopesettings.h"
+
+/// FIR filters up to this length are convolved directly, longer ones with FFT blocks.
+static const unsigned DIRECT_MAX_TAPS = 64;
+/// Highest supported order of the IIR filters.
+static const unsigned MAX_ORDER = 16;
+/// Highest supported number of FIR taps.
+static const unsigned MAX_TAPS = 16383;
+/// Number of samples that pass all sections of an IIR filter before the next block is read.
+static const size_t IIR_BLOCK = 4096;
+
+typedef std::complex<double> Complex;
+
+FilterProcessor::FilterProcessor(const DsoSettingsScope *scope, const DsoSettingsPostProcessing *postprocessing,
+                                 WindowCache *windowCache)
+    : scope(scope), postprocessing(postprocessing), windowCache(windowCache) {
+    channelFilters.resize(scope->voltage.size());
+}
+
+FilterProcessor::~FilterProcessor() {
+    for (ChannelFilter &filter : channelFilters) destroyPlan(filter);
+}
+
+void FilterProcessor::destroyPlan(ChannelFilter &filter) {
+    QMutexLocker plannerLock(&fftwPlannerMutex());
+    if (filter.forward) fftw_destroy_plan(filter.forward);
+    if (filter.backward) fftw_destroy_plan(filter.backward);
+    if (filter.fftReal) fftw_free(filter.fftReal);
+    if (filter.fftComplex) fftw_free(filter.fftComplex);
+    if (filter.response) fftw_free(filter.response);
+    filter.forward = nullptr;
+    filter.backward = nullptr;
+    filter.fftReal = nullptr;
+    filter.fftComplex = nullptr;
+    filter.response = nullptr;
+    filter.fftLength = 0;
+}
+
+void FilterProcessor::design(ChannelFilter &filter, const DsoSettingsFilter &settings, double interval) {
+    destroyPlan(filter);
+    filter.settings = settings;
+    filter.interval = interval;
+    filter.active = false;
+    filter.primed = false;
+    filter.sections.clear();
+    filter.taps.clear();
+    filter.history.clear();
+
+    // Edge frequencies in cycles per sample
+    double low, high;
+    switch (settings.type) {
+    case Dso::FilterType::OFF:
+        return;
+    case Dso::FilterType::LOWPASS:
+    case Dso::FilterType::HIGHPASS:
+        low = high = settings.frequency * interval;
+        break;
+    case Dso::FilterType::BANDPASS:
+    case Dso::FilterType::NOTCH:
+        low = (settings.frequency - settings.bandwidth / 2) * interval;
+        high = (settings.frequency + settings.bandwidth / 2) * interval;
+        if (high <= low) return;
+        break;
+    }
+    // The band has to lie between DC and the Nyquist frequency, otherwise the samples pass unchanged
+    if (low <= 0.0 || high >= 0.5) return;
+
+    if (settings.design == Dso::FilterDesign::IIR)
+        designIir(filter, low, high);
+    else
+        designFir(filter, low, high);
+    filter.active = true;
+}
+
+void FilterProcessor::designIir(ChannelFilter &filter, double low, double high) {
+    const Dso::FilterType type = filter.settings.type;
+    const unsigned order = std::max(1u, std::min(filter.settings.order, MAX_ORDER));
+
+    // Prewarped analog frequencies of the bilinear transform s = 2 (z - 1) / (z + 1)
+    const double warpedLow = 2.0 * tan(M_PI * low);
+    const double warpedHigh = 2.0 * tan(M_PI * high);
+    const double warpedBandwidth = warpedHigh - warpedLow;
+    const double warpedCenter = sqrt(warpedLow * warpedHigh);
+    const double center = 2.0 * atan(warpedCenter / 2.0); // Digital center frequency in rad/sample
+
+    // Numerator of every section (the zeros) and the frequency of unit gain
+    double numerator[3];
+    double reference = 0.0;
+    switch (type) {
+    case Dso::FilterType::LOWPASS:
+        numerator[0] = 1.0, numerator[1] = 2.0, numerator[2] = 1.0;
+        break;
+    case Dso::FilterType::HIGHPASS:
+        numerator[0] = 1.0, numerator[1] = -2.0, numerator[2] = 1.0;
+        reference = M_PI;
+        break;
+    case Dso::FilterType::BANDPASS:
+        numerator[0] = 1.0, numerator[1] = 0.0, numerator[2] = -1.0;
+        reference = center;
+        break;
+    default:
+        numerator[0] = 1.0, numerator[1] = -2.0 * cos(center), numerator[2] = 1.0;
+        break;
+    }
+
+    // Adds the section with the given analog poles, the second pole is missing for a first order section
+    auto addSection = [&](Complex pole1, Complex pole2, bool firstOrder) {
+        const Complex z1 = (2.0 + pole1) / (2.0 - pole1);
+        const Complex z2 = (2.0 + pole2) / (2.0 - pole2);
+        Biquad section;
+        if (firstOrder) {
+            section.b0 = numerator[0];
+            section.b1 = numerator[1] / 2;
+            section.b2 = 0.0;
+            section.a1 = -z1.real();
+            section.a2 = 0.0;
+        } else {
+            section.b0 = numerator[0];
+            section.b1 = numerator[1];
+            section.b2 = numerator[2];
+            section.a1 = -(z1 + z2).real();
+            section.a2 = (z1 * z2).real();
+        }
+        const Complex delay = std::polar(1.0, -reference);
+        const double gain = std::abs((section.b0 + delay * (section.b1 + delay * section.b2)) /
+                                     (1.0 + delay * (section.a1 + delay * section.a2)));
+        section.b0 /= gain;
+        section.b1 /= gain;
+        section.b2 /= gain;
+        filter.sections.push_back(section);
+    };
+    // Band transformations turn one prototype pole into the two roots of s^2 - factor * s + center^2
+    auto addBandSections = [&](Complex factor, bool realPrototype) {
+        const Complex root = std::sqrt(factor * factor - 4.0 * warpedCenter * warpedCenter);
+        const Complex pole1 = (factor + root) / 2.0;
+        const Complex pole2 = (factor - root) / 2.0;
+        if (realPrototype) {
+            addSection(pole1, pole2, false);
+        } else {
+            addSection(pole1, std::conj(pole1), false);
+            addSection(pole2, std::conj(pole2), false);
+        }
+    };
+    // Poles of the analog Butterworth prototype, one of every conjugate pair and the real pole of odd orders
+    auto addPrototypePole = [&](Complex pole, bool real) {
+        switch (type) {
+        case Dso::FilterType::LOWPASS:
+            addSection(pole * warpedLow, std::conj(pole * warpedLow), real);
+            break;
+        case Dso::FilterType::HIGHPASS:
+            addSection(warpedLow / pole, std::conj(warpedLow / pole), real);
+            break;
+        case Dso::FilterType::BANDPASS:
+            addBandSections(pole * warpedBandwidth, real);
+            break;
+        default:
+            addBandSections(warpedBandwidth / pole, real);
+            break;
+        }
+    };
+    for (unsigned pair = 0; pair < order / 2; ++pair)
+        addPrototypePole(std::polar(1.0, M_PI * (2 * pair + order + 1) / (2 * order)), false);
+    if (order % 2) addPrototypePole(-1.0, true);
+}
+
+void FilterProcessor::designFir(ChannelFilter &filter, double low, double high) {
+    const unsigned tapCount = std::max(3u, std::min(filter.settings.taps, MAX_TAPS)) | 1;
+    const unsigned middle = tapCount / 2;
+    std::shared_ptr<const WindowTable> window = windowCache->get(Dso::WindowFunction::BLACKMAN, tapCount);
+
+    // Windowed sinc low-pass with unit gain at DC
+    auto lowpass = [&](double cutoff, double sign, std::vector<double> &taps) {
+        double sum = 0;
+        std::vector<double> values(tapCount);
+        for (unsigned tap = 0; tap < tapCount; ++tap) {
+            const double x = 2.0 * M_PI * cutoff * ((double)tap - middle);
+            values[tap] = (x == 0 ? 1.0 : sin(x) / x) * window->values[tap];
+            sum += values[tap];
+        }
+        for (unsigned tap = 0; tap < tapCount; ++tap) taps[tap] += sign * values[tap] / sum;
+    };
+
+    // High-pass and notch are the spectral inversion of low-pass and band-pass
+    std::vector<double> &taps = filter.taps;
+    taps.assign(tapCount, 0.0);
+    switch (filter.settings.type) {
+    case Dso::FilterType::LOWPASS:
+        lowpass(high, 1.0, taps);
+        break;
+    case Dso::FilterType::HIGHPASS:
+        lowpass(low, -1.0, taps);
+        taps[middle] += 1.0;
+        break;
+    case Dso::FilterType::BANDPASS:
+        lowpass(high, 1.0, taps);
+        lowpass(low, -1.0, taps);
+        break;
+    default:
+        lowpass(high, -1.0, taps);
+        lowpass(low, 1.0, taps);
+        taps[middle] += 1.0;
+        break;
+    }
+    if (tapCount <= DIRECT_MAX_TAPS) return;
+
+    // Overlap-save: Blocks of four times the filter length keep the share of discarded samples low
+    unsigned fftLength = 1;
+    while (fftLength < 4 * tapCount) fftLength <<= 1;
+    const unsigned binCount = fftLength / 2 + 1;
+    filter.fftLength = fftLength;
+    filter.fftReal = fftw_alloc_real(fftLength);
+    filter.fftComplex = fftw_alloc_complex(binCount);
+    filter.response = fftw_alloc_complex(binCount);
+    {
+        QMutexLocker plannerLock(&fftwPlannerMutex());
+#ifdef HAVE_FFTW_THREADS
+        fftw_plan_with_nthreads(1);
+#endif
+        filter.forward = fftw_plan_dft_r2c_1d(fftLength, filter.fftReal, filter.fftComplex, FFTW_ESTIMATE);
+        filter.backward = fftw_plan_dft_c2r_1d(fftLength, filter.fftComplex, filter.fftReal, FFTW_ESTIMATE);
+    }
+
+    std::copy(taps.begin(), taps.end(), filter.fftReal);
+    std::fill(filter.fftReal + tapCount, filter.fftReal + fftLength, 0.0);
+    fftw_execute(filter.forward);
+    for (unsigned bin = 0; bin < binCount; ++bin) {
+        filter.response[bin][0] = filter.fftComplex[bin][0] / fftLength;
+        filter.response[bin][1] = filter.fftComplex[bin][1] / fftLength;
+    }
+}
+
+void FilterProcessor::filterIir(ChannelFilter &filter, std::vector<double> &samples, bool roll) {
+    if (!roll || !filter.primed) {
+        // Start in the steady state of the first sample, so that the filter doesn't ring at the start
+        double value = samples.front();
+        for (Biquad &section : filter.sections) {
+            const double output =
+                value * (section.b0 + section.b1 + section.b2) / (1.0 + section.a1 + section.a2);
+            section.z2 = section.b2 * value - section.a2 * output;
+            section.z1 = output - section.b0 * value;
+            value = output;
+        }
+    }
+
+    // The recurrence can't be vectorized, but the block stays in the cache while it passes all sections
+    for (size_t begin = 0; begin < samples.size(); begin += IIR_BLOCK) {
+        double *const block = samples.data() + begin;
+        const size_t count = std::min(IIR_BLOCK, samples.size() - begin);
+        for (Biquad &section : filter.sections) {
+            const double b0 = section.b0, b1 = section.b1, b2 = section.b2, a1 = section.a1, a2 = section.a2;
+            double z1 = section.z1, z2 = section.z2;
+            for (size_t position = 0; position < count; ++position) {
+                const double input = block[position];
+                const double output = b0 * input + z1;
+                z1 = b1 * input - a1 * output + z2;
+                z2 = b2 * input - a2 * output;
+                block[position] = output;
+            }
+            section.z1 = z1;
+            section.z2 = z2;
+        }
+    }
+}
+
+void FilterProcessor::filterFir(ChannelFilter &filter, std::vector<double> &samples, bool roll) {
+    const size_t order = filter.taps.size() - 1;
+    extended.clear();
+    if (roll) {
+        // Causal: The previous frame precedes the samples
+        if (!filter.primed) filter.history.assign(order, samples.front());
+        extended.insert(extended.end(), filter.history.begin(), filter.history.end());
+        extended.insert(extended.end(), samples.begin(), samples.end());
+    } else {
+        // Centered: The record is extended by repeating the first and the last sample
+        extended.insert(extended.end(), order / 2, samples.front());
+        extended.insert(extended.end(), samples.begin(), samples.end());
+        extended.insert(extended.end(), order / 2, samples.back());
+    }
+
+    convolve(filter, extended.data(), samples.size(), samples.data());
+
+    if (roll) filter.history.assign(extended.end() - order, extended.end());
+}
+
+void FilterProcessor::convolve(ChannelFilter &filter, const double *input, size_t outputCount, double *output) {
+    const size_t tapCount = filter.taps.size();
+
+    if (!filter.fftLength) {
+        const double *const taps = filter.taps.data();
+        for (size_t position = 0; position < outputCount; ++position) {
+            const double *const window = input + position;
+            double sum = 0.0;
+            for (size_t tap = 0; tap < tapCount; ++tap) sum += taps[tap] * window[tap];
+            output[position] = sum;
+        }
+        return;
+    }
+
+    // The circular convolution of each block is only valid after the first tapCount-1 values. The taps are
+    // symmetric, so the convolution equals the correlation output[i] = sum(taps[k] * input[i + k]).
+    const size_t fftLength = filter.fftLength;
+    const size_t binCount = fftLength / 2 + 1;
+    const size_t step = fftLength - (tapCount - 1);
+    const size_t inputCount = outputCount + tapCount - 1;
+    for (size_t offset = 0; offset < outputCount; offset += step) {
+        const size_t available = std::min(fftLength, inputCount - offset);
+        std::copy(input + offset, input + offset + available, filter.fftReal);
+        std::fill(filter.fftReal + available, filter.fftReal + fftLength, 0.0);
+        fftw_execute(filter.forward);
+        for (size_t bin = 0; bin < binCount; ++bin) {
+            const double real = filter.fftComplex[bin][0], imag = filter.fftComplex[bin][1];
+            filter.fftComplex[bin][0] = real * filter.response[bin][0] - imag * filter.response[bin][1];
+            filter.fftComplex[bin][1] = real * filter.response[bin][1] + imag * filter.response[bin][0];
+        }
+        fftw_execute(filter.backward);
+        const size_t count = std::min(step, outputCount - offset);
+        std::copy(filter.fftReal + tapCount - 1, filter.fftReal + tapCount - 1 + count, output + offset);
+    }
+}
+
+void FilterProcessor::process(PPresult *result) {
+    const ChannelID channelCount =
+        std::min((ChannelID)result->channelCount(), (ChannelID)postprocessing->filter.size());
+    for (ChannelID channel = 0; channel < channelCount; ++channel) {
+        const DsoSettingsFilter settings = postprocessing->filter[channel];
+        ChannelFilter &filter = channelFilters[channel];
+
+        // Only filter the channels that are shown, analyzed or triggered on
+        const bool triggerSource = !scope->trigger.special && scope->trigger.source == channel;
+        if (settings.type == Dso::FilterType::OFF ||
+            (!scope->voltage[channel].used && !scope->spectrum[channel].used && !triggerSource)) {
+            filter.primed = false;
+            continue;
+        }
+
+        SampleValues &voltage = result->modifyData(channel)->voltage;
+        if (voltage.sample.empty() || voltage.interval <= 0.0) continue;
+
+        if (settings != filter.settings || voltage.interval != filter.interval)
+            design(filter, settings, voltage.interval);
+        if (!filter.active) continue;
+
+        if (settings.design == Dso::FilterDesign::IIR)
+            filterIir(filter, voltage.sample, result->append);
+        else
+            filterFir(filter, voltage.sample, result->append);
+        filter.primed = true;
+    }
+}
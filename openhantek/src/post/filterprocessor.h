@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <vector>
+
+#include <fftw3.h>
+
+#include "postprocessingsettings.h"
+#include "processor.h"
+#include "windowfunction.h"
+
+struct DsoSettingsScope;
+class PPresult;
+
+/// \brief Applies the digital filters of DsoSettingsPostProcessing::filter to the voltage samples.
+/// IIR filters are Butterworth designs (bilinear transform of the analog prototype) that run as a cascade
+/// of second order sections. FIR filters are Blackman windowed sincs, short ones are convolved directly and
+/// long ones block by block with the overlap-save method in the frequency domain.
+/// A triggered frame is filtered as a whole: The FIR output is centered (no delay) and the IIR state starts
+/// at the steady state of the first sample. In roll mode the state of the filters is carried over from one
+/// frame to the next, so the filtered signal continues seamlessly; the FIR output is then delayed by half
+/// the number of taps.
+class FilterProcessor : public Processor {
+  public:
+    FilterProcessor(const DsoSettingsScope *scope, const DsoSettingsPostProcessing *postprocessing,
+                    WindowCache *windowCache);
+    virtual ~FilterProcessor();
+    virtual void process(PPresult *result) override;
+
+  private:
+    /// \brief Second order section in transposed direct form II, normalized to a0 = 1.
+    struct Biquad {
+        double b0, b1, b2;
+        double a1, a2;
+        double z1 = 0.0, z2 = 0.0; ///< State
+    };
+
+    struct ChannelFilter {
+        DsoSettingsFilter settings;   ///< The settings the filter has been designed for
+        double interval = 0.0;        ///< The sample interval the filter has been designed for
+        bool active = false;          ///< false if the filter is off or can't be realized at this sample rate
+        bool primed = false;          ///< The state belongs to the previous frame
+        std::vector<Biquad> sections; ///< IIR filter
+        std::vector<double> taps;     ///< FIR filter, symmetric
+        std::vector<double> history;  ///< FIR: The last taps-1 input samples of the previous frame
+
+        unsigned fftLength = 0;            ///< Overlap-save block length, 0 for direct convolution
+        double *fftReal = nullptr;         ///< Time domain block
+        fftw_complex *fftComplex = nullptr; ///< Frequency domain block
+        fftw_complex *response = nullptr;  ///< DFT of the taps, scaled by 1/fftLength
+        fftw_plan forward = nullptr;
+        fftw_plan backward = nullptr;
+    };
+
+    void design(ChannelFilter &filter, const DsoSettingsFilter &settings, double interval);
+    void designIir(ChannelFilter &filter, double low, double high);
+    void designFir(ChannelFilter &filter, double low, double high);
+    void destroyPlan(ChannelFilter &filter);
+    void filterIir(ChannelFilter &filter, std::vector<double> &samples, bool roll);
+    void filterFir(ChannelFilter &filter, std::vector<double> &samples, bool roll);
+    /// \brief Computes output[i] = sum(taps[k] * input[i + k]) for outputCount values.
+    void convolve(ChannelFilter &filter, const double *input, size_t outputCount, double *output);
+
+    const DsoSettingsScope *scope;
+    const DsoSettingsPostProcessing *postprocessing;
+    WindowCache *windowCache;
+    std::vector<ChannelFilter> channelFilters;
+    std::vector<double> extended; ///< FIR input: history or padding, samples, padding
+};
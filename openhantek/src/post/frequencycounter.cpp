@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include "frequencycounter.h"
+#include "measurementgenerator.h"
+#include "scopesettings.h"
+
+FrequencyCounter::FrequencyCounter(const DsoSettingsScope *scope) : scope(scope) {}
+
+void FrequencyCounter::process(PPresult *result) {
+    for (ChannelID channel = 0; channel < result->channelCount(); ++channel) {
+        DataChannel *const channelData = result->modifyData(channel);
+        channelData->frequency = 0;
+        if (!scope->voltage[channel].used || channelData->voltage.sample.empty()) continue;
+
+        // The measurement generator usually ran before
+        if (!channelData->measurements.valid)
+            MeasurementGenerator::measure(channelData->voltage, channelData->measurements);
+        channelData->frequency = channelData->measurements.frequency;
+    }
+}
@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include "ppresult.h"
+#include "processor.h"
+
+struct DsoSettingsScope;
+
+/// \brief Saves the signal frequency of all enabled voltage channels in DataChannel::frequency.
+/// The frequency is found in the time domain by the edge detection of the MeasurementGenerator, so the
+/// frequency shown next to the graph and Measurements::frequency always agree. Without measurements for the
+/// frame, the channel is measured here.
+class FrequencyCounter : public Processor {
+  public:
+    FrequencyCounter(const DsoSettingsScope *scope);
+    virtual void process(PPresult *result) override;
+
+  private:
+    const DsoSettingsScope *scope;
+};
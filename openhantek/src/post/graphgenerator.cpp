@@ -1,16 +1,26 @@
 // SPDX-License-Identifier: GPL-2.0+
 
+#define _USE_MATH_DEFINES
 #include <QDebug>
 #include <QMutex>
+#include <algorithm>
+#include <cmath>
 #include <exception>
 
 #include "post/graphgenerator.h"
 #include "post/ppresult.h"
-#include "post/softwaretrigger.h"
 #include "hantekdso/controlspecification.h"
 #include "scopesettings.h"
 #include "utils/printutils.h"
 #include "viewconstants.h"
+#include "viewsettings.h"
+
+/// Number of input samples each interpolated value is computed from.
+static const unsigned SINC_TAPS = 16;
+/// Highest upsampling factor of the sin(x)/x interpolation.
+static const unsigned SINC_MAX_FACTOR = 32;
+/// Number of vertices the sin(x)/x interpolation aims for on the whole screen.
+static const unsigned SINC_POINTS = 4000;
 
 static const SampleValues &useSpecSamplesOf(ChannelID channel, const PPresult *result,
                                             const DsoSettingsScope *scope) {
@@ -26,20 +36,77 @@ static const SampleValues &useVoltSamplesOf(ChannelID channel, const PPresult *r
     return result->data(channel)->voltage;
 }
 
-GraphGenerator::GraphGenerator(const DsoSettingsScope *scope, bool isSoftwareTriggerDevice)
-    : scope(scope), isSoftwareTriggerDevice(isSoftwareTriggerDevice) {}
+GraphGenerator::GraphGenerator(const DsoSettingsScope *scope, const DsoSettingsView *view,
+                               bool isSoftwareTriggerDevice)
+    : scope(scope), view(view), isSoftwareTriggerDevice(isSoftwareTriggerDevice) {}
 
 bool GraphGenerator::isReady() const { return ready; }
 
+void GraphGenerator::updateSincBank(unsigned factor) {
+    if (factor == sincFactor) return;
+    sincFactor = factor;
+    sincBank.resize(factor * SINC_TAPS);
+
+    // Phase p interpolates at p/factor samples after the center tap SINC_TAPS/2-1
+    const double half = SINC_TAPS / 2;
+    for (unsigned phase = 0; phase < factor; ++phase) {
+        float *const coefficients = sincBank.data() + phase * SINC_TAPS;
+        double sum = 0.0;
+        for (unsigned tap = 0; tap < SINC_TAPS; ++tap) {
+            const double x = M_PI * ((double)tap - (half - 1) - (double)phase / factor);
+            const double value = x == 0.0 ? 1.0 : sin(x) / x * sin(x / half) / (x / half);
+            coefficients[tap] = (float)value;
+            sum += value;
+        }
+        // Unit gain at DC, so that flat signals stay flat
+        for (unsigned tap = 0; tap < SINC_TAPS; ++tap) coefficients[tap] = (float)(coefficients[tap] / sum);
+    }
+}
+
+void GraphGenerator::interpolateSinc(ChannelGraph &target, const double *samples, size_t visibleCount,
+                                     size_t sampleCount, float horizontalFactor, float scale, float offset,
+                                     unsigned factor) {
+    updateSincBank(factor);
+
+    // The kernels reach SINC_TAPS/2 samples to each side, the record is extended by repeating its ends
+    const ptrdiff_t before = SINC_TAPS / 2 - 1;
+    sincInput.resize(visibleCount + SINC_TAPS - 1);
+    for (size_t index = 0; index < sincInput.size(); ++index) {
+        const ptrdiff_t position =
+            std::min(std::max((ptrdiff_t)index - before, (ptrdiff_t)0), (ptrdiff_t)sampleCount - 1);
+        sincInput[index] = (float)samples[position] * scale + offset;
+    }
+
+    // Every phase is a short FIR filter over all visible samples. Accumulating tap by tap over the whole
+    // block (instead of one dot product per output) gives the compiler a loop it can vectorize.
+    sincOutput.assign(visibleCount * factor, 0.0f);
+    for (unsigned phase = 0; phase < factor; ++phase) {
+        const float *const coefficients = sincBank.data() + phase * SINC_TAPS;
+        float *const output = sincOutput.data() + phase * visibleCount;
+        for (unsigned tap = 0; tap < SINC_TAPS; ++tap) {
+            const float coefficient = coefficients[tap];
+            const float *const input = sincInput.data() + tap;
+            for (size_t position = 0; position < visibleCount; ++position)
+                output[position] += coefficient * input[position];
+        }
+    }
+
+    for (size_t position = 0; position < visibleCount; ++position) {
+        for (unsigned phase = 0; phase < factor; ++phase) {
+            target.push_back(QVector3D(((float)position + (float)phase / factor) * horizontalFactor - DIVS_TIME / 2,
+                                       sincOutput[phase * visibleCount + position], 0.0));
+        }
+    }
+}
+
 void GraphGenerator::generateGraphsTYvoltage(PPresult *result) {
+    // Trigger point of the software trigger, determined by the SoftwareTrigger processor
     unsigned preTrigSamples = 0;
-    unsigned postTrigSamples = 0;
     unsigned swTriggerStart = 0;
-
-    // check trigger point for software trigger
-    if (isSoftwareTriggerDevice && scope->trigger.source < result->channelCount())
-        std::tie(preTrigSamples, postTrigSamples, swTriggerStart) = SoftwareTrigger::compute(result, scope);
-    result->softwareTriggerTriggered = postTrigSamples > preTrigSamples;
+    if (isSoftwareTriggerDevice) {
+        preTrigSamples = result->preTrigSamples;
+        swTriggerStart = result->swTriggerStart;
+    }
 
     result->vaChannelVoltage.resize(scope->voltage.size());
     for (ChannelID channel = 0; channel < scope->voltage.size(); ++channel) {
@@ -61,9 +128,6 @@ void GraphGenerator::generateGraphsTYvoltage(PPresult *result) {
         sampleCount -= (swTriggerStart - preTrigSamples);
         size_t neededSize = sampleCount * 2;
 
-        // Set size directly to avoid reallocations
-        target.reserve(neededSize);
-
         // What's the horizontal distance between sampling points?
         float horizontalFactor = (float)(samples.interval / scope->horizontal.timebase);
 
@@ -75,11 +139,59 @@ void GraphGenerator::generateGraphsTYvoltage(PPresult *result) {
 
         std::advance(dataIterator, swTriggerStart - preTrigSamples);
 
-        for (unsigned int position = 0; position < sampleCount; ++position) {
+        // Interpolate the samples on the screen if there are too few of them for a smooth graph
+        size_t interpolated = 0;
+        unsigned factor = 1;
+        if (view->interpolation == Dso::INTERPOLATION_SINC && horizontalFactor > 0.0f) {
+            interpolated = std::min(sampleCount, (size_t)(DIVS_TIME / horizontalFactor) + 2);
+            factor = std::min(SINC_MAX_FACTOR, (unsigned)(SINC_POINTS / interpolated));
+            if (factor < 2) interpolated = 0;
+        }
+
+        // Set size directly to avoid reallocations
+        target.reserve(neededSize + interpolated * (factor - 1));
+
+        if (interpolated) {
+            interpolateSinc(target, &*dataIterator, interpolated, sampleCount, horizontalFactor, invert / gain,
+                            offset, factor);
+            std::advance(dataIterator, interpolated);
+        }
+
+        for (unsigned int position = interpolated; position < sampleCount; ++position) {
             target.push_back(QVector3D(position * horizontalFactor - DIVS_TIME / 2,
                                        (float)*(dataIterator++) / gain * invert + offset, 0.0));
         }
     }
+
+    generateGraphsTYenvelope(result);
+}
+
+void GraphGenerator::generateGraphsTYenvelope(PPresult *result) {
+    result->vaChannelEnvelope.resize(scope->voltage.size());
+    for (ChannelID channel = 0; channel < scope->voltage.size(); ++channel) {
+        ChannelGraph &target = result->vaChannelEnvelope[channel];
+        target.clear();
+
+        const DataChannel *channelData = result->data(channel);
+        if (!scope->voltage[channel].used || !channelData || channelData->envelopeMin.sample.empty()) continue;
+
+        const std::vector<double> &minimum = channelData->envelopeMin.sample;
+        const std::vector<double> &maximum = channelData->envelopeMax.sample;
+        const size_t sampleCount = std::min(minimum.size(), maximum.size());
+        target.reserve(sampleCount * 2);
+
+        const float horizontalFactor = (float)(channelData->envelopeMin.interval / scope->horizontal.timebase);
+        const float gain = (float)scope->gain(channel);
+        const float offset = (float)scope->voltage[channel].offset;
+        const float invert = scope->voltage[channel].inverted ? -1.0f : 1.0f;
+
+        // One vertical pair per sample position, drawn as a triangle strip
+        for (unsigned int position = 0; position < sampleCount; ++position) {
+            const float x = position * horizontalFactor - DIVS_TIME / 2;
+            target.push_back(QVector3D(x, (float)maximum[position] / gain * invert + offset, 0.0));
+            target.push_back(QVector3D(x, (float)minimum[position] / gain * invert + offset, 0.0));
+        }
+    }
 }
 
 void GraphGenerator::generateGraphsTYspectrum(PPresult *result) {
@@ -133,8 +245,9 @@ void GraphGenerator::process(PPresult *data) {
 void GraphGenerator::generateGraphsXY(PPresult *result, const DsoSettingsScope *scope) {
     result->vaChannelVoltage.resize(scope->voltage.size());
 
-    // Delete all spectrum graphs
+    // Delete all spectrum and envelope graphs
     for (ChannelGraph &data : result->vaChannelSpectrum) data.clear();
+    for (ChannelGraph &data : result->vaChannelEnvelope) data.clear();
 
     // Generate voltage graphs for pairs of channels
     for (ChannelID channel = 0; channel < scope->voltage.size(); channel += 2) {
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <deque>
+#include <vector>
 
 #include <QObject>
 #include <QVector3D>
@@ -12,17 +13,22 @@
 #include "processor.h"
 
 struct DsoSettingsScope;
+struct DsoSettingsView;
 class PPresult;
 namespace Dso {
 struct ControlSpecification;
 }
 
 /// \brief Generates ready to be used vertex arrays
+/// With Dso::INTERPOLATION_SINC, the samples on the screen are upsampled with a polyphase bank of
+/// Lanczos windowed sin(x)/x kernels, so that fast signals are reconstructed instead of connecting few
+/// samples with straight lines. The upsampling factor is chosen so that the screen holds a bounded
+/// number of vertices, samples outside of the screen are not interpolated.
 class GraphGenerator : public QObject, public Processor {
     Q_OBJECT
 
   public:
-    GraphGenerator(const DsoSettingsScope *scope, bool isSoftwareTriggerDevice);
+    GraphGenerator(const DsoSettingsScope *scope, const DsoSettingsView *view, bool isSoftwareTriggerDevice);
     void generateGraphsXY(PPresult *result, const DsoSettingsScope *scope);
 
     bool isReady() const;
@@ -30,12 +36,24 @@ class GraphGenerator : public QObject, public Processor {
   private:
     void generateGraphsTYvoltage(PPresult *result);
     void generateGraphsTYspectrum(PPresult *result);
+    void generateGraphsTYenvelope(PPresult *result);
+    /// \brief Appends the interpolated vertices of the first visibleCount samples to the graph.
+    void interpolateSinc(ChannelGraph &target, const double *samples, size_t visibleCount, size_t sampleCount,
+                         float horizontalFactor, float scale, float offset, unsigned factor);
+    /// \brief Computes the polyphase filter bank for the given upsampling factor.
+    void updateSincBank(unsigned factor);
 
   private:
     bool ready = false;
     const DsoSettingsScope *scope;
+    const DsoSettingsView *view;
     const bool isSoftwareTriggerDevice;
 
+    std::vector<float> sincBank;   ///< One set of SINC_TAPS coefficients for each of the sincFactor phases
+    unsigned sincFactor = 0;       ///< Upsampling factor of sincBank
+    std::vector<float> sincInput;  ///< Screen coordinates of the visible samples, extended at both ends
+    std::vector<float> sincOutput; ///< Interpolated screen coordinates, one block per phase
+
     // Processor interface
     private:
     virtual void process(PPresult *) override;
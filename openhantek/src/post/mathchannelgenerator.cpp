@@ -3,14 +3,46 @@
 #include "post/postprocessingsettings.h"
 #include "enums.h"
 
-MathChannelGenerator::MathChannelGenerator(const DsoSettingsScope *scope, unsigned physicalChannels)
-    : physicalChannels(physicalChannels), scope(scope) {}
+MathChannelGenerator::MathChannelGenerator(const DsoSettingsScope *scope,
+                                           const DsoSettingsPostProcessing *postprocessing, unsigned physicalChannels)
+    : physicalChannels(physicalChannels), scope(scope), postprocessing(postprocessing) {}
 
 MathChannelGenerator::~MathChannelGenerator() {}
 
 void MathChannelGenerator::process(PPresult *result) {
-    bool channelsHaveData = !result->data(0)->voltage.sample.empty() && !result->data(1)->voltage.sample.empty();
-    if (!channelsHaveData) return;
+    // The predefined modes are expressions as well
+    QString source;
+    switch (Dso::getMathMode(scope->voltage[physicalChannels])) {
+    case Dso::MathMode::ADD_CH1_CH2:
+        source = "CH1 + CH2";
+        break;
+    case Dso::MathMode::SUB_CH2_FROM_CH1:
+        source = "CH1 - CH2";
+        break;
+    case Dso::MathMode::SUB_CH1_FROM_CH2:
+        source = "CH2 - CH1";
+        break;
+    case Dso::MathMode::EXPRESSION: {
+        QMutexLocker locker(&postprocessing->mathExpressionMutex);
+        source = postprocessing->mathExpression;
+        break;
+    }
+    }
+    if (source != compiledSource) {
+        compiledSource = source;
+        expression.compile(source, physicalChannels);
+    }
+
+    std::vector<const std::vector<double> *> channels(physicalChannels);
+    bool channelsHaveData = expression.isValid();
+    double interval = 0.0;
+    for (ChannelID channel = 0; channel < physicalChannels; ++channel) {
+        const SampleValues &voltage = result->data(channel)->voltage;
+        channels[channel] = &voltage.sample;
+        if (expression.uses(channel) && voltage.sample.empty()) channelsHaveData = false;
+        if (interval == 0.0 && !voltage.sample.empty()) interval = voltage.interval;
+    }
+    if (!channelsHaveData || interval == 0.0) return;
 
     for (ChannelID channel = physicalChannels; channel < result->channelCount(); ++channel) {
         DataChannel *const channelData = result->modifyData(channel);
@@ -19,29 +51,9 @@ void MathChannelGenerator::process(PPresult *result) {
         if (!scope->voltage[channel].used && !scope->spectrum[channel].used) continue;
 
         // Set sampling interval
-        channelData->voltage.interval = result->data(0)->voltage.interval;
-
-        // Resize the sample vector
-        std::vector<double> &resultData = channelData->voltage.sample;
-        resultData.resize(std::min(result->data(0)->voltage.sample.size(), result->data(1)->voltage.sample.size()));
+        channelData->voltage.interval = interval;
 
         // Calculate values and write them into the sample buffer
-        std::vector<double>::const_iterator ch1Iterator = result->data(0)->voltage.sample.begin();
-        std::vector<double>::const_iterator ch2Iterator = result->data(1)->voltage.sample.begin();
-        for (std::vector<double>::iterator it = resultData.begin(); it != resultData.end(); ++it) {
-            switch (Dso::getMathMode(scope->voltage[physicalChannels])) {
-            case Dso::MathMode::ADD_CH1_CH2:
-                *it = *ch1Iterator + *ch2Iterator;
-                break;
-            case Dso::MathMode::SUB_CH2_FROM_CH1:
-                *it = *ch1Iterator - *ch2Iterator;
-                break;
-            case Dso::MathMode::SUB_CH1_FROM_CH2:
-                *it = *ch2Iterator - *ch1Iterator;
-                break;
-            }
-            ++ch1Iterator;
-            ++ch2Iterator;
-        }
+        expression.evaluate(channels, interval, channelData->voltage.sample);
     }
 }
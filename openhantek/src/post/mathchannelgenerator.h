@@ -2,18 +2,28 @@
 
 #pragma once
 
+#include <QString>
+
+#include "mathexpression.h"
 #include "processor.h"
 
 struct DsoSettingsScope;
+struct DsoSettingsPostProcessing;
 class PPresult;
 
+/// \brief Computes the math channel. All math modes are compiled into a MathExpression, which is only
+/// recompiled if the mode or the expression has been changed.
 class MathChannelGenerator : public Processor
 {
 public:
-    MathChannelGenerator(const DsoSettingsScope *scope, unsigned physicalChannels);
+    MathChannelGenerator(const DsoSettingsScope *scope, const DsoSettingsPostProcessing *postprocessing,
+                         unsigned physicalChannels);
     virtual ~MathChannelGenerator();
     virtual void process(PPresult *) override;
 private:
     const unsigned physicalChannels;
     const DsoSettingsScope *scope;
+    const DsoSettingsPostProcessing *postprocessing;
+    MathExpression expression;
+    QString compiledSource; ///< The source of the compiled expression
 };
@@ -0,0 +1,421 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#define _USE_MATH_DEFINES
+#include <QCoreApplication>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+#include "mathexpression.h"
+
+/// Number of samples every instruction processes at once. All blocks of the stack fit into the L1 cache.
+static const size_t BLOCK = 256;
+
+/// \brief Node of the syntax tree, only used while compiling.
+struct MathExpression::Node {
+    Op op;
+    double constant = 0.0;
+    ChannelID channel = 0;
+    std::unique_ptr<Node> left;  ///< Operand of unary operations, left operand of binary operations
+    std::unique_ptr<Node> right; ///< Right operand of binary operations
+
+    explicit Node(Op op) : op(op) {}
+    bool isConstant() const { return op == Op::Constant; }
+};
+
+/// \brief Recursive descent parser for the expression grammar:
+///     sum      := product (('+' | '-') product)*
+///     product  := negation (('*' | '/') negation)*
+///     negation := ('-' | '+') negation | primary
+///     primary  := number | constant | channel | function '(' sum ')' | '(' sum ')'
+/// Constant subexpressions are folded while parsing.
+class MathExpression::Parser {
+  public:
+    Parser(const QString &text, ChannelID channels) : text(text.toLower()), channels(channels) {}
+
+    std::unique_ptr<Node> parse() {
+        std::unique_ptr<Node> node = sum();
+        skipSpaces();
+        if (node && position < text.size()) fail(QCoreApplication::tr("Unexpected '%1'").arg(text[position]));
+        return error.isEmpty() ? std::move(node) : nullptr;
+    }
+
+    QString error;
+
+  private:
+    void fail(const QString &message) {
+        if (error.isEmpty()) error = QCoreApplication::tr("%1 at position %2").arg(message).arg(position + 1);
+    }
+
+    void skipSpaces() {
+        while (position < text.size() && text[position].isSpace()) ++position;
+    }
+
+    bool accept(QChar character) {
+        skipSpaces();
+        if (position >= text.size() || text[position] != character) return false;
+        ++position;
+        return true;
+    }
+
+    static std::unique_ptr<Node> constant(double value) {
+        std::unique_ptr<Node> node(new Node(Op::Constant));
+        node->constant = value;
+        return node;
+    }
+
+    static std::unique_ptr<Node> binary(Op op, std::unique_ptr<Node> left, std::unique_ptr<Node> right) {
+        if (left->isConstant() && right->isConstant()) {
+            const double a = left->constant, b = right->constant;
+            switch (op) {
+            case Op::Add: return constant(a + b);
+            case Op::Subtract: return constant(a - b);
+            case Op::Multiply: return constant(a * b);
+            default: return constant(a / b);
+            }
+        }
+        std::unique_ptr<Node> node(new Node(op));
+        node->left = std::move(left);
+        node->right = std::move(right);
+        return node;
+    }
+
+    static std::unique_ptr<Node> unary(Op op, std::unique_ptr<Node> operand) {
+        if (operand->isConstant()) {
+            const double a = operand->constant;
+            switch (op) {
+            case Op::Negate: return constant(-a);
+            case Op::Abs: return constant(std::fabs(a));
+            case Op::Sqrt: return constant(std::sqrt(a));
+            case Op::Log: return constant(std::log(a));
+            case Op::Differentiate: return constant(0.0);
+            default: break; // The integral of a constant is a ramp
+            }
+        }
+        std::unique_ptr<Node> node(new Node(op));
+        node->left = std::move(operand);
+        return node;
+    }
+
+    std::unique_ptr<Node> sum() {
+        std::unique_ptr<Node> node = product();
+        while (node) {
+            Op op;
+            if (accept('+'))
+                op = Op::Add;
+            else if (accept('-'))
+                op = Op::Subtract;
+            else
+                break;
+            std::unique_ptr<Node> right = product();
+            if (!right) return nullptr;
+            node = binary(op, std::move(node), std::move(right));
+        }
+        return node;
+    }
+
+    std::unique_ptr<Node> product() {
+        std::unique_ptr<Node> node = negation();
+        while (node) {
+            Op op;
+            if (accept('*'))
+                op = Op::Multiply;
+            else if (accept('/'))
+                op = Op::Divide;
+            else
+                break;
+            std::unique_ptr<Node> right = negation();
+            if (!right) return nullptr;
+            node = binary(op, std::move(node), std::move(right));
+        }
+        return node;
+    }
+
+    std::unique_ptr<Node> negation() {
+        if (accept('-')) {
+            std::unique_ptr<Node> operand = negation();
+            return operand ? unary(Op::Negate, std::move(operand)) : nullptr;
+        }
+        if (accept('+')) return negation();
+        return primary();
+    }
+
+    std::unique_ptr<Node> primary() {
+        skipSpaces();
+        if (position >= text.size()) {
+            fail(QCoreApplication::tr("Unexpected end"));
+            return nullptr;
+        }
+
+        if (accept('(')) {
+            std::unique_ptr<Node> node = sum();
+            if (node && !accept(')')) {
+                fail(QCoreApplication::tr("Missing ')'"));
+                return nullptr;
+            }
+            return node;
+        }
+
+        const QChar first = text[position];
+        if (first.isDigit() || first == '.') return number();
+        if (!first.isLetter()) {
+            fail(QCoreApplication::tr("Unexpected '%1'").arg(first));
+            return nullptr;
+        }
+
+        const int start = position;
+        while (position < text.size() && (text[position].isLetterOrNumber() || text[position] == '_')) ++position;
+        const QString name = text.mid(start, position - start);
+
+        if (name == "pi") return constant(M_PI);
+        if (name == "e") return constant(M_E);
+        if (name.startsWith("ch")) {
+            bool ok = false;
+            const unsigned number = name.mid(2).toUInt(&ok);
+            if (!ok || number < 1 || number > channels) {
+                position = start;
+                fail(QCoreApplication::tr("Unknown channel '%1'").arg(name));
+                return nullptr;
+            }
+            std::unique_ptr<Node> node(new Node(Op::Channel));
+            node->channel = number - 1;
+            return node;
+        }
+
+        Op op;
+        if (name == "abs")
+            op = Op::Abs;
+        else if (name == "sqrt")
+            op = Op::Sqrt;
+        else if (name == "log")
+            op = Op::Log;
+        else if (name == "integrate")
+            op = Op::Integrate;
+        else if (name == "differentiate")
+            op = Op::Differentiate;
+        else {
+            position = start;
+            fail(QCoreApplication::tr("Unknown name '%1'").arg(name));
+            return nullptr;
+        }
+        if (!accept('(')) {
+            fail(QCoreApplication::tr("Missing '('"));
+            return nullptr;
+        }
+        std::unique_ptr<Node> operand = sum();
+        if (!operand) return nullptr;
+        if (!accept(')')) {
+            fail(QCoreApplication::tr("Missing ')'"));
+            return nullptr;
+        }
+        return unary(op, std::move(operand));
+    }
+
+    std::unique_ptr<Node> number() {
+        const int start = position;
+        while (position < text.size() && (text[position].isDigit() || text[position] == '.')) ++position;
+        // Exponent, but not the constant e in "2e"
+        if (position + 1 < text.size() && text[position] == 'e') {
+            int exponent = position + 1;
+            if (text[exponent] == '+' || text[exponent] == '-') ++exponent;
+            if (exponent < text.size() && text[exponent].isDigit()) {
+                position = exponent;
+                while (position < text.size() && text[position].isDigit()) ++position;
+            }
+        }
+        bool ok = false;
+        const double value = text.mid(start, position - start).toDouble(&ok);
+        if (!ok) {
+            position = start;
+            fail(QCoreApplication::tr("Invalid number"));
+            return nullptr;
+        }
+        return constant(value);
+    }
+
+    const QString text;
+    const ChannelID channels;
+    int position = 0;
+};
+
+bool MathExpression::compile(const QString &expression, ChannelID channels) {
+    program.clear();
+    usedChannels.clear();
+    stackDepth = 0;
+    stateCount = 0;
+
+    Parser parser(expression, channels);
+    std::unique_ptr<Node> root = parser.parse();
+    errorString = parser.error;
+    if (!root) {
+        if (errorString.isEmpty()) errorString = QCoreApplication::tr("Empty expression");
+        return false;
+    }
+
+    generate(root.get(), 0);
+    stack.resize(stackDepth * BLOCK);
+    state.resize(stateCount * 2);
+    return true;
+}
+
+bool MathExpression::uses(ChannelID channel) const {
+    return std::find(usedChannels.begin(), usedChannels.end(), channel) != usedChannels.end();
+}
+
+/// \brief Emits the instructions for the given node, its result ends up at the given stack position.
+void MathExpression::generate(const Node *node, unsigned depth) {
+    stackDepth = std::max(stackDepth, depth + 1);
+    Instruction instruction;
+    instruction.op = node->op;
+
+    switch (node->op) {
+    case Op::Channel:
+        instruction.channel = node->channel;
+        if (!uses(node->channel)) usedChannels.push_back(node->channel);
+        break;
+    case Op::Constant:
+        instruction.constant = node->constant;
+        break;
+    case Op::Add:
+    case Op::Subtract:
+    case Op::Multiply:
+    case Op::Divide:
+        // Fuse a constant operand into the instruction instead of filling a block with it
+        if (node->right->isConstant()) {
+            generate(node->left.get(), depth);
+            const double c = node->right->constant;
+            switch (node->op) {
+            case Op::Add: instruction.op = Op::AddConstant, instruction.constant = c; break;
+            case Op::Subtract: instruction.op = Op::AddConstant, instruction.constant = -c; break;
+            case Op::Multiply: instruction.op = Op::MultiplyConstant, instruction.constant = c; break;
+            default: instruction.op = Op::MultiplyConstant, instruction.constant = 1.0 / c; break;
+            }
+        } else if (node->left->isConstant()) {
+            generate(node->right.get(), depth);
+            const double c = node->left->constant;
+            switch (node->op) {
+            case Op::Add: instruction.op = Op::AddConstant; break;
+            case Op::Subtract: instruction.op = Op::SubtractFrom; break;
+            case Op::Multiply: instruction.op = Op::MultiplyConstant; break;
+            default: instruction.op = Op::DivideConstant; break;
+            }
+            instruction.constant = c;
+        } else {
+            generate(node->left.get(), depth);
+            generate(node->right.get(), depth + 1);
+        }
+        break;
+    case Op::Integrate:
+    case Op::Differentiate:
+        instruction.state = stateCount++;
+        generate(node->left.get(), depth);
+        break;
+    default:
+        generate(node->left.get(), depth);
+        break;
+    }
+    program.push_back(instruction);
+}
+
+void MathExpression::evaluate(const std::vector<const std::vector<double> *> &channels, double interval,
+                              std::vector<double> &result) {
+    if (program.empty()) {
+        result.clear();
+        return;
+    }
+
+    // The result is as long as the shortest referenced channel, or the longest channel for constants
+    size_t length = std::numeric_limits<size_t>::max();
+    for (ChannelID channel : usedChannels) length = std::min(length, channels[channel]->size());
+    if (usedChannels.empty()) {
+        length = 0;
+        for (const std::vector<double> *samples : channels) length = std::max(length, samples->size());
+    }
+    result.resize(length);
+
+    for (size_t base = 0; base < length; base += BLOCK) {
+        const size_t count = std::min(BLOCK, length - base);
+        unsigned top = 0; // Number of blocks on the stack
+        for (const Instruction &instruction : program) {
+            double *a = top ? stack.data() + (top - 1) * BLOCK : nullptr; // Topmost block
+            double *b = stack.data() + top * BLOCK;                       // Next free block
+            const double c = instruction.constant;
+            switch (instruction.op) {
+            case Op::Channel:
+                std::copy(channels[instruction.channel]->begin() + base,
+                          channels[instruction.channel]->begin() + base + count, b);
+                ++top;
+                break;
+            case Op::Constant:
+                std::fill(b, b + count, c);
+                ++top;
+                break;
+            case Op::Add:
+                b = a, a -= BLOCK, --top;
+                for (size_t i = 0; i < count; ++i) a[i] += b[i];
+                break;
+            case Op::Subtract:
+                b = a, a -= BLOCK, --top;
+                for (size_t i = 0; i < count; ++i) a[i] -= b[i];
+                break;
+            case Op::Multiply:
+                b = a, a -= BLOCK, --top;
+                for (size_t i = 0; i < count; ++i) a[i] *= b[i];
+                break;
+            case Op::Divide:
+                b = a, a -= BLOCK, --top;
+                for (size_t i = 0; i < count; ++i) a[i] /= b[i];
+                break;
+            case Op::AddConstant:
+                for (size_t i = 0; i < count; ++i) a[i] += c;
+                break;
+            case Op::SubtractFrom:
+                for (size_t i = 0; i < count; ++i) a[i] = c - a[i];
+                break;
+            case Op::MultiplyConstant:
+                for (size_t i = 0; i < count; ++i) a[i] *= c;
+                break;
+            case Op::DivideConstant:
+                for (size_t i = 0; i < count; ++i) a[i] = c / a[i];
+                break;
+            case Op::Negate:
+                for (size_t i = 0; i < count; ++i) a[i] = -a[i];
+                break;
+            case Op::Abs:
+                for (size_t i = 0; i < count; ++i) a[i] = std::fabs(a[i]);
+                break;
+            case Op::Sqrt:
+                for (size_t i = 0; i < count; ++i) a[i] = std::sqrt(a[i]);
+                break;
+            case Op::Log:
+                for (size_t i = 0; i < count; ++i) a[i] = std::log(a[i]);
+                break;
+            case Op::Integrate: {
+                // Running sum and previous sample are carried over from the last block
+                double &sum = state[instruction.state * 2];
+                double &previous = state[instruction.state * 2 + 1];
+                if (base == 0) sum = 0.0, previous = a[0];
+                const double factor = 0.5 * interval;
+                for (size_t i = 0; i < count; ++i) {
+                    const double value = a[i];
+                    sum += (value + previous) * factor;
+                    previous = value;
+                    a[i] = sum;
+                }
+                break;
+            }
+            case Op::Differentiate: {
+                double &previous = state[instruction.state * 2 + 1];
+                if (base == 0) previous = a[0];
+                const double last = a[count - 1];
+                for (size_t i = count - 1; i > 0; --i) a[i] = (a[i] - a[i - 1]) / interval;
+                a[0] = (a[0] - previous) / interval;
+                previous = last;
+                break;
+            }
+            }
+        }
+        std::copy(stack.begin(), stack.begin() + count, result.begin() + base);
+    }
+}
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <QString>
+#include <vector>
+
+#include "hantekprotocol/types.h"
+
+/// \brief A math channel expression, compiled into a plan that is evaluated block by block.
+/// The language knows the operators `+ - * /`, parentheses, numbers, the constants `pi` and `e`,
+/// the channels `CH1` ... `CHn` and the functions `abs`, `sqrt`, `log`, `integrate` and `differentiate`.
+/// Constant subexpressions are folded and operations with a constant operand are fused into one
+/// instruction. Every instruction is a tight loop over a block of samples that stays in the cache,
+/// so the compiler is able to vectorize it.
+class MathExpression {
+  public:
+    /// \brief Compiles the given expression.
+    /// \param expression The source text.
+    /// \param channels The number of channels that may be referenced.
+    /// \return true on success, see error() otherwise.
+    bool compile(const QString &expression, ChannelID channels);
+    /// \return true if the last compile() was successful.
+    bool isValid() const { return !program.empty(); }
+    /// \return A description of the compilation error, empty on success.
+    const QString &error() const { return errorString; }
+    /// \return true if the given channel is referenced by the expression.
+    bool uses(ChannelID channel) const;
+
+    /// \brief Evaluates the expression.
+    /// \param channels The samples of all channels, unused channels may be empty.
+    /// \param interval The sample interval, used by integrate and differentiate.
+    /// \param result Receives the result, it is as long as the shortest referenced channel.
+    void evaluate(const std::vector<const std::vector<double> *> &channels, double interval,
+                  std::vector<double> &result);
+
+  private:
+    enum class Op {
+        Channel,  ///< Push the samples of a channel
+        Constant, ///< Push a constant
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        AddConstant,      ///< x + c
+        SubtractFrom,     ///< c - x
+        MultiplyConstant, ///< x * c
+        DivideConstant,   ///< c / x
+        Negate,
+        Abs,
+        Sqrt,
+        Log,
+        Integrate,    ///< Running trapezoidal integral, continued over the blocks
+        Differentiate ///< Backward difference, continued over the blocks
+    };
+    struct Instruction {
+        Op op;
+        ChannelID channel = 0;
+        double constant = 0.0;
+        unsigned state = 0; ///< Index into the state of integrate/differentiate
+    };
+    struct Node;
+    class Parser;
+
+    void generate(const Node *node, unsigned depth);
+
+    std::vector<Instruction> program;
+    std::vector<ChannelID> usedChannels;
+    unsigned stackDepth = 0;
+    unsigned stateCount = 0;
+    QString errorString;
+    std::vector<double> stack; ///< stackDepth blocks of samples
+    std::vector<double> state; ///< Two values per integrate/differentiate instruction
+};
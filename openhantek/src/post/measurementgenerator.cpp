@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "measurementgenerator.h"
+#include "scopesettings.h"
+
+/// Number of histogram bins for the top/base levels. Matches the resolution of the 8 bit ADCs.
+static const unsigned HISTOGRAM_BINS = 256;
+/// Number of independent accumulators in the statistics loop.
+static const unsigned LANES = 4;
+
+MeasurementGenerator::MeasurementGenerator(const DsoSettingsScope *scope) : scope(scope) {}
+
+void MeasurementGenerator::process(PPresult *result) {
+    for (ChannelID channel = 0; channel < result->channelCount(); ++channel) {
+        DataChannel *const channelData = result->modifyData(channel);
+        channelData->measurements = Measurements();
+        if (!scope->voltage[channel].used || channelData->voltage.sample.empty()) continue;
+        measure(channelData->voltage, channelData->measurements);
+    }
+}
+
+/// \brief Sub-sample position where the line from (position - 1, previous) to (position, value) crosses level.
+static inline double crossingPosition(size_t position, double previous, double value, double level) {
+    return (double)(position - 1) + (level - previous) / (value - previous);
+}
+
+/// \brief Measures rise/fall time, period and duty cycle.
+/// Edges are only accepted if the signal passes both the 10% and the 90% level, which gives a hysteresis
+/// against noise around the 50% level.
+static void measureTransitions(const double *samples, size_t count, double low, double middle, double high,
+                               double interval, Measurements &m) {
+    enum class Level { Unknown, Low, High } level = Level::Unknown;
+    if (samples[0] < low)
+        level = Level::Low;
+    else if (samples[0] > high)
+        level = Level::High;
+
+    double lowCrossing = -1, highCrossing = -1;
+    double risingMiddle = -1, fallingMiddle = -1;
+    double firstRisingEdge = -1, lastRisingEdge = -1;
+    double riseSum = 0, fallSum = 0, highTimeSum = 0;
+    unsigned rises = 0, falls = 0, risingEdges = 0, highTimes = 0;
+
+    for (size_t position = 1; position < count; ++position) {
+        const double previous = samples[position - 1];
+        const double value = samples[position];
+        if (value > previous) {
+            if (previous < low && value >= low) lowCrossing = crossingPosition(position, previous, value, low);
+            if (previous < middle && value >= middle)
+                risingMiddle = crossingPosition(position, previous, value, middle);
+            if (previous < high && value >= high) {
+                highCrossing = crossingPosition(position, previous, value, high);
+                if (level == Level::Low && lowCrossing >= 0) {
+                    riseSum += highCrossing - lowCrossing;
+                    ++rises;
+                    if (firstRisingEdge < 0) firstRisingEdge = risingMiddle;
+                    lastRisingEdge = risingMiddle;
+                    ++risingEdges;
+                }
+                level = Level::High;
+            }
+        } else if (value < previous) {
+            if (previous > high && value <= high) highCrossing = crossingPosition(position, previous, value, high);
+            if (previous > middle && value <= middle)
+                fallingMiddle = crossingPosition(position, previous, value, middle);
+            if (previous > low && value <= low) {
+                lowCrossing = crossingPosition(position, previous, value, low);
+                if (level == Level::High && highCrossing >= 0) {
+                    fallSum += lowCrossing - highCrossing;
+                    ++falls;
+                    if (lastRisingEdge >= 0) {
+                        highTimeSum += fallingMiddle - lastRisingEdge;
+                        ++highTimes;
+                    }
+                }
+                level = Level::Low;
+            }
+        }
+    }
+
+    if (rises) m.riseTime = riseSum / rises * interval;
+    if (falls) m.fallTime = fallSum / falls * interval;
+    if (risingEdges > 1) {
+        const double periodSamples = (lastRisingEdge - firstRisingEdge) / (risingEdges - 1);
+        m.period = periodSamples * interval;
+        m.frequency = 1.0 / m.period;
+        if (highTimes) m.dutyCycle = highTimeSum / highTimes / periodSamples * 100.0;
+    }
+}
+
+void MeasurementGenerator::measure(const SampleValues &voltage, Measurements &m) {
+    const double *samples = voltage.sample.data();
+    const size_t count = voltage.sample.size();
+    if (!count) return;
+
+    // Statistics: Independent lanes without data dependencies between them, so that
+    // the compiler can keep them in SIMD registers. The sums are taken relative to the first sample, which
+    // removes the DC offset before squaring: A small AC signal on a large offset would cancel out otherwise.
+    const double shift = samples[0];
+    double laneMinimum[LANES], laneMaximum[LANES], laneSum[LANES], laneSquares[LANES];
+    for (unsigned lane = 0; lane < LANES; ++lane) {
+        laneMinimum[lane] = laneMaximum[lane] = samples[0];
+        laneSum[lane] = laneSquares[lane] = 0.0;
+    }
+    size_t position = 0;
+    for (; position + LANES <= count; position += LANES) {
+        for (unsigned lane = 0; lane < LANES; ++lane) {
+            const double value = samples[position + lane];
+            laneMinimum[lane] = value < laneMinimum[lane] ? value : laneMinimum[lane];
+            laneMaximum[lane] = value > laneMaximum[lane] ? value : laneMaximum[lane];
+            laneSum[lane] += value - shift;
+            laneSquares[lane] += (value - shift) * (value - shift);
+        }
+    }
+    for (; position < count; ++position) {
+        const double value = samples[position];
+        laneMinimum[0] = value < laneMinimum[0] ? value : laneMinimum[0];
+        laneMaximum[0] = value > laneMaximum[0] ? value : laneMaximum[0];
+        laneSum[0] += value - shift;
+        laneSquares[0] += (value - shift) * (value - shift);
+    }
+    double sum = 0.0, squares = 0.0;
+    m.minimum = laneMinimum[0];
+    m.maximum = laneMaximum[0];
+    for (unsigned lane = 0; lane < LANES; ++lane) {
+        m.minimum = std::min(m.minimum, laneMinimum[lane]);
+        m.maximum = std::max(m.maximum, laneMaximum[lane]);
+        sum += laneSum[lane];
+        squares += laneSquares[lane];
+    }
+    const double shiftedMean = sum / count;
+    const double variance = std::max(0.0, squares / count - shiftedMean * shiftedMean);
+    m.mean = shift + shiftedMean;
+    m.acRms = std::sqrt(variance);
+    m.rms = std::sqrt(m.mean * m.mean + variance);
+    m.valid = true;
+
+    m.top = m.maximum;
+    m.base = m.minimum;
+    if (m.maximum <= m.minimum) return;
+
+    // Top and base: The most common levels in the upper and lower half of the histogram. Signals
+    // without flat levels (sine, triangle) fall back to the extremes.
+    std::array<unsigned, HISTOGRAM_BINS> histogram;
+    histogram.fill(0);
+    const double binScale = HISTOGRAM_BINS / (m.maximum - m.minimum);
+    for (position = 0; position < count; ++position)
+        ++histogram[std::min((unsigned)((samples[position] - m.minimum) * binScale), HISTOGRAM_BINS - 1)];
+
+    unsigned baseBin = 0, topBin = HISTOGRAM_BINS / 2;
+    for (unsigned bin = 1; bin < HISTOGRAM_BINS / 2; ++bin)
+        if (histogram[bin] > histogram[baseBin]) baseBin = bin;
+    for (unsigned bin = HISTOGRAM_BINS / 2 + 1; bin < HISTOGRAM_BINS; ++bin)
+        if (histogram[bin] > histogram[topBin]) topBin = bin;
+
+    const size_t minimumShare = count / 20;
+    if (histogram[topBin] > minimumShare) m.top = m.minimum + (topBin + 0.5) / binScale;
+    if (histogram[baseBin] > minimumShare) m.base = m.minimum + (baseBin + 0.5) / binScale;
+
+    const double amplitude = m.amplitude();
+    if (amplitude <= 0) return;
+    m.overshoot = (m.maximum - m.top) / amplitude * 100.0;
+
+    measureTransitions(samples, count, m.base + 0.1 * amplitude, m.base + 0.5 * amplitude, m.base + 0.9 * amplitude,
+                       voltage.interval, m);
+}
@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include "ppresult.h"
+#include "processor.h"
+
+struct DsoSettingsScope;
+
+/// \brief Computes the automatic measurements (see ::Measurements) of all enabled voltage channels.
+/// Each record is read three times in tight loops: once for the statistics (min, max, mean, rms),
+/// once for the level histogram (top, base) and once for the transitions (rise/fall time, period,
+/// duty cycle). No other processor or widget needs to walk over the samples for these values again.
+class MeasurementGenerator : public Processor {
+  public:
+    MeasurementGenerator(const DsoSettingsScope *scope);
+    virtual void process(PPresult *result) override;
+
+    /// \brief Measures the given voltage samples.
+    /// \param voltage The samples and their interval.
+    /// \param measurements The result, Measurements::valid is set if there was any data.
+    static void measure(const SampleValues &voltage, Measurements &measurements);
+
+  private:
+    const DsoSettingsScope *scope;
+};
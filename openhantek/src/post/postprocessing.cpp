@@ -8,6 +8,8 @@ void PostProcessing::registerProcessor(Processor *processor) { processors.push_b
 
 void PostProcessing::convertData(const DSOsamples *source, PPresult *destination) {
     QReadLocker locker(&source->lock);
+    destination->append = source->append;
+    destination->timestamp = source->timestamp;
 
     for (ChannelID channel = 0; channel < source->data.size(); ++channel) {
         const std::vector<double> &rawChannelData = source->data.at(channel);
@@ -5,8 +5,11 @@
 
 namespace Dso {
 
-Enum<Dso::MathMode, Dso::MathMode::ADD_CH1_CH2, Dso::MathMode::SUB_CH1_FROM_CH2> MathModeEnum;
+Enum<Dso::MathMode, Dso::MathMode::ADD_CH1_CH2, Dso::MathMode::EXPRESSION> MathModeEnum;
 Enum<Dso::WindowFunction, Dso::WindowFunction::RECTANGULAR, Dso::WindowFunction::FLATTOP> WindowFunctionEnum;
+Enum<Dso::SpectrumAveraging, Dso::SpectrumAveraging::RMS, Dso::SpectrumAveraging::MAXHOLD> SpectrumAveragingEnum;
+Enum<Dso::FilterType, Dso::FilterType::OFF, Dso::FilterType::NOTCH> FilterTypeEnum;
+Enum<Dso::FilterDesign, Dso::FilterDesign::IIR, Dso::FilterDesign::FIR> FilterDesignEnum;
 
 /// \brief Return string representation of the given math mode.
 /// \param mode The ::MathMode that should be returned as string.
@@ -19,6 +22,8 @@ QString mathModeString(MathMode mode) {
         return QCoreApplication::tr("CH1 - CH2");
     case MathMode::SUB_CH1_FROM_CH2:
         return QCoreApplication::tr("CH2 - CH1");
+    case MathMode::EXPRESSION:
+        return QCoreApplication::tr("Expression");
     }
     return QString();
 }
@@ -60,4 +65,51 @@ QString windowFunctionString(WindowFunction window) {
     }
     return QString();
 }
+
+/// \brief Return string representation of the given spectrum averaging.
+/// \param averaging The ::SpectrumAveraging that should be returned as string.
+/// \return The string that should be used in labels etc.
+QString spectrumAveragingString(SpectrumAveraging averaging) {
+    switch (averaging) {
+    case SpectrumAveraging::RMS:
+        return QCoreApplication::tr("RMS average");
+    case SpectrumAveraging::PEAKHOLD:
+        return QCoreApplication::tr("Peak hold");
+    case SpectrumAveraging::MAXHOLD:
+        return QCoreApplication::tr("Max hold");
+    }
+    return QString();
+}
+
+/// \brief Return string representation of the given filter type.
+/// \param type The ::FilterType that should be returned as string.
+/// \return The string that should be used in labels etc.
+QString filterTypeString(FilterType type) {
+    switch (type) {
+    case FilterType::OFF:
+        return QCoreApplication::tr("Off");
+    case FilterType::LOWPASS:
+        return QCoreApplication::tr("Low-pass");
+    case FilterType::HIGHPASS:
+        return QCoreApplication::tr("High-pass");
+    case FilterType::BANDPASS:
+        return QCoreApplication::tr("Band-pass");
+    case FilterType::NOTCH:
+        return QCoreApplication::tr("Notch");
+    }
+    return QString();
+}
+
+/// \brief Return string representation of the given filter design.
+/// \param design The ::FilterDesign that should be returned as string.
+/// \return The string that should be used in labels etc.
+QString filterDesignString(FilterDesign design) {
+    switch (design) {
+    case FilterDesign::IIR:
+        return QCoreApplication::tr("IIR (Butterworth)");
+    case FilterDesign::FIR:
+        return QCoreApplication::tr("FIR (windowed sinc)");
+    }
+    return QString();
+}
 }
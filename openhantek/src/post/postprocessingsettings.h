@@ -2,12 +2,16 @@
 
 #include "utils/enumclass.h"
 #include <QMetaType>
+#include <QMutex>
+#include <QString>
+#include <vector>
 namespace Dso {
 
 /// \enum MathMode
 /// \brief The different math modes for the math-channel.
-enum class MathMode : unsigned { ADD_CH1_CH2, SUB_CH2_FROM_CH1, SUB_CH1_FROM_CH2 };
-extern Enum<Dso::MathMode, Dso::MathMode::ADD_CH1_CH2, Dso::MathMode::SUB_CH1_FROM_CH2> MathModeEnum;
+/// EXPRESSION evaluates DsoSettingsPostProcessing::mathExpression, see MathExpression.
+enum class MathMode : unsigned { ADD_CH1_CH2, SUB_CH2_FROM_CH1, SUB_CH1_FROM_CH2, EXPRESSION };
+extern Enum<Dso::MathMode, Dso::MathMode::ADD_CH1_CH2, Dso::MathMode::EXPRESSION> MathModeEnum;
 
 template<class T>
 inline MathMode getMathMode(T& t) { return (MathMode)t.couplingOrMathIndex; }
@@ -35,15 +39,83 @@ enum class WindowFunction : int {
 };
 extern Enum<Dso::WindowFunction, Dso::WindowFunction::RECTANGULAR, Dso::WindowFunction::FLATTOP> WindowFunctionEnum;
 
+/// \enum SpectrumAveraging
+/// \brief How the power of the DFT segments (Welch method) and of consecutive frames is combined.
+enum class SpectrumAveraging : int {
+    RMS,      ///< Average power of all segments, averaged over spectrumFrames frames
+    PEAKHOLD, ///< Highest power of all segments of the current frame
+    MAXHOLD   ///< Highest average power since the settings have been changed
+};
+extern Enum<Dso::SpectrumAveraging, Dso::SpectrumAveraging::RMS, Dso::SpectrumAveraging::MAXHOLD>
+    SpectrumAveragingEnum;
+
+/// \enum FilterType
+/// \brief The digital filters that can be applied to a channel, see FilterProcessor.
+enum class FilterType : int {
+    OFF,      ///< The channel is not filtered
+    LOWPASS,  ///< Passes the frequencies below the cutoff frequency
+    HIGHPASS, ///< Passes the frequencies above the cutoff frequency
+    BANDPASS, ///< Passes the band around the center frequency
+    NOTCH     ///< Removes the band around the center frequency
+};
+extern Enum<Dso::FilterType, Dso::FilterType::OFF, Dso::FilterType::NOTCH> FilterTypeEnum;
+
+/// \enum FilterDesign
+/// \brief How the coefficients of a digital filter are designed.
+enum class FilterDesign : int {
+    IIR, ///< Butterworth response, cascaded biquads
+    FIR  ///< Blackman windowed sinc, linear phase
+};
+extern Enum<Dso::FilterDesign, Dso::FilterDesign::IIR, Dso::FilterDesign::FIR> FilterDesignEnum;
+
 QString mathModeString(MathMode mode);
 QString windowFunctionString(WindowFunction window);
+QString spectrumAveragingString(SpectrumAveraging averaging);
+QString filterTypeString(FilterType type);
+QString filterDesignString(FilterDesign design);
 }
 
 Q_DECLARE_METATYPE(Dso::MathMode)
 Q_DECLARE_METATYPE(Dso::WindowFunction)
+Q_DECLARE_METATYPE(Dso::SpectrumAveraging)
+Q_DECLARE_METATYPE(Dso::FilterType)
+Q_DECLARE_METATYPE(Dso::FilterDesign)
+
+/// \brief Holds the digital filter of one channel.
+struct DsoSettingsFilter {
+    Dso::FilterType type = Dso::FilterType::OFF;        ///< Response of the filter
+    Dso::FilterDesign design = Dso::FilterDesign::IIR; ///< FIR or IIR implementation
+    double frequency = 50.0;                           ///< Cutoff or center frequency in Hz
+    double bandwidth = 10.0;                           ///< Width of the pass or stop band in Hz
+    unsigned order = 4;                                ///< Order of the Butterworth filter (IIR)
+    unsigned taps = 255;                               ///< Number of coefficients (FIR), odd
+
+    bool operator==(const DsoSettingsFilter &other) const {
+        return type == other.type && design == other.design && frequency == other.frequency &&
+               bandwidth == other.bandwidth && order == other.order && taps == other.taps;
+    }
+    bool operator!=(const DsoSettingsFilter &other) const { return !(*this == other); }
+};
 
 struct DsoSettingsPostProcessing {
     Dso::WindowFunction spectrumWindow = Dso::WindowFunction::HANN; ///< Window function for DFT
     double spectrumReference = 0.0;                                 ///< Reference level for spectrum in dBm
-    double spectrumLimit = -20.0; ///< Minimum magnitude of the spectrum (Avoids peaks)
+    double spectrumLimit = -20.0;        ///< Minimum magnitude of the spectrum (Avoids peaks)
+    bool spectrumSinglePrecision = true; ///< Calculate the DFT in single precision if fftw3f is available
+    unsigned spectrumThreads = 1;        ///< Number of FFTW threads for long records if fftw3_threads is available
+    unsigned spectrumSegmentLength = 0;  ///< Length of the overlapping DFT segments, 0 for the whole record
+    double spectrumOverlap = 0.5;        ///< Overlap of consecutive DFT segments (0 .. <1)
+    Dso::SpectrumAveraging spectrumAveraging = Dso::SpectrumAveraging::RMS; ///< Combination of segments/frames
+    unsigned spectrumFrames = 1;         ///< Number of frames the RMS spectrum is averaged over
+    bool spectrumZoom = false;           ///< Only analyze the samples between the markers
+    unsigned spectrumDecimation = 1;     ///< Decimation factor before the DFT, 1 to disable
+    bool spectrogram = false;            ///< Show the spectrum history as waterfall
+    unsigned spectrogramRows = 256;      ///< Number of frames the waterfall spans
+    bool envelope = false;               ///< Accumulate a min/max envelope of the voltage graphs
+    unsigned envelopeFrames = 0;         ///< Number of frames the envelope spans, 0 for unlimited
+    QString mathExpression = "CH1 * CH2"; ///< Formula of the math channel in Dso::MathMode::EXPRESSION
+    /// Guards mathExpression: It is assigned in the GUI thread and copied in the post processing thread.
+    /// Reading it in the GUI thread doesn't need the lock.
+    mutable QMutex mathExpressionMutex;
+    std::vector<DsoSettingsFilter> filter; ///< Digital filter of every voltage channel (including math)
 };
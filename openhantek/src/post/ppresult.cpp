@@ -19,6 +19,7 @@ unsigned int PPresult::sampleCount() const { return (unsigned)analyzedData[0].vo
 unsigned int PPresult::channelCount() const { return (unsigned)analyzedData.size(); }
 
 double DataChannel::computeAmplitude() const {
+    if (measurements.valid) return measurements.peakToPeak();
     if (voltage.sample.empty()) return 0.0;
     double minimalVoltage, maximalVoltage;
     minimalVoltage = maximalVoltage = voltage.sample[0];
@@ -5,21 +5,51 @@
 #include <QVector3D>
 #include <QReadWriteLock>
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include "hantekprotocol/types.h"
 
+class Spectrogram;
+
 /// \brief Struct for a array of sample values.
 struct SampleValues {
     std::vector<double> sample; ///< Vector holding the sampling data
     double interval = 0.0;      ///< The interval between two sample values
 };
 
+/// \brief Automatic measurements of a voltage channel, filled in by the MeasurementGenerator.
+struct Measurements {
+    bool valid = false;     ///< true if the values below have been computed for this frame
+    double minimum = 0.0;   ///< Lowest voltage (V)
+    double maximum = 0.0;   ///< Highest voltage (V)
+    double mean = 0.0;      ///< Arithmetic mean, the DC component (V)
+    double rms = 0.0;       ///< Root mean square (V)
+    double acRms = 0.0;     ///< Root mean square without the DC component (V)
+    double top = 0.0;       ///< Most common high level (V)
+    double base = 0.0;      ///< Most common low level (V)
+    double overshoot = 0.0; ///< Overshoot above the top level relative to top - base (%)
+    double riseTime = 0.0;  ///< Average 10% to 90% rise time (s), 0 if no rising edge was found
+    double fallTime = 0.0;  ///< Average 90% to 10% fall time (s), 0 if no falling edge was found
+    double dutyCycle = 0.0; ///< High time relative to the period (%), 0 if unknown
+    double period = 0.0;    ///< Average period (s), 0 if less than two rising edges were found
+    double frequency = 0.0; ///< The inverse of the period (Hz), 0 if unknown
+
+    double peakToPeak() const { return maximum - minimum; }
+    double amplitude() const { return top - base; }
+};
+
 /// \brief Struct for the analyzed data.
 struct DataChannel {
     SampleValues voltage;   ///< The time-domain voltage levels (V)
     SampleValues spectrum;  ///< The frequency-domain power levels (dB)
+    SampleValues envelopeMin; ///< Lowest voltage level per sample position over the accumulated frames (V)
+    SampleValues envelopeMax; ///< Highest voltage level per sample position over the accumulated frames (V)
+    std::vector<uint8_t> spectrogramRow;              ///< Newest waterfall row, see Spectrogram
+    std::shared_ptr<const Spectrogram> spectrogram; ///< Waterfall history, shared with the SpectrogramGenerator
 
     double frequency = 0.0; ///< The frequency of the signal
+    Measurements measurements; ///< Automatic measurements of the voltage levels
     // Calculate peak-to-peak voltage
     double computeAmplitude() const;
 };
@@ -42,10 +72,17 @@ class PPresult {
     unsigned int sampleCount() const;
     unsigned int channelCount() const;
 
+    bool append = false; ///< true if the samples continue the previous frame (roll mode)
+    int64_t timestamp = 0; ///< Host time of the first sample in ns since the epoch, see hostTimestamp()
+
     bool softwareTriggerTriggered = false;
+    unsigned preTrigSamples = 0;  ///< Software trigger: Samples shown before the trigger point
+    unsigned postTrigSamples = 0; ///< Software trigger: End of the range that has been searched for the trigger point
+    unsigned swTriggerStart = 0;  ///< Software trigger: Position of the trigger point, see SoftwareTrigger
 
     ChannelsGraphs vaChannelSpectrum;
     ChannelsGraphs vaChannelVoltage;
+    ChannelsGraphs vaChannelEnvelope; ///< Triangle strips with alternating max/min vertices
   private:
     std::vector<DataChannel> analyzedData; ///< The analyzed data for each channel
 };
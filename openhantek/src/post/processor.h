@@ -4,5 +4,6 @@
 
 class Processor {
 public:
+    virtual ~Processor() {}
     virtual void process(PPresult*) = 0;
 };
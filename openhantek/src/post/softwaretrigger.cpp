@@ -1,25 +1,302 @@
+#include <algorithm>
+#include <limits>
+
 #include "post/softwaretrigger.h"
 #include "post/ppresult.h"
 #include "scopesettings.h"
 #include "viewconstants.h"
 #include "utils/printutils.h"
 
-SoftwareTrigger::PrePostStartTriggerSamples SoftwareTrigger::compute(const PPresult *data,
-                                                                              const DsoSettingsScope *scope)
-{
-    unsigned int preTrigSamples = 0;
-    unsigned int postTrigSamples = 0;
-    unsigned int swTriggerStart = 0;
-    ChannelID channel = scope->trigger.source;
+/// Number of samples that are checked at once by the branch-free loops of the edge search.
+static const unsigned BLOCK = 32;
+
+/// \brief Slope policy for rising edges: Armed at or below the arm level, triggered above the trigger level.
+struct RisingSlope {
+    static inline double armLevel(double level, double hysteresis) { return level - hysteresis; }
+    static inline bool armed(double value, double arm) { return value <= arm; }
+    static inline bool beyond(double value, double level) { return value > level; }
+};
+
+/// \brief Slope policy for falling edges: Armed at or above the arm level, triggered below the trigger level.
+struct FallingSlope {
+    static inline double armLevel(double level, double hysteresis) { return level + hysteresis; }
+    static inline bool armed(double value, double arm) { return value >= arm; }
+    static inline bool beyond(double value, double level) { return value < level; }
+};
+
+/// \brief Number of samples in [begin, end) that are beyond the given level. Branch-free, so it is vectorized.
+template <class Slope> static unsigned countBeyond(const double *samples, size_t begin, size_t end, double level) {
+    unsigned count = 0;
+    for (size_t position = begin; position < end; ++position) count += Slope::beyond(samples[position], level);
+    return count;
+}
+
+/// \brief Number of arming samples in [begin, end). Branch-free, so it is vectorized.
+template <class Slope> static unsigned countArmed(const double *samples, size_t begin, size_t end, double arm) {
+    unsigned count = 0;
+    for (size_t position = begin; position < end; ++position) count += Slope::armed(samples[position], arm);
+    return count;
+}
+
+/// \brief Prefix count of the samples beyond the trigger level.
+/// The edge search only asks for monotonically increasing positions, so the prefix sum is extended on demand
+/// instead of being stored for the whole record.
+template <class Slope> class PrefixCount {
+  public:
+    PrefixCount(const double *samples, double level, size_t begin) : samples(samples), level(level), end(begin) {}
+    /// \return Number of samples beyond the level in [begin, position).
+    unsigned at(size_t position) {
+        count += countBeyond<Slope>(samples, end, position, level);
+        end = position;
+        return count;
+    }
+
+  private:
+    const double *samples;
+    double level;
+    size_t end;
+    unsigned count = 0;
+};
+
+/// States of the stream state machines.
+enum : unsigned {
+    UNKNOWN = 0, ///< Not yet on a defined side of the levels (also: edge trigger disarmed)
+    IDLE,        ///< On the idle side of the trigger level, i.e. armed
+    ACTIVE,      ///< Beyond the trigger level (pulse, runt, timeout) or inside the window
+    COMPLETE     ///< The pulse reached the second level (runt) or the timeout has been reported
+};
+
+/// \brief Levels and limits of the trigger state machines in units of volts and samples.
+struct TriggerParameters {
+    double level;          ///< Trigger level
+    double second;         ///< Second level of runt and window triggers
+    double hysteresis;     ///< Distance of the arm level from the trigger level
+    double minimumWidth;   ///< Shortest accepted pulse width or the timeout
+    double maximumWidth;   ///< Longest accepted pulse width
+    unsigned sampleSet;    ///< Length of the edge check window
+    unsigned threshold;    ///< Samples within the edge check window that have to be beyond the level
+};
+
+/// \brief Searches the first edge in [begin, end) that passes the hysteresis and the sample set check.
+/// The signal has to reach the arm level before a sample beyond the trigger level counts as edge. An edge is
+/// accepted if more than `threshold` of the following `sampleSet - 1` samples are beyond the trigger level,
+/// which is answered in constant time by the difference of two prefix counts.
+/// \return The position of the edge or `end` if there is none.
+template <class Slope>
+static size_t findEdge(const double *samples, size_t begin, size_t end, size_t sampleCount,
+                       const TriggerParameters &p, SoftwareTrigger::Stream &stream) {
+    const double arm = Slope::armLevel(p.level, p.hysteresis);
+    PrefixCount<Slope> windowStart(samples, p.level, begin);
+    PrefixCount<Slope> windowEnd(samples, p.level, begin);
+    bool isArmed = stream.state == IDLE;
+
+    for (size_t block = begin; block < end; block += BLOCK) {
+        const size_t blockEnd = std::min(block + BLOCK, end);
+        // Skip blocks that can not change the state: Only an arming sample matters while disarmed and only a
+        // sample beyond the level while armed.
+        if (isArmed ? !countBeyond<Slope>(samples, block, blockEnd, p.level)
+                    : !countArmed<Slope>(samples, block, blockEnd, arm))
+            continue;
+
+        for (size_t position = block; position < blockEnd; ++position) {
+            const double value = samples[position];
+            if (!isArmed) {
+                isArmed = Slope::armed(value, arm);
+            } else if (Slope::beyond(value, p.level)) {
+                isArmed = false;
+                const size_t windowLast = std::min(position + p.sampleSet, sampleCount);
+                if (position + 1 >= windowLast) continue;
+                const unsigned count = windowEnd.at(windowLast) - windowStart.at(position + 1);
+                if (count > p.threshold) {
+                    stream.state = UNKNOWN;
+                    return position;
+                }
+            }
+        }
+    }
+    stream.state = isArmed ? IDLE : UNKNOWN;
+    return end;
+}
+
+/// \brief Pulse width trigger: A pulse starts with the (armed) crossing of the trigger level and ends when the
+/// signal is back at the arm level. The event is the end of a pulse whose width is within the limits.
+template <class Slope>
+static size_t findPulse(const double *samples, size_t begin, size_t end, const TriggerParameters &p,
+                        SoftwareTrigger::Stream &stream) {
+    const double arm = Slope::armLevel(p.level, p.hysteresis);
+    for (size_t position = begin; position < end; ++position) {
+        const double value = samples[position];
+        if (stream.state == ACTIVE) {
+            if (!Slope::armed(value, arm)) continue;
+            stream.state = IDLE;
+            const double width = (double)(stream.offset + position - stream.mark);
+            if (width >= p.minimumWidth && width <= p.maximumWidth) return position;
+        } else if (stream.state == IDLE && Slope::beyond(value, p.level)) {
+            stream.state = ACTIVE;
+            stream.mark = stream.offset + position;
+        } else if (Slope::armed(value, arm))
+            stream.state = IDLE;
+    }
+    return end;
+}
+
+/// \brief Runt trigger: A pulse passes the trigger level but returns to the arm level without reaching the
+/// second level. The event is the end of the runt pulse.
+template <class Slope>
+static size_t findRunt(const double *samples, size_t begin, size_t end, const TriggerParameters &p,
+                       SoftwareTrigger::Stream &stream) {
+    const double arm = Slope::armLevel(p.level, p.hysteresis);
+    for (size_t position = begin; position < end; ++position) {
+        const double value = samples[position];
+        if (Slope::armed(value, arm)) {
+            const bool runt = stream.state == ACTIVE;
+            stream.state = IDLE;
+            if (runt) return position;
+        } else if (stream.state == ACTIVE && Slope::beyond(value, p.second))
+            stream.state = COMPLETE;
+        else if (stream.state == IDLE && Slope::beyond(value, p.level))
+            stream.state = ACTIVE;
+    }
+    return end;
+}
+
+/// \brief Window trigger: The event is the first sample inside (enter) or outside (exit) of the band between
+/// the two levels. The hysteresis has to be passed in both directions.
+static size_t findWindow(const double *samples, size_t begin, size_t end, const TriggerParameters &p, bool enter,
+                         SoftwareTrigger::Stream &stream) {
+    const double low = std::min(p.level, p.second);
+    const double high = std::max(p.level, p.second);
+    const double hysteresis = std::min(p.hysteresis, (high - low) / 4);
+    for (size_t position = begin; position < end; ++position) {
+        const double value = samples[position];
+        if (stream.state != ACTIVE && value >= low + hysteresis && value <= high - hysteresis) {
+            const bool event = enter && stream.state == IDLE;
+            stream.state = ACTIVE;
+            if (event) return position;
+        } else if (stream.state != IDLE && (value < low - hysteresis || value > high + hysteresis)) {
+            const bool event = !enter && stream.state == ACTIVE;
+            stream.state = IDLE;
+            if (event) return position;
+        }
+    }
+    return end;
+}
+
+/// \brief Timeout trigger: The signal stays beyond the trigger level for longer than the timeout. The event is
+/// the sample at which the timeout expires, it is reported once until the signal returns to the arm level.
+template <class Slope>
+static size_t findTimeout(const double *samples, size_t begin, size_t end, const TriggerParameters &p,
+                          SoftwareTrigger::Stream &stream) {
+    const double arm = Slope::armLevel(p.level, p.hysteresis);
+    for (size_t position = begin; position < end; ++position) {
+        const double value = samples[position];
+        if (Slope::armed(value, arm))
+            stream.state = IDLE;
+        else if (stream.state == ACTIVE) {
+            if ((double)(stream.offset + position - stream.mark) >= p.minimumWidth) {
+                stream.state = COMPLETE;
+                return position;
+            }
+        } else if (stream.state != COMPLETE && Slope::beyond(value, p.level)) {
+            stream.state = ACTIVE;
+            stream.mark = stream.offset + position;
+        }
+    }
+    return end;
+}
+
+/// \brief Runs the state machine of the given trigger type.
+template <class Slope>
+static size_t findEvent(const std::vector<double> &samples, size_t begin, size_t end, const TriggerParameters &p,
+                        const DsoSettingsScopeTrigger &trigger, SoftwareTrigger::Stream &stream) {
+    switch (trigger.swTriggerType) {
+    case Dso::TriggerType::Edge:
+        return findEdge<Slope>(samples.data(), begin, end, samples.size(), p, stream);
+    case Dso::TriggerType::PulseWidth:
+        return findPulse<Slope>(samples.data(), begin, end, p, stream);
+    case Dso::TriggerType::Runt:
+        return findRunt<Slope>(samples.data(), begin, end, p, stream);
+    case Dso::TriggerType::Window:
+        return findWindow(samples.data(), begin, end, p, trigger.swTriggerWindowCondition == Dso::WindowCondition::Enter,
+                          stream);
+    case Dso::TriggerType::Timeout:
+        return findTimeout<Slope>(samples.data(), begin, end, p, stream);
+    }
+    return end;
+}
+
+SoftwareTrigger::SoftwareTrigger(const DsoSettingsScope *scope, bool isSoftwareTriggerDevice)
+    : scope(scope), isSoftwareTriggerDevice(isSoftwareTriggerDevice) {}
+
+size_t SoftwareTrigger::scan(const std::vector<double> &samples, size_t begin, size_t end, double interval) {
+    const DsoSettingsScopeTrigger &trigger = scope->trigger;
+    const ChannelID channel = trigger.source;
+
+    TriggerParameters p;
+    p.level = scope->voltage[channel].trigger;
+    p.second = trigger.swTriggerLevelUpper;
+    p.hysteresis = trigger.swTriggerHysteresis * scope->gain(channel);
+    p.sampleSet = trigger.swTriggerSampleSet;
+    p.threshold = trigger.swTriggerThreshold;
+    p.minimumWidth = 0.0;
+    p.maximumWidth = std::numeric_limits<double>::infinity();
+    const double time = trigger.swTriggerTime / interval;
+    if (trigger.swTriggerType == Dso::TriggerType::Timeout ||
+        trigger.swTriggerPulseCondition == Dso::PulseCondition::Longer)
+        p.minimumWidth = time;
+    else if (trigger.swTriggerPulseCondition == Dso::PulseCondition::Shorter)
+        p.maximumWidth = time;
+    else {
+        p.minimumWidth = time;
+        p.maximumWidth = trigger.swTriggerTimeUpper / interval;
+    }
+    // The runt pulse starts at the level that is passed first
+    if (trigger.swTriggerType == Dso::TriggerType::Runt && (p.second < p.level) == (trigger.slope == Dso::Slope::Positive))
+        std::swap(p.level, p.second);
+
+    if (trigger.slope == Dso::Slope::Positive) return findEvent<RisingSlope>(samples, begin, end, p, trigger, stream);
+    return findEvent<FallingSlope>(samples, begin, end, p, trigger, stream);
+}
+
+void SoftwareTrigger::process(PPresult *result) {
+    result->preTrigSamples = 0;
+    result->postTrigSamples = 0;
+    result->swTriggerStart = 0;
+    result->softwareTriggerTriggered = false;
+    if (!isSoftwareTriggerDevice) return;
+
+    const ChannelID channel = scope->trigger.source;
 
     // Trigger channel not in use
-    if (!scope->voltage[channel].used || !data->data(channel) ||
-            data->data(channel)->voltage.sample.empty())
-        return PrePostStartTriggerSamples(preTrigSamples, postTrigSamples, swTriggerStart);
+    if (scope->trigger.special || channel >= result->channelCount() || !scope->voltage[channel].used ||
+        !result->data(channel) || result->data(channel)->voltage.sample.empty()) {
+        stream = Stream();
+        return;
+    }
 
-    const std::vector<double>& samples = data->data(channel)->voltage.sample;
-    double level = scope->voltage[channel].trigger;
+    // Every frame is a new record, unless it continues the previous one (roll mode)
+    if (!result->append || stream.type != scope->trigger.swTriggerType || stream.slope != scope->trigger.slope ||
+        stream.channel != channel) {
+        stream = Stream();
+        stream.type = scope->trigger.swTriggerType;
+        stream.slope = scope->trigger.slope;
+        stream.channel = channel;
+    }
+
+    const std::vector<double> &samples = result->data(channel)->voltage.sample;
+    const double interval = result->data(channel)->voltage.interval;
     size_t sampleCount = samples.size();
+
+    if (result->append) {
+        // Roll mode: The frames are shown as they arrive, so there is nothing to align. The whole frame
+        // runs through the state machine to keep it in sync and a trigger event is only reported.
+        size_t position = scan(samples, 0, sampleCount, interval);
+        result->softwareTriggerTriggered = position < sampleCount;
+        while (position < sampleCount) position = scan(samples, position + 1, sampleCount, interval);
+        stream.offset += sampleCount;
+        return;
+    }
+
     double timeDisplay = scope->horizontal.timebase * DIVS_TIME;
     double samplesDisplay = timeDisplay * scope->horizontal.samplerate;
 
@@ -32,42 +309,23 @@ SoftwareTrigger::PrePostStartTriggerSamples SoftwareTrigger::compute(const PPres
         // For now #3 is chosen
         timestampDebug(QString("Too few samples to make a steady "
                                "picture. Decrease sample rate"));
-        return PrePostStartTriggerSamples(preTrigSamples, postTrigSamples, swTriggerStart);
-    }
-    preTrigSamples = (unsigned)(scope->trigger.position * samplesDisplay);
-    postTrigSamples = (unsigned)sampleCount - ((unsigned)samplesDisplay - preTrigSamples);
-
-    double prev;
-    bool (*opcmp)(double,double,double);
-    bool (*smplcmp)(double,double);
-    if (scope->trigger.slope == Dso::Slope::Positive) {
-        prev = INT_MAX;
-        opcmp = [](double value, double level, double prev) { return value > level && prev <= level;};
-        smplcmp = [](double sampleK, double value) { return sampleK >= value;};
-    } else {
-        prev = INT_MIN;
-        opcmp = [](double value, double level, double prev) { return value < level && prev >= level;};
-        smplcmp = [](double sampleK, double value) { return sampleK < value;};
+        return;
     }
+    unsigned preTrigSamples = (unsigned)(scope->trigger.position * samplesDisplay);
+    unsigned postTrigSamples = (unsigned)sampleCount - ((unsigned)samplesDisplay - preTrigSamples);
 
-    for (unsigned int i = preTrigSamples; i < postTrigSamples; i++) {
-        double value = samples[i];
-        if (opcmp(value, level, prev)) {
-            unsigned rising = 0;
-            for (unsigned int k = i + 1; k < i + scope->trigger.swTriggerSampleSet && k < sampleCount; k++) {
-                if (smplcmp(samples[k], value)) { rising++; }
-            }
-            if (rising > scope->trigger.swTriggerThreshold) {
-                swTriggerStart = i;
-                break;
-            }
-        }
-        prev = value;
-    }
-    if (swTriggerStart == 0) {
+    // The edge search starts at the first possible trigger point, all other state machines have to see the
+    // beginning of the event (e.g. the start of a pulse) as well.
+    size_t begin = scope->trigger.swTriggerType == Dso::TriggerType::Edge ? preTrigSamples : 0;
+    size_t position = scan(samples, begin, postTrigSamples, interval);
+    while (position < preTrigSamples) position = scan(samples, position + 1, postTrigSamples, interval);
+
+    if (position >= postTrigSamples) {
         timestampDebug(QString("Trigger not asserted. Data ignored"));
-        preTrigSamples = 0; // preTrigSamples may never be greater than swTriggerStart
-        postTrigSamples = 0;
+        return;
     }
-    return PrePostStartTriggerSamples(preTrigSamples, postTrigSamples, swTriggerStart);
+    result->preTrigSamples = preTrigSamples;
+    result->postTrigSamples = postTrigSamples;
+    result->swTriggerStart = (unsigned)position;
+    result->softwareTriggerTriggered = postTrigSamples > preTrigSamples;
 }
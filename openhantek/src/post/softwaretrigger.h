@@ -1,22 +1,50 @@
 #pragma once
-#include <tuple>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "hantekdso/enums.h"
+#include "hantekprotocol/types.h"
+#include "processor.h"
+
 struct DsoSettingsScope;
 class PPresult;
 
 
 /**
- * Contains software trigger algorithms. At the moment this works on the analysed data of the
- * DataAnalyser class.
+ * Contains software trigger algorithms. This works on the post processed data, so every channel that has
+ * been computed by an earlier processor (e.g. the math channel) can be the trigger source.
+ * Determines the trigger point of software trigger devices once per frame and stores it in the
+ * PPresult (PPresult::preTrigSamples, PPresult::postTrigSamples, PPresult::swTriggerStart).
+ * Besides edges, pulse width, runt, window and timeout events are detected by single pass state
+ * machines. In roll mode their state is kept across frames, so events that span a frame boundary are found.
  * TODO Should work on the raw data within HantekDsoControl
  */
-class SoftwareTrigger {
+class SoftwareTrigger : public Processor {
   public:
-    typedef std::tuple<unsigned, unsigned, unsigned> PrePostStartTriggerSamples;
+    /// \brief State of the trigger state machines, kept between the frames of a stream (roll mode).
+    struct Stream {
+        unsigned state = 0;    ///< State of the active state machine, 0 is always "unknown"
+        uint64_t offset = 0;   ///< Stream index of the first sample of the current frame
+        uint64_t mark = 0;     ///< Stream index of the last relevant state change (e.g. pulse start)
+        Dso::TriggerType type = Dso::TriggerType::Edge;
+        Dso::Slope slope = Dso::Slope::Positive;
+        ChannelID channel = 0;
+    };
+
+    SoftwareTrigger(const DsoSettingsScope *scope, bool isSoftwareTriggerDevice);
     /**
-     * @brief Computes a software trigger point.
-     * @param data Analysed data from the
-     * @param scope Scope settings
-     * @return Returns a tuple of positions [preTrigger, postTrigger, startTrigger]
+     * @brief Computes the software trigger point of the result.
+     * @param result Analysed data, the trigger point is stored in there
      */
-    static PrePostStartTriggerSamples compute(const PPresult *data, const DsoSettingsScope *scope);
+    virtual void process(PPresult *result) override;
+
+  private:
+    /// \brief Runs the state machine of the configured trigger type over [begin, end).
+    /// \return The position of the first trigger event or `end` if there is none.
+    size_t scan(const std::vector<double> &samples, size_t begin, size_t end, double interval);
+
+    const DsoSettingsScope *scope;
+    const bool isSoftwareTriggerDevice;
+    Stream stream;
 };
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include <algorithm>
+
+#include <QMutexLocker>
+
+#include "spectrogram.h"
+
+Spectrogram::Spectrogram(unsigned rows) : rowCount(std::max(rows, 1u)), data(rowCount * WIDTH, 0) {}
+
+void Spectrogram::addRow(const std::vector<uint8_t> &row) {
+    QMutexLocker locker(&mutex);
+    std::copy_n(row.begin(), std::min<size_t>(row.size(), WIDTH), data.begin() + writeIndex * WIDTH);
+    writeIndex = (writeIndex + 1) % rowCount;
+    filledRows = std::min(filledRows + 1, rowCount);
+}
+
+QImage Spectrogram::toImage(const QColor &color) const {
+    QImage image((int)WIDTH, (int)rowCount, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+
+    QMutexLocker locker(&mutex);
+    const QRgb rgb = color.rgb() & RGB_MASK;
+    for (unsigned line = 0; line < filledRows; ++line) {
+        // Line 0 is the newest row
+        const unsigned row = (writeIndex + rowCount - 1 - line) % rowCount;
+        const uint8_t *intensities = data.data() + row * WIDTH;
+        QRgb *pixels = reinterpret_cast<QRgb *>(image.scanLine((int)line));
+        for (unsigned column = 0; column < WIDTH; ++column)
+            pixels[column] = rgb | (QRgb)(color.alpha() * intensities[column] / 255) << 24;
+    }
+    return image;
+}
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <QColor>
+#include <QImage>
+#include <QMutex>
+
+/// \brief Rolling history of spectrum rows for the waterfall display.
+/// Every row holds Spectrogram::WIDTH intensities (0 .. 255) over the displayed frequency span. The ring
+/// is written by the SpectrogramGenerator and read by the exporters. The GlScope keeps its own copy on the
+/// GPU and only uploads the newest row (DataChannel::spectrogramRow) per frame.
+class Spectrogram {
+  public:
+    static const unsigned WIDTH = 1024; ///< Number of columns (frequency bins) per row
+
+    explicit Spectrogram(unsigned rows);
+
+    /// \brief Replaces the oldest row.
+    /// \param row The new row with WIDTH intensities.
+    void addRow(const std::vector<uint8_t> &row);
+
+    /// \return The number of rows the ring can hold.
+    unsigned rows() const { return rowCount; }
+
+    /// \brief Renders the history, the newest row on top. This is the CPU fallback used for exports.
+    /// \param color The color of the highest intensity, lower intensities are more transparent.
+    QImage toImage(const QColor &color) const;
+
+  private:
+    mutable QMutex mutex;
+    const unsigned rowCount;
+    std::vector<uint8_t> data; ///< rowCount rows with WIDTH intensities each
+    unsigned writeIndex = 0;   ///< Row that is overwritten next
+    unsigned filledRows = 0;   ///< Number of rows written so far, up to rowCount
+};
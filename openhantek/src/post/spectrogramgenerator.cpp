@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include <algorithm>
+
+#include "spectrogramgenerator.h"
+
+#include "postprocessingsettings.h"
+#include "ppresult.h"
+#include "scopesettings.h"
+#include "viewconstants.h"
+
+SpectrogramGenerator::SpectrogramGenerator(const DsoSettingsScope *scope,
+                                           const DsoSettingsPostProcessing *postprocessing)
+    : scope(scope), postprocessing(postprocessing) {}
+
+void SpectrogramGenerator::process(PPresult *result) {
+    if (!postprocessing->spectrogram || scope->horizontal.format != Dso::GraphFormat::TY) {
+        spectrograms.clear();
+        return;
+    }
+    spectrograms.resize(result->channelCount());
+
+    for (ChannelID channel = 0; channel < result->channelCount(); ++channel) {
+        DataChannel *const channelData = result->modifyData(channel);
+        const SampleValues &spectrum = channelData->spectrum;
+
+        if (!scope->spectrum[channel].used || spectrum.sample.empty() || spectrum.interval <= 0) {
+            spectrograms[channel].reset();
+            continue;
+        }
+
+        std::shared_ptr<Spectrogram> &spectrogram = spectrograms[channel];
+        if (!spectrogram || spectrogram->rows() != postprocessing->spectrogramRows)
+            spectrogram = std::make_shared<Spectrogram>(postprocessing->spectrogramRows);
+
+        // Same horizontal mapping as the spectrum graph: x = bin * interval / frequencybase - DIVS_TIME / 2
+        const double binsPerColumn =
+            DIVS_TIME * scope->horizontal.frequencybase / spectrum.interval / Spectrogram::WIDTH;
+        const double magnitude = scope->spectrum[channel].magnitude;
+        const double offset = scope->spectrum[channel].offset;
+        const size_t binCount = spectrum.sample.size();
+
+        std::vector<uint8_t> &row = channelData->spectrogramRow;
+        row.resize(Spectrogram::WIDTH);
+        for (unsigned column = 0; column < Spectrogram::WIDTH; ++column) {
+            const size_t first = (size_t)(column * binsPerColumn);
+            if (first >= binCount) {
+                row[column] = 0;
+                continue;
+            }
+            const size_t last = std::min(std::max(first + 1, (size_t)((column + 1) * binsPerColumn)), binCount);
+            const double peak = *std::max_element(spectrum.sample.begin() + first, spectrum.sample.begin() + last);
+
+            // Bottom of the screen is 0, top is 255
+            const double position = (peak / magnitude + offset) / DIVS_VOLTAGE + 0.5;
+            row[column] = (uint8_t)(std::min(std::max(position, 0.0), 1.0) * 255 + 0.5);
+        }
+
+        spectrogram->addRow(row);
+        channelData->spectrogram = spectrogram;
+    }
+}
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "processor.h"
+#include "spectrogram.h"
+
+struct DsoSettingsScope;
+struct DsoSettingsPostProcessing;
+
+/// \brief Appends the spectrum of every frame as one row to the waterfall history of its channel.
+/// The spectrum is resampled to Spectrogram::WIDTH columns over the displayed frequency span (keeping
+/// the highest bin per column) and its magnitude is scaled like the spectrum graph, so that the bottom
+/// of the screen is transparent and the top is opaque. The row is published in DataChannel::spectrogramRow
+/// and the history in DataChannel::spectrogram.
+class SpectrogramGenerator : public Processor {
+  public:
+    SpectrogramGenerator(const DsoSettingsScope *scope, const DsoSettingsPostProcessing *postprocessing);
+    virtual void process(PPresult *result) override;
+
+  private:
+    const DsoSettingsScope *scope;
+    const DsoSettingsPostProcessing *postprocessing;
+    std::vector<std::shared_ptr<Spectrogram>> spectrograms;
+};
@@ -1,227 +1,274 @@
 // SPDX-License-Identifier: GPL-2.0+
 
 #define _USE_MATH_DEFINES
+#include <algorithm>
 #include <cmath>
 
-#include <QColor>
-#include <QMutex>
-#include <QTimer>
-
 #include <fftw3.h>
 
 #include "spectrumgenerator.h"
+#include "fftwplanner.h"
+
+#include "scopesettings.h"
+#include "viewconstants.h"
+
+/// Minimum record length that is transformed with more than one thread.
+static const unsigned THREADS_MIN_LENGTH = 1 << 16;
+
+/// \brief Applies the window to the samples.
+template <typename T> static void applyWindow(T *output, const T *window, const double *samples, unsigned count) {
+    for (unsigned position = 0; position < count; ++position)
+        output[position] = window[position] * (T)samples[position];
+}
+
+/// \brief Adds the power of the complex DFT bins to the given power spectrum or keeps the maximum of both.
+template <typename T> static void accumulatePower(double *power, const T (*bins)[2], unsigned count, bool peak) {
+    for (unsigned position = 0; position < count; ++position) {
+        const double value = bins[position][0] * bins[position][0] + bins[position][1] * bins[position][1];
+        if (peak)
+            power[position] = value > power[position] ? value : power[position];
+        else
+            power[position] += value;
+    }
+}
 
-#include "glscope.h"
-#include "settings.h"
-#include "utils/printutils.h"
+/// \brief Converts a power spectrum into magnitudes in dB.
+static void toDecibel(double *output, const double *power, unsigned count, double offset, double offsetLimit) {
+    for (unsigned position = 0; position < count; ++position) {
+        const double value = 10 * log10(power[position]) + offset;
+        output[position] = value > offsetLimit ? value : offsetLimit;
+    }
+}
 
 /// \brief Analyzes the data from the dso.
-SpectrumGenerator::SpectrumGenerator(const DsoSettingsScope *scope, const DsoSettingsPostProcessing *postprocessing)
-    : scope(scope), postprocessing(postprocessing) {}
+SpectrumGenerator::SpectrumGenerator(const DsoSettingsScope *scope, const DsoSettingsPostProcessing *postprocessing,
+                                     WindowCache *windowCache, bool isSoftwareTriggerDevice)
+    : scope(scope), postprocessing(postprocessing), windowCache(windowCache),
+      isSoftwareTriggerDevice(isSoftwareTriggerDevice) {
+#ifdef HAVE_FFTW_THREADS
+    QMutexLocker plannerLock(&fftwPlannerMutex());
+    fftw_init_threads();
+    fftwf_init_threads();
+#endif
+}
 
-SpectrumGenerator::~SpectrumGenerator() {
-    if (lastWindowBuffer) fftw_free(lastWindowBuffer);
+SpectrumGenerator::~SpectrumGenerator() { destroyPlan(); }
+
+void SpectrumGenerator::destroyPlan() {
+    QMutexLocker plannerLock(&fftwPlannerMutex());
+    if (plan) fftw_destroy_plan(plan);
+    if (realBuffer) fftw_free(realBuffer);
+    if (complexBuffer) fftw_free(complexBuffer);
+    plan = nullptr;
+    realBuffer = nullptr;
+    complexBuffer = nullptr;
+#ifdef HAVE_FFTW_FLOAT
+    if (floatPlan) fftwf_destroy_plan(floatPlan);
+    if (floatRealBuffer) fftwf_free(floatRealBuffer);
+    if (floatComplexBuffer) fftwf_free(floatComplexBuffer);
+    floatPlan = nullptr;
+    floatRealBuffer = nullptr;
+    floatComplexBuffer = nullptr;
+#endif
+    planLength = 0;
+}
+
+void SpectrumGenerator::updatePlan(unsigned sampleCount, bool singlePrecision, unsigned threads) {
+#ifndef HAVE_FFTW_FLOAT
+    singlePrecision = false;
+#endif
+#ifndef HAVE_FFTW_THREADS
+    threads = 1;
+#endif
+    if (threads < 1 || sampleCount < THREADS_MIN_LENGTH) threads = 1;
+    if (planLength == sampleCount && planSinglePrecision == singlePrecision && planThreads == threads) return;
+    destroyPlan();
+
+    QMutexLocker plannerLock(&fftwPlannerMutex());
+    const unsigned binCount = sampleCount / 2 + 1;
+    if (!singlePrecision) {
+        realBuffer = fftw_alloc_real(sampleCount);
+        complexBuffer = fftw_alloc_complex(binCount);
+#ifdef HAVE_FFTW_THREADS
+        fftw_plan_with_nthreads((int)threads);
+#endif
+        plan = fftw_plan_dft_r2c_1d((int)sampleCount, realBuffer, complexBuffer, FFTW_ESTIMATE);
+    }
+#ifdef HAVE_FFTW_FLOAT
+    else {
+        floatRealBuffer = fftwf_alloc_real(sampleCount);
+        floatComplexBuffer = fftwf_alloc_complex(binCount);
+#ifdef HAVE_FFTW_THREADS
+        fftwf_plan_with_nthreads((int)threads);
+#endif
+        floatPlan = fftwf_plan_dft_r2c_1d((int)sampleCount, floatRealBuffer, floatComplexBuffer, FFTW_ESTIMATE);
+    }
+#endif
+
+    planLength = sampleCount;
+    planSinglePrecision = singlePrecision;
+    planThreads = threads;
+}
+
+void SpectrumGenerator::decimate(const double *samples, unsigned sampleCount, unsigned factor) {
+    // Windowed sinc low-pass slightly below the new Nyquist frequency, against aliasing
+    const unsigned taps = 8 * factor + 1;
+    if (decimationFilter.size() != taps) {
+        std::shared_ptr<const WindowTable> filterWindow = windowCache->get(Dso::WindowFunction::BLACKMAN, taps);
+        const double cutoff = 0.45 / factor;
+        double sum = 0;
+        decimationFilter.resize(taps);
+        for (unsigned tap = 0; tap < taps; ++tap) {
+            const double x = 2.0 * M_PI * cutoff * ((double)tap - (taps - 1) / 2.0);
+            decimationFilter[tap] = (x == 0 ? 1.0 : sin(x) / x) * filterWindow->values[tap];
+            sum += decimationFilter[tap];
+        }
+        for (double &coefficient : decimationFilter) coefficient /= sum;
+    }
+
+    // Only every factor-th output of the filter is needed
+    decimated.clear();
+    if (sampleCount < taps) return;
+    decimated.resize((sampleCount - taps) / factor + 1);
+    const double *filter = decimationFilter.data();
+    for (size_t position = 0; position < decimated.size(); ++position) {
+        const double *input = samples + position * factor;
+        double value = 0;
+        for (unsigned tap = 0; tap < taps; ++tap) value += filter[tap] * input[tap];
+        decimated[position] = value;
+    }
+}
+
+void SpectrumGenerator::addSegmentPower(const double *samples, bool peak) {
+    const unsigned binCount = planLength / 2 + 1;
+#ifdef HAVE_FFTW_FLOAT
+    if (planSinglePrecision) {
+        applyWindow(floatRealBuffer, window->floatValues.data(), samples, planLength);
+        fftwf_execute(floatPlan);
+        accumulatePower(framePower.data(), floatComplexBuffer, binCount, peak);
+        return;
+    }
+#endif
+    applyWindow(realBuffer, window->values.data(), samples, planLength);
+    fftw_execute(plan);
+    accumulatePower(framePower.data(), complexBuffer, binCount, peak);
+}
+
+void SpectrumGenerator::combineFrames(ChannelSpectrum &channelSpectrum, double interval) {
+    // Restart if the frequency axis has changed
+    if (channelSpectrum.power.size() != framePower.size() || channelSpectrum.interval != interval) {
+        channelSpectrum.power = framePower;
+        channelSpectrum.frames = 1;
+        channelSpectrum.interval = interval;
+        return;
+    }
+
+    switch (postprocessing->spectrumAveraging) {
+    case Dso::SpectrumAveraging::MAXHOLD:
+        for (size_t position = 0; position < framePower.size(); ++position)
+            channelSpectrum.power[position] = std::max(channelSpectrum.power[position], framePower[position]);
+        break;
+    case Dso::SpectrumAveraging::RMS: {
+        // Exponential average, that behaves like a plain average until spectrumFrames frames are reached
+        channelSpectrum.frames = std::min(channelSpectrum.frames + 1, std::max(postprocessing->spectrumFrames, 1u));
+        const double weight = 1.0 / channelSpectrum.frames;
+        for (size_t position = 0; position < framePower.size(); ++position)
+            channelSpectrum.power[position] += (framePower[position] - channelSpectrum.power[position]) * weight;
+    } break;
+    default: // Dso::SpectrumAveraging::PEAKHOLD
+        channelSpectrum.power = framePower;
+    }
 }
 
 void SpectrumGenerator::process(PPresult *result) {
-    // Calculate frequencies and spectrums
+    // The accumulated spectrums are not comparable anymore if the segments or the averaging have changed
+    if (channelSpectrums.size() != result->channelCount() ||
+        lastSegmentLength != postprocessing->spectrumSegmentLength ||
+        lastAveraging != postprocessing->spectrumAveraging || lastWindow != postprocessing->spectrumWindow) {
+        channelSpectrums.clear();
+        channelSpectrums.resize(result->channelCount());
+        lastSegmentLength = postprocessing->spectrumSegmentLength;
+        lastAveraging = postprocessing->spectrumAveraging;
+        lastWindow = postprocessing->spectrumWindow;
+    }
+
+    // The markers are placed on the graph, which starts at the trigger point for software trigger devices
+    unsigned triggerShift = 0;
+    if (postprocessing->spectrumZoom && isSoftwareTriggerDevice)
+        triggerShift = result->swTriggerStart - result->preTrigSamples;
+
+    // Calculate the spectrums, the signal frequency is estimated by the FrequencyCounter
     for (ChannelID channel = 0; channel < result->channelCount(); ++channel) {
         DataChannel *const channelData = result->modifyData(channel);
 
-        if (channelData->voltage.sample.empty()) {
+        if (!scope->spectrum[channel].used || channelData->voltage.sample.empty()) {
             // Clear unused channels
             channelData->spectrum.interval = 0;
             channelData->spectrum.sample.clear();
+            channelSpectrums[channel] = ChannelSpectrum();
             continue;
         }
 
-        // Calculate new window
-        size_t sampleCount = channelData->voltage.sample.size();
-        if (!lastWindowBuffer || lastWindow != postprocessing->spectrumWindow || lastRecordLength != sampleCount) {
-            if (lastWindowBuffer) fftw_free(lastWindowBuffer);
-            lastWindowBuffer = fftw_alloc_real(sampleCount);
-            lastRecordLength = (unsigned)sampleCount;
-
-            unsigned int windowEnd = lastRecordLength - 1;
-            lastWindow = postprocessing->spectrumWindow;
-
-            switch (postprocessing->spectrumWindow) {
-            case Dso::WindowFunction::HAMMING:
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) = 0.54 - 0.46 * cos(2.0 * M_PI * windowPosition / windowEnd);
-                break;
-            case Dso::WindowFunction::HANN:
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) = 0.5 * (1.0 - cos(2.0 * M_PI * windowPosition / windowEnd));
-                break;
-            case Dso::WindowFunction::COSINE:
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) = sin(M_PI * windowPosition / windowEnd);
-                break;
-            case Dso::WindowFunction::LANCZOS:
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition) {
-                    double sincParameter = (2.0 * windowPosition / windowEnd - 1.0) * M_PI;
-                    if (sincParameter == 0)
-                        *(lastWindowBuffer + windowPosition) = 1;
-                    else
-                        *(lastWindowBuffer + windowPosition) = sin(sincParameter) / sincParameter;
-                }
-                break;
-            case Dso::WindowFunction::BARTLETT:
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) =
-                        2.0 / windowEnd * (windowEnd / 2 - std::abs((double)(windowPosition - windowEnd / 2.0)));
-                break;
-            case Dso::WindowFunction::TRIANGULAR:
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) =
-                        2.0 / lastRecordLength *
-                        (lastRecordLength / 2 - std::abs((double)(windowPosition - windowEnd / 2.0)));
-                break;
-            case Dso::WindowFunction::GAUSS: {
-                double sigma = 0.4;
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) =
-                        exp(-0.5 * pow(((windowPosition - windowEnd / 2) / (sigma * windowEnd / 2)), 2));
-            } break;
-            case Dso::WindowFunction::BARTLETTHANN:
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) = 0.62 -
-                                                           0.48 * std::abs((double)(windowPosition / windowEnd - 0.5)) -
-                                                           0.38 * cos(2.0 * M_PI * windowPosition / windowEnd);
-                break;
-            case Dso::WindowFunction::BLACKMAN: {
-                double alpha = 0.16;
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) = (1 - alpha) / 2 -
-                                                           0.5 * cos(2.0 * M_PI * windowPosition / windowEnd) +
-                                                           alpha / 2 * cos(4.0 * M_PI * windowPosition / windowEnd);
-            } break;
-            // case Dso::WindowFunction::WINDOW_KAISER:
-            // TODO WINDOW_KAISER
-            // double alpha = 3.0;
-            // for(unsigned int windowPosition = 0; windowPosition <
-            // lastRecordLength; ++windowPosition)
-            //*(window + windowPosition) = ;
-            // break;
-            case Dso::WindowFunction::NUTTALL:
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) = 0.355768 -
-                                                           0.487396 * cos(2 * M_PI * windowPosition / windowEnd) +
-                                                           0.144232 * cos(4 * M_PI * windowPosition / windowEnd) -
-                                                           0.012604 * cos(6 * M_PI * windowPosition / windowEnd);
-                break;
-            case Dso::WindowFunction::BLACKMANHARRIS:
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) = 0.35875 -
-                                                           0.48829 * cos(2 * M_PI * windowPosition / windowEnd) +
-                                                           0.14128 * cos(4 * M_PI * windowPosition / windowEnd) -
-                                                           0.01168 * cos(6 * M_PI * windowPosition / windowEnd);
-                break;
-            case Dso::WindowFunction::BLACKMANNUTTALL:
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) = 0.3635819 -
-                                                           0.4891775 * cos(2 * M_PI * windowPosition / windowEnd) +
-                                                           0.1365995 * cos(4 * M_PI * windowPosition / windowEnd) -
-                                                           0.0106411 * cos(6 * M_PI * windowPosition / windowEnd);
-                break;
-            case Dso::WindowFunction::FLATTOP:
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) = 1.0 - 1.93 * cos(2 * M_PI * windowPosition / windowEnd) +
-                                                           1.29 * cos(4 * M_PI * windowPosition / windowEnd) -
-                                                           0.388 * cos(6 * M_PI * windowPosition / windowEnd) +
-                                                           0.032 * cos(8 * M_PI * windowPosition / windowEnd);
-                break;
-            default: // Dso::WINDOW_RECTANGULAR
-                for (unsigned int windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                    *(lastWindowBuffer + windowPosition) = 1.0;
-            }
+        // Zoom: Only the samples between the markers are analyzed
+        const double *samples = channelData->voltage.sample.data();
+        unsigned sampleCount = (unsigned)channelData->voltage.sample.size();
+        double interval = channelData->voltage.interval;
+        if (postprocessing->spectrumZoom) {
+            double marker0 = scope->getMarker(0);
+            double marker1 = scope->getMarker(1);
+            if (marker0 > marker1) std::swap(marker0, marker1);
+            const double samplesPerDiv = scope->horizontal.timebase / interval;
+            const double first = triggerShift + (marker0 + DIVS_TIME / 2) * samplesPerDiv;
+            const double last = triggerShift + (marker1 + DIVS_TIME / 2) * samplesPerDiv;
+            const unsigned firstPosition = (unsigned)std::min(std::max(first, 0.0), (double)sampleCount);
+            const unsigned lastPosition = (unsigned)std::min(std::max(last, 0.0), (double)sampleCount);
+            samples += firstPosition;
+            sampleCount = lastPosition - firstPosition;
         }
 
-        // Set sampling interval
-        channelData->spectrum.interval = 1.0 / channelData->voltage.interval / sampleCount;
+        // Decimation: Fewer samples for the same time span and therefore a smaller DFT
+        if (postprocessing->spectrumDecimation > 1) {
+            decimate(samples, sampleCount, postprocessing->spectrumDecimation);
+            samples = decimated.data();
+            sampleCount = (unsigned)decimated.size();
+            interval *= postprocessing->spectrumDecimation;
+        }
 
-        // Number of real/complex samples
-        unsigned int dftLength = sampleCount / 2;
+        if (sampleCount < 2) {
+            channelData->spectrum.interval = 0;
+            channelData->spectrum.sample.clear();
+            continue;
+        }
 
-        // Reallocate memory for samples if the sample count has changed
-        channelData->spectrum.sample.resize(sampleCount);
+        // Split the samples into overlapping segments, a single segment covers all of them
+        unsigned segmentLength = postprocessing->spectrumSegmentLength;
+        if (segmentLength < 2 || segmentLength > sampleCount) segmentLength = sampleCount;
+        const double overlap = std::min(std::max(postprocessing->spectrumOverlap, 0.0), 0.95);
+        const unsigned segmentStep = std::max((unsigned)(segmentLength * (1.0 - overlap)), 1u);
 
-        // Create sample buffer and apply window
-        std::unique_ptr<double[]> windowedValues = std::unique_ptr<double[]>(new double[sampleCount]);
+        updatePlan(segmentLength, postprocessing->spectrumSinglePrecision, postprocessing->spectrumThreads);
+        window = windowCache->get(postprocessing->spectrumWindow, segmentLength);
 
-        for (unsigned int position = 0; position < sampleCount; ++position)
-            windowedValues[position] = lastWindowBuffer[position] * channelData->voltage.sample[position];
+        // Number of complex bins of the real-to-complex DFT
+        const unsigned binCount = segmentLength / 2 + 1;
+        const bool peak = postprocessing->spectrumAveraging == Dso::SpectrumAveraging::PEAKHOLD;
+        framePower.assign(binCount, 0.0);
+        unsigned segments = 0;
+        for (unsigned start = 0; start + segmentLength <= sampleCount; start += segmentStep, ++segments)
+            addSegmentPower(samples + start, peak);
+        if (!peak)
+            for (double &power : framePower) power /= segments;
 
-        {
-            // Do discrete real to half-complex transformation
-            /// \todo Check if record length is multiple of 2
-            /// \todo Reuse plan and use FFTW_MEASURE to get fastest algorithm
-            fftw_plan fftPlan = fftw_plan_r2r_1d(sampleCount, windowedValues.get(),
-                                                 &channelData->spectrum.sample.front(), FFTW_R2HC, FFTW_ESTIMATE);
-            fftw_execute(fftPlan);
-            fftw_destroy_plan(fftPlan);
-        }
+        // Set sampling interval
+        channelData->spectrum.interval = 1.0 / interval / segmentLength;
 
-        // Do an autocorrelation to get the frequency of the signal
-        std::unique_ptr<double[]> conjugateComplex = std::move(windowedValues);
-
-        // Real values
-        unsigned int position;
-        double correctionFactor = 1.0 / dftLength / dftLength;
-        conjugateComplex[0] = (channelData->spectrum.sample[0] * channelData->spectrum.sample[0]) * correctionFactor;
-        for (position = 1; position < dftLength; ++position)
-            conjugateComplex[position] =
-                (channelData->spectrum.sample[position] * channelData->spectrum.sample[position] +
-                 channelData->spectrum.sample[sampleCount - position] *
-                     channelData->spectrum.sample[sampleCount - position]) *
-                correctionFactor;
-        // Complex values, all zero for autocorrelation
-        conjugateComplex[dftLength] =
-            (channelData->spectrum.sample[dftLength] * channelData->spectrum.sample[dftLength]) * correctionFactor;
-        for (++position; position < sampleCount; ++position) conjugateComplex[position] = 0;
-
-        // Do half-complex to real inverse transformation
-        std::unique_ptr<double[]> correlation = std::unique_ptr<double[]>(new double[sampleCount]);
-        fftw_plan fftPlan =
-            fftw_plan_r2r_1d(sampleCount, conjugateComplex.get(), correlation.get(), FFTW_HC2R, FFTW_ESTIMATE);
-        fftw_execute(fftPlan);
-        fftw_destroy_plan(fftPlan);
-
-        // Get the frequency from the correlation results
-        double minimumCorrelation = correlation[0];
-        double peakCorrelation = 0;
-        unsigned int peakPosition = 0;
-
-        for (unsigned int position = 1; position < sampleCount / 2; ++position) {
-            if (correlation[position] > peakCorrelation && correlation[position] > minimumCorrelation * 2) {
-                peakCorrelation = correlation[position];
-                peakPosition = position;
-            } else if (correlation[position] < minimumCorrelation)
-                minimumCorrelation = correlation[position];
-        }
-        correlation.reset(nullptr);
+        ChannelSpectrum &channelSpectrum = channelSpectrums[channel];
+        combineFrames(channelSpectrum, channelData->spectrum.interval);
 
-        // Calculate the frequency in Hz
-        if (peakPosition)
-            channelData->frequency = 1.0 / (channelData->voltage.interval * peakPosition);
-        else
-            channelData->frequency = 0;
-
-        // Finally calculate the real spectrum if we want it
-        if (scope->spectrum[channel].used) {
-            // Convert values into dB (Relative to the reference level)
-            double offset = 60 - postprocessing->spectrumReference - 20 * log10(dftLength);
-            double offsetLimit = postprocessing->spectrumLimit - postprocessing->spectrumReference;
-            for (std::vector<double>::iterator spectrumIterator = channelData->spectrum.sample.begin();
-                 spectrumIterator != channelData->spectrum.sample.end(); ++spectrumIterator) {
-                double value = 20 * log10(fabs(*spectrumIterator)) + offset;
-
-                // Check if this value has to be limited
-                if (offsetLimit > value) value = offsetLimit;
-
-                *spectrumIterator = value;
-            }
-        }
+        // Magnitudes are written in dB (Relative to the reference level)
+        const double offset = 60 - postprocessing->spectrumReference - 20 * log10(segmentLength / 2);
+        const double offsetLimit = postprocessing->spectrumLimit - postprocessing->spectrumReference;
+        channelData->spectrum.sample.resize(binCount);
+        toDecibel(channelData->spectrum.sample.data(), channelSpectrum.power.data(), binCount, offset, offsetLimit);
     }
 }
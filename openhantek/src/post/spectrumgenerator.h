@@ -8,10 +8,13 @@
 #include <QThread>
 #include <memory>
 
+#include <fftw3.h>
+
 #include "ppresult.h"
 #include "dsosamples.h"
 #include "utils/printutils.h"
 #include "postprocessingsettings.h"
+#include "windowfunction.h"
 
 #include "processor.h"
 
@@ -19,18 +22,59 @@ class DsoSettings;
 struct DsoSettingsScope;
 
 /// \brief Analyzes the data from the dso.
-/// Calculates the spectrum and various data about the signal and saves the
-/// time-/frequencysteps between two values.
+/// Calculates the spectrum of all channels with an enabled spectrum graph and saves the
+/// frequencysteps between two values.
+/// The real-to-complex DFT is done in single precision if fftw3f is available (HAVE_FFTW_FLOAT),
+/// the 8 bit samples of the scopes do not need more. Plans and aligned buffers are kept until the
+/// segment length or the precision changes.
+/// With a segment length shorter than the record, the power spectral density is estimated with the
+/// Welch method: The record is split into overlapping windowed segments whose power is averaged
+/// (or peak-held) and optionally averaged/max-held over several frames.
+/// The analysis can be limited to the span between the markers (zoom) and the samples can be
+/// decimated before, so that the DFT is only as large as the selected span and bandwidth require.
 class SpectrumGenerator : public Processor {
   public:
-    SpectrumGenerator(const DsoSettingsScope* scope, const DsoSettingsPostProcessing* postprocessing);
+    SpectrumGenerator(const DsoSettingsScope *scope, const DsoSettingsPostProcessing *postprocessing,
+                      WindowCache *windowCache, bool isSoftwareTriggerDevice);
     virtual ~SpectrumGenerator();
     virtual void process(PPresult *data) override;
 
   private:
+    struct ChannelSpectrum {
+        std::vector<double> power; ///< Power per bin, averaged or held over the last frames
+        unsigned frames = 0;       ///< Number of frames in power
+        double interval = 0.0;     ///< Frequency step of power
+    };
+
+    void updatePlan(unsigned sampleCount, bool singlePrecision, unsigned threads);
+    void destroyPlan();
+    void addSegmentPower(const double *samples, bool peak);
+    void combineFrames(ChannelSpectrum &channelSpectrum, double interval);
+    /// \brief Low-pass filters the samples and keeps every factor-th value in decimated.
+    void decimate(const double *samples, unsigned sampleCount, unsigned factor);
+
     const DsoSettingsScope* scope;
     const DsoSettingsPostProcessing* postprocessing;
-    unsigned int lastRecordLength = 0;                        ///< The record length of the previously analyzed data
+    WindowCache *windowCache;
+    const bool isSoftwareTriggerDevice;
+    std::shared_ptr<const WindowTable> window;                ///< The window of the current segment length
     Dso::WindowFunction lastWindow = (Dso::WindowFunction)-1; ///< The previously used dft window function
-    double *lastWindowBuffer = nullptr;
+
+    unsigned planLength = 0;          ///< The record length the plan has been created for
+    bool planSinglePrecision = false; ///< The plan works on the float buffers
+    unsigned planThreads = 1;         ///< The number of threads the plan has been created with
+    double *realBuffer = nullptr;     ///< Windowed samples, input of the double precision plan
+    fftw_complex *complexBuffer = nullptr;
+    fftw_plan plan = nullptr;
+    std::vector<double> framePower; ///< Power per bin of the current frame
+    std::vector<double> decimationFilter; ///< Anti-aliasing low-pass of the decimation
+    std::vector<double> decimated;        ///< The decimated samples of the current channel
+    std::vector<ChannelSpectrum> channelSpectrums;
+    unsigned lastSegmentLength = 0;                                    ///< Settings of channelSpectrums
+    Dso::SpectrumAveraging lastAveraging = (Dso::SpectrumAveraging)-1; ///< Settings of channelSpectrums
+#ifdef HAVE_FFTW_FLOAT
+    float *floatRealBuffer = nullptr; ///< Windowed samples, input of the single precision plan
+    fftwf_complex *floatComplexBuffer = nullptr;
+    fftwf_plan floatPlan = nullptr;
+#endif
 };
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <cmath>
+
+#include <QMutexLocker>
+
+#include "windowfunction.h"
+
+WindowCache::WindowCache(unsigned capacity) : capacity(std::max(capacity, 1u)) {}
+
+std::shared_ptr<const WindowTable> WindowCache::get(Dso::WindowFunction function, unsigned length) {
+    QMutexLocker locker(&mutex);
+
+    for (auto table = tables.begin(); table != tables.end(); ++table) {
+        if ((*table)->function == function && (*table)->length == length) {
+            tables.splice(tables.begin(), tables, table);
+            return tables.front();
+        }
+    }
+
+    std::shared_ptr<WindowTable> table = std::make_shared<WindowTable>();
+    table->function = function;
+    table->length = length;
+    table->values.resize(length);
+    generate(function, table->values.data(), length);
+    table->floatValues.assign(table->values.begin(), table->values.end());
+
+    tables.push_front(table);
+    if (tables.size() > capacity) tables.pop_back();
+    return table;
+}
+
+void WindowCache::generate(Dso::WindowFunction function, double *window, unsigned length) {
+    if (length < 2) {
+        std::fill_n(window, length, 1.0);
+        return;
+    }
+    unsigned int windowEnd = length - 1;
+
+    switch (function) {
+    case Dso::WindowFunction::HAMMING:
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] = 0.54 - 0.46 * cos(2.0 * M_PI * windowPosition / windowEnd);
+        break;
+    case Dso::WindowFunction::HANN:
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] = 0.5 * (1.0 - cos(2.0 * M_PI * windowPosition / windowEnd));
+        break;
+    case Dso::WindowFunction::COSINE:
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] = sin(M_PI * windowPosition / windowEnd);
+        break;
+    case Dso::WindowFunction::LANCZOS:
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition) {
+            double sincParameter = (2.0 * windowPosition / windowEnd - 1.0) * M_PI;
+            if (sincParameter == 0)
+                window[windowPosition] = 1;
+            else
+                window[windowPosition] = sin(sincParameter) / sincParameter;
+        }
+        break;
+    case Dso::WindowFunction::BARTLETT:
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] =
+                2.0 / windowEnd * (windowEnd / 2 - std::abs((double)(windowPosition - windowEnd / 2.0)));
+        break;
+    case Dso::WindowFunction::TRIANGULAR:
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] =
+                2.0 / length * (length / 2 - std::abs((double)(windowPosition - windowEnd / 2.0)));
+        break;
+    case Dso::WindowFunction::GAUSS: {
+        double sigma = 0.4;
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] =
+                exp(-0.5 * pow((((double)windowPosition - windowEnd / 2.0) / (sigma * windowEnd / 2)), 2));
+    } break;
+    case Dso::WindowFunction::BARTLETTHANN:
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] = 0.62 -
+                                     0.48 * std::abs((double)windowPosition / windowEnd - 0.5) -
+                                     0.38 * cos(2.0 * M_PI * windowPosition / windowEnd);
+        break;
+    case Dso::WindowFunction::BLACKMAN: {
+        double alpha = 0.16;
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] = (1 - alpha) / 2 -
+                                     0.5 * cos(2.0 * M_PI * windowPosition / windowEnd) +
+                                     alpha / 2 * cos(4.0 * M_PI * windowPosition / windowEnd);
+    } break;
+    // case Dso::WindowFunction::WINDOW_KAISER:
+    // TODO WINDOW_KAISER
+    // double alpha = 3.0;
+    // for(unsigned int windowPosition = 0; windowPosition <
+    // length; ++windowPosition)
+    //*(window + windowPosition) = ;
+    // break;
+    case Dso::WindowFunction::NUTTALL:
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] = 0.355768 -
+                                     0.487396 * cos(2 * M_PI * windowPosition / windowEnd) +
+                                     0.144232 * cos(4 * M_PI * windowPosition / windowEnd) -
+                                     0.012604 * cos(6 * M_PI * windowPosition / windowEnd);
+        break;
+    case Dso::WindowFunction::BLACKMANHARRIS:
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] = 0.35875 -
+                                     0.48829 * cos(2 * M_PI * windowPosition / windowEnd) +
+                                     0.14128 * cos(4 * M_PI * windowPosition / windowEnd) -
+                                     0.01168 * cos(6 * M_PI * windowPosition / windowEnd);
+        break;
+    case Dso::WindowFunction::BLACKMANNUTTALL:
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] = 0.3635819 -
+                                     0.4891775 * cos(2 * M_PI * windowPosition / windowEnd) +
+                                     0.1365995 * cos(4 * M_PI * windowPosition / windowEnd) -
+                                     0.0106411 * cos(6 * M_PI * windowPosition / windowEnd);
+        break;
+    case Dso::WindowFunction::FLATTOP:
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] = 1.0 - 1.93 * cos(2 * M_PI * windowPosition / windowEnd) +
+                                     1.29 * cos(4 * M_PI * windowPosition / windowEnd) -
+                                     0.388 * cos(6 * M_PI * windowPosition / windowEnd) +
+                                     0.032 * cos(8 * M_PI * windowPosition / windowEnd);
+        break;
+    default: // Dso::WINDOW_RECTANGULAR
+        for (unsigned int windowPosition = 0; windowPosition < length; ++windowPosition)
+            window[windowPosition] = 1.0;
+    }
+}
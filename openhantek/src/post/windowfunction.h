@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include <QMutex>
+
+#include "postprocessingsettings.h"
+
+/// \brief A precomputed window function of a certain length.
+struct WindowTable {
+    Dso::WindowFunction function;
+    unsigned length;
+    std::vector<double> values;     ///< The window, one factor per sample
+    std::vector<float> floatValues; ///< Single precision copy of values
+};
+
+/// \brief Cache of window function tables, keyed by function and length.
+/// One instance is shared by all processors that apply windows, so that channels or segments of
+/// different lengths do not recompute their windows every frame. The least recently used table is
+/// dropped when the cache is full.
+class WindowCache {
+  public:
+    explicit WindowCache(unsigned capacity = 8);
+
+    /// \brief Returns the table for the given window, it is computed on the first request.
+    /// \param function The window function.
+    /// \param length The number of samples the window is applied to.
+    std::shared_ptr<const WindowTable> get(Dso::WindowFunction function, unsigned length);
+
+    /// \brief Computes a window function.
+    /// \param function The window function.
+    /// \param window The output array.
+    /// \param length The number of values written to window.
+    static void generate(Dso::WindowFunction function, double *window, unsigned length);
+
+  private:
+    QMutex mutex;
+    const unsigned capacity;
+    std::list<std::shared_ptr<const WindowTable>> tables; ///< The most recently used table first
+};
@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include "scpiparser.h"
+#include "utils/numberformat.h"
+
+#include <cctype>
+#include <cmath>
+
+namespace {
+/// Splits at the separator outside of quoted strings.
+std::vector<QByteArray> splitUnquoted(const QByteArray &text, char separator) {
+    std::vector<QByteArray> parts;
+    char quote = 0;
+    int start = 0;
+    for (int i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '"' || c == '\'')
+            quote = c;
+        else if (c == separator) {
+            parts.push_back(text.mid(start, i - start).trimmed());
+            start = i + 1;
+        }
+    }
+    parts.push_back(text.mid(start).trimmed());
+    return parts;
+}
+
+struct Unit {
+    const char *name;
+    double factor;
+};
+
+const Unit units[] = {{"", 1.0},       {"V", 1.0},      {"MV", 1e-3},    {"UV", 1e-6},
+                      {"S", 1.0},      {"MS", 1e-3},    {"US", 1e-6},    {"NS", 1e-9},
+                      {"HZ", 1.0},     {"KHZ", 1e3},    {"MHZ", 1e6},    {"GHZ", 1e9}};
+} // namespace
+
+bool ScpiCommand::is(size_t node, const char *mnemonic) const {
+    return node < header.size() && scpiMatches(header[node].mnemonic, mnemonic);
+}
+
+std::vector<QByteArray> splitScpiLine(const QByteArray &line) {
+    std::vector<QByteArray> units;
+    for (const QByteArray &unit : splitUnquoted(line, ';'))
+        if (!unit.isEmpty()) units.push_back(unit);
+    return units;
+}
+
+bool parseScpiCommand(const QByteArray &unit, const ScpiCommand *previous, ScpiCommand &command) {
+    command = ScpiCommand();
+
+    int headerEnd = 0;
+    while (headerEnd < unit.size() && !std::isspace((unsigned char)unit[headerEnd])) ++headerEnd;
+    QByteArray header = unit.left(headerEnd);
+    QByteArray rest = unit.mid(headerEnd).trimmed();
+
+    if (header.endsWith('?')) {
+        command.query = true;
+        header.chop(1);
+    }
+    if (header.isEmpty()) return false;
+
+    if (header[0] == '*') {
+        command.common = true;
+        ScpiCommand::Node node;
+        if (!scpiNode(header.mid(1), node) || node.suffix >= 0) return false;
+        command.header.push_back(node);
+    } else {
+        bool absolute = header[0] == ':';
+        if (absolute) header.remove(0, 1);
+        if (!absolute && previous && !previous->common && previous->header.size() > 1)
+            command.header.assign(previous->header.begin(), previous->header.end() - 1);
+        for (const QByteArray &part : header.split(':')) {
+            ScpiCommand::Node node;
+            if (!scpiNode(part, node)) return false;
+            command.header.push_back(node);
+        }
+    }
+
+    if (rest.isEmpty()) return true;
+    for (QByteArray argument : splitUnquoted(rest, ',')) {
+        if (argument.isEmpty()) return false;
+        if (argument.size() >= 2 && (argument[0] == '"' || argument[0] == '\'')) {
+            if (argument[argument.size() - 1] != argument[0]) return false;
+            argument = argument.mid(1, argument.size() - 2);
+        }
+        command.arguments.push_back(argument);
+    }
+    return true;
+}
+
+bool scpiMatches(const QByteArray &mnemonic, const char *pattern) {
+    QByteArray shortForm;
+    QByteArray longForm;
+    for (const char *c = pattern; *c; ++c) {
+        if (!std::islower((unsigned char)*c)) shortForm += *c;
+        longForm += (char)std::toupper((unsigned char)*c);
+    }
+    return mnemonic == shortForm || mnemonic == longForm;
+}
+
+bool scpiNumber(const QByteArray &argument, double &value) {
+    // The number itself, QByteArray::toDouble() doesn't depend on the locale like strtod()
+    int end = 0;
+    auto digits = [&argument, &end]() {
+        int start = end;
+        while (end < argument.size() && std::isdigit((unsigned char)argument[end])) ++end;
+        return end - start;
+    };
+    if (end < argument.size() && (argument[end] == '+' || argument[end] == '-')) ++end;
+    int mantissa = digits();
+    if (end < argument.size() && argument[end] == '.') {
+        ++end;
+        mantissa += digits();
+    }
+    if (!mantissa) return false;
+    if (end < argument.size() && (argument[end] == 'e' || argument[end] == 'E')) {
+        int exponent = end++;
+        if (end < argument.size() && (argument[end] == '+' || argument[end] == '-')) ++end;
+        if (!digits()) end = exponent;
+    }
+
+    bool ok = false;
+    double number = argument.left(end).toDouble(&ok);
+    if (!ok || !std::isfinite(number)) return false;
+
+    QByteArray suffix = argument.mid(end).trimmed().toUpper();
+    for (const Unit &unit : units) {
+        if (suffix == unit.name) {
+            value = number * unit.factor;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool scpiBoolean(const QByteArray &argument, bool &value) {
+    QByteArray upper = argument.toUpper();
+    if (upper == "ON" || upper == "1") {
+        value = true;
+        return true;
+    }
+    if (upper == "OFF" || upper == "0") {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+bool scpiNode(const QByteArray &argument, ScpiCommand::Node &node) {
+    int end = argument.size();
+    while (end > 0 && std::isdigit((unsigned char)argument[end - 1])) --end;
+    if (end == 0) return false;
+    for (int i = 0; i < end; ++i)
+        if (!std::isalpha((unsigned char)argument[i]) && argument[i] != '_') return false;
+
+    node.mnemonic = argument.left(end).toUpper();
+    node.suffix = end < argument.size() ? argument.mid(end).toInt() : -1;
+    return true;
+}
+
+QByteArray scpiFormat(double value) {
+    char buffer[SHORTEST_BUFFER_SIZE];
+    return QByteArray(buffer, int(formatShortest(buffer, value) - buffer));
+}
+
+QByteArray scpiBlock(const char *data, size_t size) {
+    QByteArray length = QByteArray::number(qulonglong(size));
+    QByteArray block;
+    block.reserve(int(2 + length.size() + size));
+    block += '#';
+    block += char('0' + length.size());
+    block += length;
+    block.append(data, int(size));
+    return block;
+}
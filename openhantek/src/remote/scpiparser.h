@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <QByteArray>
+#include <vector>
+
+/// \brief One command of a SCPI program message, e.g. "CHANnel2:SCALe 0.5" or "MEASure:VPP? CHANnel1".
+struct ScpiCommand {
+    /// \brief A node of the header, e.g. CHANnel2 is the mnemonic "CHANNEL" with the suffix 2.
+    struct Node {
+        QByteArray mnemonic; ///< In upper case
+        int suffix = -1;     ///< The numeric suffix, -1 if there is none
+    };
+
+    std::vector<Node> header;
+    std::vector<QByteArray> arguments; ///< Without surrounding white space and quotes
+    bool common = false;               ///< IEEE 488.2 common command like *IDN?, the header has one node
+    bool query = false;                ///< The header ends with '?'
+
+    /// \brief Compares a node of the header with a mnemonic in the notation of the SCPI standard, where the
+    /// upper case letters are the short form: "CHANnel" matches CHAN and CHANNEL, but not CHANN.
+    bool is(size_t node, const char *mnemonic) const;
+};
+
+/// \brief Splits a line into its program message units at the ';' outside of quoted strings.
+std::vector<QByteArray> splitScpiLine(const QByteArray &line);
+
+/// \brief Parses a program message unit.
+/// A header without leading ':' continues in the subsystem of the previous command of the same line, so
+/// "TRIG:MODE AUTO;SLOP POS" sets the trigger mode and the trigger slope.
+/// \param unit One unit returned by splitScpiLine().
+/// \param previous The previous command of this line or nullptr.
+/// \return false on a syntax error.
+bool parseScpiCommand(const QByteArray &unit, const ScpiCommand *previous, ScpiCommand &command);
+
+/// \brief Compares a mnemonic in upper case with the SCPI notation, see ScpiCommand::is().
+bool scpiMatches(const QByteArray &mnemonic, const char *pattern);
+
+/// \brief Parses a decimal number with an optional unit: V, S or HZ with the multipliers of the SCPI standard
+/// (mV, uS, kHz, MHz...). Note that an "M" is milli, except for MHZ.
+bool scpiNumber(const QByteArray &argument, double &value);
+
+/// \brief Parses ON, OFF, 1 or 0.
+bool scpiBoolean(const QByteArray &argument, bool &value);
+
+/// \brief Parses a mnemonic with an optional numeric suffix like CHANnel2.
+bool scpiNode(const QByteArray &argument, ScpiCommand::Node &node);
+
+/// \brief Writes a number that reads back as the same double.
+QByteArray scpiFormat(double value);
+
+/// \brief Wraps binary data into an IEEE 488.2 definite length block: "#", the number of digits of the
+/// length, the length and the data.
+QByteArray scpiBlock(const char *data, size_t size);
@@ -0,0 +1,630 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "scpiparser.h"
+#include "scpiserver.h"
+
+#include "dsomodel.h"
+#include "hantekdsocontrol.h"
+#include "post/ppresult.h"
+#include "settings.h"
+#include "usb/usbdevice.h"
+#include "viewconstants.h"
+
+namespace {
+/// A line without newline that gets longer than this is dropped
+const int MAX_LINE_LENGTH = 64 * 1024;
+/// Older errors are kept, the last entry becomes "Queue overflow"
+const size_t MAX_ERRORS = 32;
+
+const char *errorMessage(int error) {
+    switch (error) {
+    case -102: return "Syntax error";
+    case -104: return "Data type error";
+    case -108: return "Parameter not allowed";
+    case -109: return "Missing parameter";
+    case -113: return "Undefined header";
+    case -114: return "Header suffix out of range";
+    case -221: return "Settings conflict";
+    case -222: return "Data out of range";
+    case -223: return "Too much data";
+    case -224: return "Illegal parameter value";
+    case -230: return "Data corrupt or stale";
+    case -240: return "Hardware error";
+    case -350: return "Queue overflow";
+    default: return "Error";
+    }
+}
+
+/// Checks the arguments of a command that sets one value.
+int singleArgument(const ScpiCommand &command) {
+    if (command.arguments.empty()) return -109;
+    if (command.arguments.size() > 1) return -108;
+    return 0;
+}
+
+/// \return The index of the matching pattern or -1.
+int choice(const QByteArray &argument, std::initializer_list<const char *> patterns) {
+    QByteArray upper = argument.toUpper();
+    int index = 0;
+    for (const char *pattern : patterns) {
+        if (scpiMatches(upper, pattern)) return index;
+        ++index;
+    }
+    return -1;
+}
+
+/// The samples as little endian float values
+QByteArray floatBlock(const std::vector<double> &samples) {
+    std::vector<uint32_t> words(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        float value = (float)samples[i];
+        uint32_t word;
+        memcpy(&word, &value, sizeof(word));
+        words[i] = qToLittleEndian(word);
+    }
+    return scpiBlock(reinterpret_cast<const char *>(words.data()), words.size() * sizeof(uint32_t));
+}
+
+struct MeasurementItem {
+    const char *mnemonic;
+    double (*value)(const DataChannel &data);
+};
+
+const MeasurementItem measurementItems[] = {
+    {"VMAX", [](const DataChannel &data) { return data.measurements.maximum; }},
+    {"VMIN", [](const DataChannel &data) { return data.measurements.minimum; }},
+    {"VPP", [](const DataChannel &data) { return data.measurements.peakToPeak(); }},
+    {"VTOP", [](const DataChannel &data) { return data.measurements.top; }},
+    {"VBASe", [](const DataChannel &data) { return data.measurements.base; }},
+    {"VAMPlitude", [](const DataChannel &data) { return data.measurements.amplitude(); }},
+    {"VAVerage", [](const DataChannel &data) { return data.measurements.mean; }},
+    {"VRMS", [](const DataChannel &data) { return data.measurements.rms; }},
+    {"VACRms", [](const DataChannel &data) { return data.measurements.acRms; }},
+    {"OVERshoot", [](const DataChannel &data) { return data.measurements.overshoot; }},
+    {"RISetime", [](const DataChannel &data) { return data.measurements.riseTime; }},
+    {"FALLtime", [](const DataChannel &data) { return data.measurements.fallTime; }},
+    {"DUTYcycle", [](const DataChannel &data) { return data.measurements.dutyCycle; }},
+    {"PERiod", [](const DataChannel &data) { return data.measurements.period; }},
+    // The measured frequency if there are full periods, the frequency of the spectrum otherwise
+    {"FREQuency", [](const DataChannel &data) {
+         return data.measurements.frequency > 0.0 ? data.measurements.frequency : data.frequency;
+     }}};
+} // namespace
+
+ScpiServer::ScpiServer(HantekDsoControl *dsoControl, const DsoSettings *settings, QObject *parent)
+    : QObject(parent), dsoControl(dsoControl), settings(settings),
+      spec(dsoControl->getDevice()->getModel()->spec()), scope(settings->scope) {
+    // The signals are queued to the GUI thread
+    qRegisterMetaType<ChannelID>("ChannelID");
+    qRegisterMetaType<DsoSettingsScopeTrigger>();
+    qRegisterMetaType<DsoSettingsScopeHorizontal>();
+}
+
+ScpiServer::~ScpiServer() { close(); }
+
+void ScpiServer::listen(const QString &address) {
+    bool isPort = false;
+    unsigned port = address.toUInt(&isPort);
+    if (isPort) {
+        tcpServer = new QTcpServer(this);
+        // Only local programs may control the device, there is no authentication
+        if (!tcpServer->listen(QHostAddress::LocalHost, quint16(port))) {
+            qWarning() << "SCPI server:" << tcpServer->errorString();
+            return;
+        }
+        connect(tcpServer, &QTcpServer::newConnection, [this]() {
+            while (QTcpSocket *socket = tcpServer->nextPendingConnection()) {
+                socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+                connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+                addConnection(socket);
+            }
+        });
+    } else {
+        localServer = new QLocalServer(this);
+        localServer->setSocketOptions(QLocalServer::UserAccessOption);
+        QLocalServer::removeServer(address);
+        if (!localServer->listen(address)) {
+            qWarning() << "SCPI server:" << localServer->errorString();
+            return;
+        }
+        connect(localServer, &QLocalServer::newConnection, [this]() {
+            while (QLocalSocket *socket = localServer->nextPendingConnection()) {
+                connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+                addConnection(socket);
+            }
+        });
+    }
+}
+
+void ScpiServer::close() {
+    // The connected sockets are children of the servers
+    delete tcpServer;
+    tcpServer = nullptr;
+    delete localServer;
+    localServer = nullptr;
+}
+
+void ScpiServer::input(std::shared_ptr<PPresult> data) {
+    std::lock_guard<std::mutex> lock(resultMutex);
+    result = std::move(data);
+    ++frameCount;
+}
+
+void ScpiServer::addConnection(QIODevice *socket) {
+    Connection *connection = new Connection{socket, QByteArray(), std::deque<int>(), false};
+    connect(socket, &QIODevice::readyRead, [this, connection]() { readCommands(connection); });
+    connect(socket, &QObject::destroyed, [connection]() { delete connection; });
+}
+
+void ScpiServer::pushError(Connection *connection, int error) {
+    if (connection->errors.size() < MAX_ERRORS)
+        connection->errors.push_back(error);
+    else
+        connection->errors.back() = -350;
+}
+
+void ScpiServer::readCommands(Connection *connection) {
+    connection->buffer += connection->socket->readAll();
+
+    if (connection->buffer.size() > MAX_LINE_LENGTH && connection->buffer.indexOf('\n') < 0) {
+        connection->buffer.clear();
+        pushError(connection, -223);
+    }
+    if (connection->waitingForSettings || connection->buffer.indexOf('\n') < 0) return;
+
+    // The settings belong to the GUI thread: Copy them there, then execute the complete lines with the copy
+    connection->waitingForSettings = true;
+    QPointer<ScpiServer> server(this);
+    QPointer<QIODevice> socket(connection->socket);
+    const DsoSettings *settings = this->settings;
+    QTimer::singleShot(0, QCoreApplication::instance(), [server, socket, connection, settings]() {
+        // The server is deleted in the GUI thread too
+        if (!server) return;
+        DsoSettingsScope copy = settings->scope;
+        QTimer::singleShot(0, server.data(), [server, socket, connection, copy]() {
+            // The connection is deleted with its socket, both in the thread of the server
+            if (socket) server->executeCommands(connection, copy);
+        });
+    });
+}
+
+void ScpiServer::executeCommands(Connection *connection, const DsoSettingsScope &settingsScope) {
+    connection->waitingForSettings = false;
+    scope = settingsScope;
+
+    int newline;
+    while ((newline = connection->buffer.indexOf('\n')) >= 0) {
+        QByteArray line = connection->buffer.left(newline);
+        connection->buffer.remove(0, newline + 1);
+        if (line.endsWith('\r')) line.chop(1);
+
+        // A line with queries gets one line as answer, a failed query leaves its field empty
+        QByteArray response;
+        bool answered = false;
+        ScpiCommand previous;
+        bool hasPrevious = false;
+        for (const QByteArray &unit : splitScpiLine(line)) {
+            ScpiCommand command;
+            if (!parseScpiCommand(unit, hasPrevious ? &previous : nullptr, command)) {
+                // The rest of the line can't be interpreted reliably
+                pushError(connection, -102);
+                break;
+            }
+
+            QByteArray answer;
+            int error = execute(connection, command, answer);
+            if (error) pushError(connection, error);
+            if (command.query) {
+                if (answered) response += ';';
+                if (!error) response += answer;
+                answered = true;
+            }
+            previous = std::move(command);
+            hasPrevious = true;
+        }
+        if (answered) {
+            response += '\n';
+            connection->socket->write(response);
+        }
+    }
+
+}
+
+int ScpiServer::execute(Connection *connection, const ScpiCommand &command, QByteArray &response) {
+    if (command.common) {
+        if (command.is(0, "IDN") && command.query) {
+            response = "OpenHantek," + QByteArray(dsoControl->getDevice()->getModel()->name.c_str()) + ",0," VERSION;
+            return 0;
+        }
+        if (command.is(0, "OPC")) {
+            // The commands are executed in order, everything before has been done already
+            if (command.query) response = "1";
+            return 0;
+        }
+        if (command.is(0, "WAI") && !command.query) return 0;
+        if (command.is(0, "CLS") && !command.query) {
+            connection->errors.clear();
+            return 0;
+        }
+        if (command.is(0, "TRG") && !command.query) {
+            dsoControl->forceTrigger();
+            return 0;
+        }
+        return -113;
+    }
+
+    if (command.header.size() == 1 && !command.query && command.arguments.empty()) {
+        if (command.is(0, "RUN")) {
+            dsoControl->enableSampling(true);
+            return 0;
+        }
+        if (command.is(0, "STOP")) {
+            dsoControl->enableSampling(false);
+            return 0;
+        }
+    }
+    if (command.is(0, "SYSTem") && command.is(1, "ERRor") && command.query &&
+        (command.header.size() == 2 || (command.header.size() == 3 && command.is(2, "NEXT")))) {
+        int error = 0;
+        if (!connection->errors.empty()) {
+            error = connection->errors.front();
+            connection->errors.pop_front();
+        }
+        response = QByteArray::number(error) + ",\"" + (error ? errorMessage(error) : "No error") + "\"";
+        return 0;
+    }
+    if (command.is(0, "CHANnel")) return executeChannel(command, response);
+    if (command.is(0, "TRIGger")) return executeTrigger(command, response);
+    if (command.is(0, "ACQuire") || command.is(0, "TIMebase")) return executeAcquire(command, response);
+    if (command.is(0, "MEASure")) return executeMeasure(command, response);
+    if (command.is(0, "WAVeform")) return executeWaveform(command, response);
+    return -113;
+}
+
+int ScpiServer::executeChannel(const ScpiCommand &command, QByteArray &response) {
+    if (command.header.size() != 2) return -113;
+    int suffix = command.header[0].suffix < 0 ? 1 : command.header[0].suffix;
+    if (suffix < 1 || unsigned(suffix) > scope.voltage.size()) return -114;
+    ChannelID channel = ChannelID(suffix - 1);
+    DsoSettingsScopeVoltage &voltage = scope.voltage[channel];
+
+    if (command.is(1, "NAME") && command.query) {
+        response = "\"" + voltage.name.toUtf8() + "\"";
+        return 0;
+    }
+    if (command.is(1, "DISPlay")) {
+        if (command.query) {
+            response = voltage.used ? "1" : "0";
+            return 0;
+        }
+        if (int error = singleArgument(command)) return error;
+        bool used;
+        if (!scpiBoolean(command.arguments[0], used)) return -104;
+        voltage.used = used;
+        int error = updateUsedChannels(channel);
+        emit usedChanged(channel, used);
+        return error;
+    }
+    if (command.is(1, "SCALe")) {
+        if (command.query) {
+            response = scpiFormat(scope.gain(channel));
+            return 0;
+        }
+        if (int error = singleArgument(command)) return error;
+        double gain;
+        if (!scpiNumber(command.arguments[0], gain)) return -104;
+        // The next step that shows the whole requested range
+        unsigned index = 0;
+        while (index < scope.gainSteps.size() && scope.gainSteps[index] < gain * (1.0 - 1e-9)) ++index;
+        if (!(gain > 0.0) || index >= scope.gainSteps.size()) return -222;
+        voltage.gainStepIndex = index;
+        int error = 0;
+        if (channel < spec->channels)
+            error = deviceError(dsoControl->setGain(channel, scope.gain(channel) * DIVS_VOLTAGE));
+        emit gainChanged(channel, index);
+        return error;
+    }
+    if (command.is(1, "OFFSet")) {
+        if (command.query) {
+            response = scpiFormat(voltage.offset);
+            return 0;
+        }
+        if (int error = singleArgument(command)) return error;
+        double offset;
+        if (!scpiNumber(command.arguments[0], offset)) return -104;
+        if (offset < -DIVS_VOLTAGE / 2 || offset > DIVS_VOLTAGE / 2) return -222;
+        voltage.offset = offset;
+        int error = 0;
+        if (channel < spec->channels)
+            error = deviceError(dsoControl->setOffset(channel, (offset / DIVS_VOLTAGE) + 0.5));
+        emit offsetChanged(channel, offset);
+        return error;
+    }
+    if (command.is(1, "COUPling")) {
+        // The math channels use the index for their mode
+        if (channel >= spec->channels) return -221;
+        static const char *names[] = {"AC", "DC", "GND"};
+        if (command.query) {
+            response = names[(int)scope.coupling(channel, spec)];
+            return 0;
+        }
+        if (int error = singleArgument(command)) return error;
+        int coupling = choice(command.arguments[0], {"AC", "DC", "GND"});
+        if (coupling < 0) return -224;
+        auto it = std::find(spec->couplings.begin(), spec->couplings.end(), (Dso::Coupling)coupling);
+        if (it == spec->couplings.end()) return -224;
+        voltage.couplingOrMathIndex = unsigned(it - spec->couplings.begin());
+        int error = deviceError(dsoControl->setCoupling(channel, (Dso::Coupling)coupling));
+        emit couplingChanged(channel, voltage.couplingOrMathIndex);
+        return error;
+    }
+    return -113;
+}
+
+int ScpiServer::executeTrigger(const ScpiCommand &command, QByteArray &response) {
+    DsoSettingsScopeTrigger &trigger = scope.trigger;
+    if (command.header.size() != 2) return -113;
+    // The software trigger can use the math channel as source
+    ChannelID triggerChannels = spec->isSoftwareTriggerDevice ? ChannelID(scope.voltage.size()) : spec->channels;
+
+    if (command.is(1, "FORCe") && !command.query) {
+        dsoControl->forceTrigger();
+        return 0;
+    }
+    if (command.is(1, "MODE")) {
+        static const Dso::TriggerMode modes[] = {Dso::TriggerMode::WAIT_FORCE, Dso::TriggerMode::HARDWARE_SOFTWARE,
+                                                 Dso::TriggerMode::SINGLE};
+        static const char *names[] = {"AUTO", "NORM", "SING"};
+        if (command.query) {
+            response = names[std::find(std::begin(modes), std::end(modes), trigger.mode) - std::begin(modes)];
+            return 0;
+        }
+        if (int error = singleArgument(command)) return error;
+        int mode = choice(command.arguments[0], {"AUTO", "NORMal", "SINGle"});
+        if (mode < 0 ||
+            std::find(spec->triggerModes.begin(), spec->triggerModes.end(), modes[mode]) == spec->triggerModes.end())
+            return -224;
+        trigger.mode = modes[mode];
+        int error = deviceError(dsoControl->setTriggerMode(trigger.mode));
+        emit triggerChanged(trigger);
+        return error;
+    }
+    if (command.is(1, "SOURce")) {
+        if (command.query) {
+            if (trigger.special)
+                response = "\"" + QByteArray(spec->specialTriggerChannels[trigger.source].name.c_str()) + "\"";
+            else
+                response = "CHAN" + QByteArray::number(trigger.source + 1);
+            return 0;
+        }
+        if (int error = singleArgument(command)) return error;
+        const QByteArray &argument = command.arguments[0];
+        ScpiCommand::Node node;
+        bool special = false;
+        unsigned id = 0;
+        if (scpiNode(argument, node) && scpiMatches(node.mnemonic, "CHANnel") && node.suffix >= 1 &&
+            unsigned(node.suffix) <= triggerChannels) {
+            id = unsigned(node.suffix - 1);
+        } else {
+            special = true;
+            while (id < spec->specialTriggerChannels.size() &&
+                   QByteArray(spec->specialTriggerChannels[id].name.c_str()).toUpper() != argument.toUpper())
+                ++id;
+            if (id >= spec->specialTriggerChannels.size()) return -224;
+        }
+        trigger.special = special;
+        trigger.source = id;
+        int error = deviceError(dsoControl->setTriggerSource(special, id));
+        emit triggerChanged(trigger);
+        return error;
+    }
+    if (command.is(1, "SLOPe")) {
+        if (command.query) {
+            response = trigger.slope == Dso::Slope::Positive ? "POS" : "NEG";
+            return 0;
+        }
+        if (int error = singleArgument(command)) return error;
+        int slope = choice(command.arguments[0], {"POSitive", "NEGative"});
+        if (slope < 0) return -224;
+        trigger.slope = slope == 0 ? Dso::Slope::Positive : Dso::Slope::Negative;
+        int error = deviceError(dsoControl->setTriggerSlope(trigger.slope));
+        emit triggerChanged(trigger);
+        return error;
+    }
+    if (command.is(1, "LEVel")) {
+        // The level of the trigger source if no channel is given
+        size_t channelIndex = command.query ? 0 : 1;
+        ChannelID channel = trigger.special ? 0 : trigger.source;
+        if (command.arguments.size() > channelIndex) {
+            if (int error = channelArgument(command, channelIndex, channel)) return error;
+        }
+        if (channel >= triggerChannels) return -224;
+        if (command.query) {
+            if (command.arguments.size() > 1) return -108;
+            response = scpiFormat(scope.voltage[channel].trigger);
+            return 0;
+        }
+        if (command.arguments.empty()) return -109;
+        if (command.arguments.size() > 2) return -108;
+        double level;
+        if (!scpiNumber(command.arguments[0], level)) return -104;
+        scope.voltage[channel].trigger = level;
+        int error = 0;
+        if (channel < spec->channels) error = deviceError(dsoControl->setTriggerLevel(channel, level));
+        emit triggerLevelChanged(channel, level);
+        return error;
+    }
+    if (command.is(1, "POSition")) {
+        if (command.query) {
+            response = scpiFormat(trigger.position);
+            return 0;
+        }
+        if (int error = singleArgument(command)) return error;
+        double position;
+        if (!scpiNumber(command.arguments[0], position)) return -104;
+        if (position < 0.0 || position > 1.0) return -222;
+        trigger.position = position;
+        int error = deviceError(dsoControl->setPretriggerPosition(position * scope.horizontal.timebase * DIVS_TIME));
+        emit triggerChanged(trigger);
+        return error;
+    }
+    return -113;
+}
+
+int ScpiServer::executeAcquire(const ScpiCommand &command, QByteArray &response) {
+    DsoSettingsScopeHorizontal &horizontal = scope.horizontal;
+    if (command.header.size() != 2) return -113;
+
+    if (command.is(0, "TIMebase")) {
+        if (!command.is(1, "SCALe")) return -113;
+        if (command.query) {
+            response = scpiFormat(horizontal.timebase);
+            return 0;
+        }
+        if (int error = singleArgument(command)) return error;
+        double timebase;
+        if (!scpiNumber(command.arguments[0], timebase)) return -104;
+        if (!(timebase > 0.0)) return -222;
+        horizontal.samplerateSource = DsoSettingsScopeHorizontal::Duration;
+        horizontal.timebase = timebase;
+        int error = deviceError(dsoControl->setRecordTime(timebase * DIVS_TIME));
+        emit horizontalChanged(horizontal);
+        return error;
+    }
+
+    if (command.is(1, "SRATe")) {
+        if (command.query) {
+            response = scpiFormat(dsoControl->getDeviceSettings()->samplerate.current);
+            return 0;
+        }
+        if (int error = singleArgument(command)) return error;
+        double samplerate;
+        if (!scpiNumber(command.arguments[0], samplerate)) return -104;
+        if (!(samplerate > 0.0)) return -222;
+        horizontal.samplerateSource = DsoSettingsScopeHorizontal::Samplerrate;
+        horizontal.samplerate = samplerate;
+        int error = deviceError(dsoControl->setSamplerate(samplerate));
+        emit horizontalChanged(horizontal);
+        return error;
+    }
+    if (command.is(1, "COUNt") && command.query) {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        response = QByteArray::number(qulonglong(frameCount));
+        return 0;
+    }
+    if (command.is(1, "STATe") && command.query) {
+        response = dsoControl->isSampling() ? "RUN" : "STOP";
+        return 0;
+    }
+    return -113;
+}
+
+int ScpiServer::executeMeasure(const ScpiCommand &command, QByteArray &response) {
+    if (command.header.size() != 2 || !command.query) return -113;
+    const MeasurementItem *item = nullptr;
+    for (const MeasurementItem &candidate : measurementItems)
+        if (command.is(1, candidate.mnemonic)) item = &candidate;
+    if (!item) return -113;
+
+    ChannelID channel;
+    if (int error = channelArgument(command, 0, channel)) return error;
+    if (command.arguments.size() > 1) return -108;
+
+    std::shared_ptr<PPresult> frame;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        frame = result;
+    }
+    if (!frame || channel >= frame->channelCount() || !frame->data(channel)->measurements.valid) return -230;
+    response = scpiFormat(item->value(*frame->data(channel)));
+    return 0;
+}
+
+int ScpiServer::executeWaveform(const ScpiCommand &command, QByteArray &response) {
+    if (command.header.size() != 2 || !command.query) return -113;
+    if (command.is(1, "TIMestamp")) {
+        if (!command.arguments.empty()) return -108;
+        std::lock_guard<std::mutex> lock(resultMutex);
+        if (!result) return -230;
+        response = QByteArray::number(qlonglong(result->timestamp));
+        return 0;
+    }
+    bool spectrum = command.is(1, "SPECtrum") || command.is(1, "FINCrement");
+    if (!spectrum && !command.is(1, "DATA") && !command.is(1, "XINCrement") && !command.is(1, "POINts"))
+        return -113;
+
+    ChannelID channel;
+    if (int error = channelArgument(command, 0, channel)) return error;
+    if (command.arguments.size() > 1) return -108;
+
+    std::shared_ptr<PPresult> frame;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        frame = result;
+    }
+    if (!frame || channel >= frame->channelCount()) return -230;
+    const SampleValues &values = spectrum ? frame->data(channel)->spectrum : frame->data(channel)->voltage;
+    if (values.sample.empty()) return -230;
+
+    if (command.is(1, "DATA") || command.is(1, "SPECtrum"))
+        response = floatBlock(values.sample);
+    else if (command.is(1, "POINts"))
+        response = QByteArray::number(qulonglong(values.sample.size()));
+    else
+        response = scpiFormat(values.interval);
+    return 0;
+}
+
+int ScpiServer::channelArgument(const ScpiCommand &command, size_t index, ChannelID &channel) const {
+    channel = 0;
+    if (command.arguments.size() <= index) return 0;
+    ScpiCommand::Node node;
+    if (!scpiNode(command.arguments[index], node) || !scpiMatches(node.mnemonic, "CHANnel")) return -224;
+    int suffix = node.suffix < 0 ? 1 : node.suffix;
+    if (suffix < 1 || unsigned(suffix) > scope.voltage.size()) return -224;
+    channel = ChannelID(suffix - 1);
+    return 0;
+}
+
+int ScpiServer::updateUsedChannels(ChannelID channel) {
+    bool mathUsed = scope.anyUsed(spec->channels);
+
+    // Normal channel, check if voltage/spectrum or math channel is used
+    if (channel < spec->channels)
+        return deviceError(dsoControl->setChannelUsed(channel, mathUsed | scope.anyUsed(channel)));
+    // Math channel, update all channels
+    int error = 0;
+    for (ChannelID c = 0; c < spec->channels; ++c) {
+        int channelError = deviceError(dsoControl->setChannelUsed(c, mathUsed | scope.anyUsed(c)));
+        if (!error) error = channelError;
+    }
+    return error;
+}
+
+int ScpiServer::deviceError(Dso::ErrorCode errorCode) const {
+    switch (errorCode) {
+    case Dso::ErrorCode::NONE:
+    // Like in the GUI, the setting is used nevertheless: The software trigger or the graph takes care of it
+    case Dso::ErrorCode::UNSUPPORTED:
+        return 0;
+    case Dso::ErrorCode::PARAMETER:
+        return -222;
+    case Dso::ErrorCode::CONNECTION:
+    default:
+        return -240;
+    }
+}
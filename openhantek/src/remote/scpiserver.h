@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "hantekdso/errorcodes.h"
+#include "hantekprotocol/types.h"
+#include "scopesettings.h"
+
+class DsoSettings;
+class HantekDsoControl;
+class PPresult;
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+struct ScpiCommand;
+namespace Dso {
+struct ControlSpecification;
+}
+
+/// \brief Remote control of the oscilloscope with SCPI commands, like the instruments of the lab bench.
+/// Programs connect to a TCP port on localhost or to a local socket and send lines of commands
+/// ("CHAN1:SCAL 0.5;:TRIG:MODE AUTO"). The commands of all lines are executed in order, each query answers
+/// with one line. The server lives in the thread of the HantekDsoControl and calls its slots directly, so
+/// the commands don't block the GUI. The settings belong to the GUI thread: Before a batch of lines is
+/// executed, the server copies them there and works with the copy. A changed value is sent with a signal,
+/// the main window stores it in the settings and shows it. See readme.md for the commands.
+class ScpiServer : public QObject {
+    Q_OBJECT
+  public:
+    ScpiServer(HantekDsoControl *dsoControl, const DsoSettings *settings, QObject *parent = nullptr);
+    ~ScpiServer();
+
+  public slots:
+    /// Starts listening on a TCP port of localhost if the address is a number, on a local socket otherwise.
+    void listen(const QString &address);
+    /// Stops listening and disconnects the clients, in the thread of the server.
+    void close();
+    /// Keeps the frame for the measurement and waveform queries. Called in the post processing thread.
+    void input(std::shared_ptr<PPresult> data);
+
+  signals:
+    /// A voltage channel has been turned on or off
+    void usedChanged(ChannelID channel, bool used);
+    /// The gain step of a voltage channel has been changed
+    void gainChanged(ChannelID channel, unsigned gainStepIndex);
+    /// The offset of a voltage channel has been changed
+    void offsetChanged(ChannelID channel, double offset);
+    /// The coupling of a physical channel has been changed
+    void couplingChanged(ChannelID channel, unsigned couplingOrMathIndex);
+    /// The trigger mode, source, slope or position has been changed
+    void triggerChanged(const DsoSettingsScopeTrigger &trigger);
+    /// The trigger level of a channel has been changed
+    void triggerLevelChanged(ChannelID channel, double level);
+    /// The samplerate or the timebase has been changed
+    void horizontalChanged(const DsoSettingsScopeHorizontal &horizontal);
+
+  private:
+    struct Connection {
+        QIODevice *socket;
+        QByteArray buffer;      ///< Received characters of the incomplete line
+        std::deque<int> errors; ///< The error queue read by SYSTem:ERRor?
+        /// The settings for the complete lines are being copied in the GUI thread
+        bool waitingForSettings;
+    };
+
+    void addConnection(QIODevice *socket);
+    void readCommands(Connection *connection);
+    /// Executes the complete lines of the connection with the settings copied in the GUI thread.
+    void executeCommands(Connection *connection, const DsoSettingsScope &settingsScope);
+    static void pushError(Connection *connection, int error);
+
+    /// \brief Executes a command and appends the answer of a query to the response.
+    /// \return 0 or the number of the SCPI error.
+    int execute(Connection *connection, const ScpiCommand &command, QByteArray &response);
+    int executeChannel(const ScpiCommand &command, QByteArray &response);
+    int executeTrigger(const ScpiCommand &command, QByteArray &response);
+    int executeAcquire(const ScpiCommand &command, QByteArray &response);
+    int executeMeasure(const ScpiCommand &command, QByteArray &response);
+    int executeWaveform(const ScpiCommand &command, QByteArray &response);
+
+    /// \brief Reads a channel argument "CHANnel<n>" into a zero based channel, the first channel if it is
+    /// missing. \return 0 or the number of the SCPI error.
+    int channelArgument(const ScpiCommand &command, size_t index, ChannelID &channel) const;
+    /// Tells the device which channels are sampled after a voltage or math channel has been turned on or off.
+    int updateUsedChannels(ChannelID channel);
+    int deviceError(Dso::ErrorCode errorCode) const;
+
+    HantekDsoControl *dsoControl;
+    const DsoSettings *settings; ///< Only read in the GUI thread
+    const Dso::ControlSpecification *spec;
+    DsoSettingsScope scope; ///< The copy of the settings for the lines that are executed
+
+    QTcpServer *tcpServer = nullptr;
+    QLocalServer *localServer = nullptr;
+
+    std::mutex resultMutex;
+    std::shared_ptr<PPresult> result; ///< The latest frame
+    uint64_t frameCount = 0;          ///< Number of frames processed since the start
+};
+
+Q_DECLARE_METATYPE(DsoSettingsScopeTrigger)
+Q_DECLARE_METATYPE(DsoSettingsScopeHorizontal)
@@ -48,6 +48,13 @@ struct DsoSettingsScopeTrigger {
     bool special = false;             ///< true if the trigger source is not a standard channel
     unsigned swTriggerThreshold = 7;  ///< Software trigger, threshold
     unsigned swTriggerSampleSet = 11; ///< Software trigger, sample set
+    double swTriggerHysteresis = 0.1; ///< Software trigger, hysteresis in divs
+    Dso::TriggerType swTriggerType = Dso::TriggerType::Edge; ///< Software trigger, event type
+    Dso::PulseCondition swTriggerPulseCondition = Dso::PulseCondition::Shorter;  ///< Software trigger, pulse width
+    Dso::WindowCondition swTriggerWindowCondition = Dso::WindowCondition::Enter; ///< Software trigger, window
+    double swTriggerTime = 1e-3;      ///< Software trigger, pulse width or timeout in s
+    double swTriggerTimeUpper = 2e-3; ///< Software trigger, upper pulse width for PulseCondition::Inside in s
+    double swTriggerLevelUpper = 1.0; ///< Software trigger, second level for runt and window triggers in V
 };
 
 /// \brief Base for DsoSettingsScopeSpectrum and DsoSettingsScopeVoltage
@@ -83,7 +90,7 @@ struct DsoSettingsScope {
     DsoSettingsScopeTrigger trigger;                                ///< Settings for the trigger
 
     double gain(unsigned channel) const { return gainSteps[voltage[channel].gainStepIndex]; }
-    bool anyUsed(ChannelID channel) { return voltage[channel].used | spectrum[channel].used; }
+    bool anyUsed(ChannelID channel) const { return voltage[channel].used | spectrum[channel].used; }
 
     Dso::Coupling coupling(ChannelID channel, const Dso::ControlSpecification *deviceSpecification) const {
         return deviceSpecification->couplings[voltage[channel].couplingOrMathIndex];
@@ -22,8 +22,14 @@ SelectSupportedDevice::SelectSupportedDevice(QWidget *parent) :
     ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
     qRegisterMetaType<UniqueUSBid>("UniqueUSBid");
     connect(ui->buttonBox, &QDialogButtonBox::accepted, [this]() {
-        if (ui->cmbDevices->currentIndex()!=-1) {
-            selectedDevice = ui->cmbDevices->currentData(Qt::UserRole).value<UniqueUSBid>();
+        if (ui->chkAllDevices->isChecked()) {
+            QAbstractItemModel *model = ui->cmbDevices->model();
+            for (int row = 0; row < model->rowCount(); ++row) {
+                if (model->index(row, 0).data(Qt::UserRole+1).toBool())
+                    selectedDevices.push_back(model->index(row, 0).data(Qt::UserRole).value<UniqueUSBid>());
+            }
+        } else if (ui->cmbDevices->currentIndex()!=-1) {
+            selectedDevices.push_back(ui->cmbDevices->currentData(Qt::UserRole).value<UniqueUSBid>());
         }
         QCoreApplication::instance()->quit();
     });
@@ -36,7 +42,7 @@ SelectSupportedDevice::SelectSupportedDevice(QWidget *parent) :
     });
 }
 
-std::unique_ptr<USBDevice> SelectSupportedDevice::showSelectDeviceModal(libusb_context *context)
+std::vector<std::unique_ptr<USBDevice>> SelectSupportedDevice::showSelectDevicesModal(libusb_context *context)
 {
     newDeviceFromExistingDialog->setUSBcontext(context);
     std::unique_ptr<FindDevices> findDevices = std::unique_ptr<FindDevices>(new FindDevices(context));
@@ -78,9 +84,7 @@ std::unique_ptr<USBDevice> SelectSupportedDevice::showSelectDeviceModal(libusb_c
 
     updateSupportedDevices();
 
-    QTimer timer;
-    timer.setInterval(1000);
-    connect(&timer, &QTimer::timeout, [this, &model, &findDevices, &messageNoDevices]() {
+    auto updateDevices = [this, &model, &findDevices, &messageNoDevices]() {
         if (findDevices->updateDeviceList())
             model->updateDeviceList();
         if (model->rowCount(QModelIndex())) {
@@ -88,16 +92,30 @@ std::unique_ptr<USBDevice> SelectSupportedDevice::showSelectDeviceModal(libusb_c
         } else {
             ui->labelReadyState->setText(messageNoDevices);
         }
-    });
-    timer.start();
-    QCoreApplication::sendEvent(&timer, new QTimerEvent(timer.timerId())); // immediate timer event
+    };
+
+    // Wait for hotplug events, or enumerate the bus every second if the platform doesn't support them.
+    // The timer is the context of the queued events, they are dropped with it before the locals are gone.
+    QTimer timer;
+    timer.setInterval(1000);
+    connect(&timer, &QTimer::timeout, updateDevices);
+    if (findDevices->enableHotplug() == LIBUSB_SUCCESS)
+        connect(findDevices.get(), &FindDevices::devicesChanged, &timer, updateDevices, Qt::QueuedConnection);
+    else
+        timer.start();
+    updateDevices();
 
     show();
     QCoreApplication::instance()->exec();
     timer.stop();
     close();
 
-    return findDevices->takeDevice(selectedDevice);
+    std::vector<std::unique_ptr<USBDevice>> devices;
+    for (UniqueUSBid id : selectedDevices) {
+        std::unique_ptr<USBDevice> device = findDevices->takeDevice(id);
+        if (device) devices.push_back(std::move(device));
+    }
+    return devices;
 }
 
 void SelectSupportedDevice::showLibUSBFailedDialogModel(int error)
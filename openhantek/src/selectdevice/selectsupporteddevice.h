@@ -6,6 +6,7 @@
 #include <QDialog>
 
 #include <memory>
+#include <vector>
 #include "usb/usbdevice.h"
 
 struct libusb_context;
@@ -16,8 +17,10 @@ class NewDeviceModelFromExisting;
  * the method will block and show a dialog for selection or for a usb error
  * message. The method returns as soon as the user closes the dialog.
  *
- * An example to get a user selected device:
- * std::unique_ptr<USBDevice> device = SelectDevice().showSelectDeviceModal(context);
+ * An example to get the user selected devices:
+ * std::vector<std::unique_ptr<USBDevice>> devices = SelectSupportedDevice().showSelectDevicesModal(context);
+ *
+ * The list contains one device, or all ready devices if the user wants to use them at the same time.
  */
 class SelectSupportedDevice : public QDialog
 {
@@ -25,12 +28,12 @@ class SelectSupportedDevice : public QDialog
 
 public:
     explicit SelectSupportedDevice(QWidget *parent = 0);
-    std::unique_ptr<USBDevice> showSelectDeviceModal(libusb_context *context);
+    std::vector<std::unique_ptr<USBDevice>> showSelectDevicesModal(libusb_context *context);
     void showLibUSBFailedDialogModel(int error);
 private:
     void updateDeviceList();
     void updateSupportedDevices();
     std::unique_ptr<Ui::SelectSupportedDevice> ui;
-    UniqueUSBid selectedDevice = 0;
+    std::vector<UniqueUSBid> selectedDevices;
     NewDeviceModelFromExisting* newDeviceFromExistingDialog;
 };
@@ -11,7 +11,8 @@
 
 /// \brief Set the number of channels.
 /// \param channels The new channel count, that will be applied to lists.
-DsoSettings::DsoSettings(const Dso::ControlSpecification* deviceSpecification) {
+DsoSettings::DsoSettings(const Dso::ControlSpecification* deviceSpecification, const QString &profile)
+    : profile(profile) {
     // Add new channels to the list
     while (scope.spectrum.size() < deviceSpecification->channels) {
         // Spectrum
@@ -44,7 +45,9 @@ DsoSettings::DsoSettings(const Dso::ControlSpecification* deviceSpecification) {
     view.print.voltage.push_back(view.screen.voltage.back());
     view.print.spectrum.push_back(view.print.voltage.back().darker());
 
+    post.filter.resize(scope.voltage.size());
 
+    if (!profile.isEmpty()) store->beginGroup(profile);
     load();
 }
 
@@ -54,6 +57,8 @@ bool DsoSettings::setFilename(const QString &filename) {
         qWarning() << "Could not change the settings file to " << filename;
         return false;
     }
+    // The file keeps the settings of the devices apart as well
+    if (!profile.isEmpty()) local->beginGroup(profile);
     store.swap(local);
     return true;
 }
@@ -66,6 +71,7 @@ void DsoSettings::load() {
 
     store->beginGroup("exporting");
     if (store->contains("imageSize")) exporting.imageSize = store->value("imageSize").toSize();
+    if (store->contains("exportSizeBytes")) exporting.exportSizeBytes = store->value("exportSizeBytes").toULongLong();
     store->endGroup();
 
     // Oscilloscope settings
@@ -92,6 +98,15 @@ void DsoSettings::load() {
     if (store->contains("slope")) scope.trigger.slope = (Dso::Slope)store->value("slope").toUInt();
     if (store->contains("source")) scope.trigger.source = store->value("source").toUInt();
     if (store->contains("special")) scope.trigger.special = store->value("special").toInt();
+    if (store->contains("swType")) scope.trigger.swTriggerType = (Dso::TriggerType)store->value("swType").toUInt();
+    if (store->contains("swPulseCondition"))
+        scope.trigger.swTriggerPulseCondition = (Dso::PulseCondition)store->value("swPulseCondition").toUInt();
+    if (store->contains("swWindowCondition"))
+        scope.trigger.swTriggerWindowCondition = (Dso::WindowCondition)store->value("swWindowCondition").toUInt();
+    if (store->contains("swTime")) scope.trigger.swTriggerTime = store->value("swTime").toDouble();
+    if (store->contains("swTimeUpper")) scope.trigger.swTriggerTimeUpper = store->value("swTimeUpper").toDouble();
+    if (store->contains("swLevelUpper")) scope.trigger.swTriggerLevelUpper = store->value("swLevelUpper").toDouble();
+    if (store->contains("swHysteresis")) scope.trigger.swTriggerHysteresis = store->value("swHysteresis").toDouble();
     store->endGroup();
     // Spectrum
     for (ChannelID channel = 0; channel < scope.spectrum.size(); ++channel) {
@@ -143,6 +158,37 @@ void DsoSettings::load() {
         post.spectrumReference = store->value("spectrumReference").toDouble();
     if (store->contains("spectrumWindow"))
         post.spectrumWindow = (Dso::WindowFunction)store->value("spectrumWindow").toInt();
+    if (store->contains("spectrumSinglePrecision"))
+        post.spectrumSinglePrecision = store->value("spectrumSinglePrecision").toBool();
+    if (store->contains("spectrumThreads")) post.spectrumThreads = store->value("spectrumThreads").toUInt();
+    if (store->contains("spectrumSegmentLength"))
+        post.spectrumSegmentLength = store->value("spectrumSegmentLength").toUInt();
+    if (store->contains("spectrumOverlap")) post.spectrumOverlap = store->value("spectrumOverlap").toDouble();
+    if (store->contains("spectrumAveraging"))
+        post.spectrumAveraging = (Dso::SpectrumAveraging)store->value("spectrumAveraging").toInt();
+    if (store->contains("spectrumFrames")) post.spectrumFrames = store->value("spectrumFrames").toUInt();
+    if (store->contains("spectrumZoom")) post.spectrumZoom = store->value("spectrumZoom").toBool();
+    if (store->contains("spectrumDecimation"))
+        post.spectrumDecimation = store->value("spectrumDecimation").toUInt();
+    if (store->contains("spectrogram")) post.spectrogram = store->value("spectrogram").toBool();
+    if (store->contains("spectrogramRows")) post.spectrogramRows = store->value("spectrogramRows").toUInt();
+    if (store->contains("envelope")) post.envelope = store->value("envelope").toBool();
+    if (store->contains("envelopeFrames")) post.envelopeFrames = store->value("envelopeFrames").toUInt();
+    if (store->contains("mathExpression")) {
+        QMutexLocker locker(&post.mathExpressionMutex);
+        post.mathExpression = store->value("mathExpression").toString();
+    }
+    for (ChannelID channel = 0; channel < post.filter.size(); ++channel) {
+        store->beginGroup(QString("filter%1").arg(channel));
+        DsoSettingsFilter &filter = post.filter[channel];
+        if (store->contains("type")) filter.type = (Dso::FilterType)store->value("type").toInt();
+        if (store->contains("design")) filter.design = (Dso::FilterDesign)store->value("design").toInt();
+        if (store->contains("frequency")) filter.frequency = store->value("frequency").toDouble();
+        if (store->contains("bandwidth")) filter.bandwidth = store->value("bandwidth").toDouble();
+        if (store->contains("order")) filter.order = store->value("order").toUInt();
+        if (store->contains("taps")) filter.taps = store->value("taps").toUInt();
+        store->endGroup();
+    }
     store->endGroup();
 
     // View
@@ -180,11 +226,14 @@ void DsoSettings::load() {
     if (store->contains("digitalPhosphor")) view.digitalPhosphor = store->value("digitalPhosphor").toBool();
     if (store->contains("interpolation"))
         view.interpolation = (Dso::InterpolationMode)store->value("interpolation").toInt();
+    if (store->contains("dotSize")) view.dotSize = store->value("dotSize").toUInt();
     if (store->contains("screenColorImages")) view.screenColorImages = store->value("screenColorImages").toBool();
     if (store->contains("zoom")) view.zoom = store->value("zoom").toBool();
     if (store->contains("cursorGridPosition"))
         view.cursorGridPosition = (Qt::ToolBarArea)store->value("cursorGridPosition").toUInt();
     if (store->contains("cursorsVisible")) view.cursorsVisible = store->value("cursorsVisible").toBool();
+    if (store->contains("detailedMeasurements"))
+        view.detailedMeasurements = store->value("detailedMeasurements").toBool();
     store->endGroup();
 
     store->beginGroup("window");
@@ -201,6 +250,7 @@ void DsoSettings::save() {
 
     store->beginGroup("exporting");
     store->setValue("imageSize", exporting.imageSize);
+    store->setValue("exportSizeBytes", (qulonglong)exporting.exportSizeBytes);
     store->endGroup();
 
     // Oszilloskope settings
@@ -223,6 +273,13 @@ void DsoSettings::save() {
     store->setValue("slope", (unsigned)scope.trigger.slope);
     store->setValue("source", scope.trigger.source);
     store->setValue("special", scope.trigger.special);
+    store->setValue("swType", (unsigned)scope.trigger.swTriggerType);
+    store->setValue("swPulseCondition", (unsigned)scope.trigger.swTriggerPulseCondition);
+    store->setValue("swWindowCondition", (unsigned)scope.trigger.swTriggerWindowCondition);
+    store->setValue("swTime", scope.trigger.swTriggerTime);
+    store->setValue("swTimeUpper", scope.trigger.swTriggerTimeUpper);
+    store->setValue("swLevelUpper", scope.trigger.swTriggerLevelUpper);
+    store->setValue("swHysteresis", scope.trigger.swTriggerHysteresis);
     store->endGroup();
     // Spectrum
     for (ChannelID channel = 0; channel < scope.spectrum.size(); ++channel) {
@@ -268,6 +325,30 @@ void DsoSettings::save() {
     store->setValue("spectrumLimit", post.spectrumLimit);
     store->setValue("spectrumReference", post.spectrumReference);
     store->setValue("spectrumWindow", (int)post.spectrumWindow);
+    store->setValue("spectrumSinglePrecision", post.spectrumSinglePrecision);
+    store->setValue("spectrumThreads", post.spectrumThreads);
+    store->setValue("spectrumSegmentLength", post.spectrumSegmentLength);
+    store->setValue("spectrumOverlap", post.spectrumOverlap);
+    store->setValue("spectrumAveraging", (int)post.spectrumAveraging);
+    store->setValue("spectrumFrames", post.spectrumFrames);
+    store->setValue("spectrumZoom", post.spectrumZoom);
+    store->setValue("spectrumDecimation", post.spectrumDecimation);
+    store->setValue("spectrogram", post.spectrogram);
+    store->setValue("spectrogramRows", post.spectrogramRows);
+    store->setValue("envelope", post.envelope);
+    store->setValue("envelopeFrames", post.envelopeFrames);
+    store->setValue("mathExpression", post.mathExpression);
+    for (ChannelID channel = 0; channel < post.filter.size(); ++channel) {
+        store->beginGroup(QString("filter%1").arg(channel));
+        const DsoSettingsFilter &filter = post.filter[channel];
+        store->setValue("type", (int)filter.type);
+        store->setValue("design", (int)filter.design);
+        store->setValue("frequency", filter.frequency);
+        store->setValue("bandwidth", filter.bandwidth);
+        store->setValue("order", filter.order);
+        store->setValue("taps", filter.taps);
+        store->endGroup();
+    }
     store->endGroup();
 
     // View
@@ -302,10 +383,12 @@ void DsoSettings::save() {
     // Other view settings
     store->setValue("digitalPhosphor", view.digitalPhosphor);
     store->setValue("interpolation", view.interpolation);
+    store->setValue("dotSize", view.dotSize);
     store->setValue("screenColorImages", view.screenColorImages);
     store->setValue("zoom", view.zoom);
     store->setValue("cursorGridPosition", view.cursorGridPosition);
     store->setValue("cursorsVisible", view.cursorsVisible);
+    store->setValue("detailedMeasurements", view.detailedMeasurements);
     store->endGroup();
 
     store->beginGroup("window");
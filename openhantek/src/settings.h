@@ -15,7 +15,9 @@
 /// \brief Holds the settings of the program.
 class DsoSettings {
   public:
-    explicit DsoSettings(const Dso::ControlSpecification *deviceSpecification);
+    /// \param profile A group of the settings store, keeps the settings of several devices apart. The first device
+    /// uses the top level.
+    explicit DsoSettings(const Dso::ControlSpecification *deviceSpecification, const QString &profile = QString());
     bool setFilename(const QString &filename);
 
     DsoSettingsExport exporting;    ///< General options of the program
@@ -34,5 +36,6 @@ class DsoSettings {
     void save();
 
   private:
+    const QString profile; ///< The group of the settings store, empty for the top level
     std::unique_ptr<QSettings> store = std::unique_ptr<QSettings>(new QSettings);
 };
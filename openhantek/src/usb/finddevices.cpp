@@ -14,10 +14,63 @@
 
 #include "modelregistry.h"
 
-FindDevices::FindDevices(libusb_context *context) : context(context) {}
+namespace {
+inline uint32_t usbKey(long vendorID, long productID) { return ((uint32_t)vendorID << 16) | (uint16_t)productID; }
+} // namespace
+
+FindDevices::FindDevices(libusb_context *context) : context(context), stopEvents(false) {
+    for (DSOModel *model : ModelRegistry::get()->models()) {
+        // Devices without firmware have different VID/PIDs
+        models[usbKey(model->vendorID, model->productID)] = model;
+        models[usbKey(model->vendorIDnoFirmware, model->productIDnoFirmware)] = model;
+    }
+}
+
+FindDevices::~FindDevices() {
+    if (hotplug) {
+        // Deregistering wakes up the event thread, the timeout of the event handling limits the wait otherwise
+        stopEvents = true;
+        libusb_hotplug_deregister_callback(context, hotplugHandle);
+        eventThread.join();
+    }
+    for (const std::pair<libusb_device *, bool> &change : pending) libusb_unref_device(change.first);
+}
+
+DSOModel *FindDevices::findModel(libusb_device *device) const {
+    struct libusb_device_descriptor descriptor;
+    if (libusb_get_device_descriptor(device, &descriptor) != LIBUSB_SUCCESS) return nullptr;
+
+    auto model = models.find(usbKey(descriptor.idVendor, descriptor.idProduct));
+    return model != models.end() ? model->second : nullptr;
+}
 
 // Iterate through all usb devices
 int FindDevices::updateDeviceList() {
+    if (hotplug) {
+        std::vector<std::pair<libusb_device *, bool>> changes;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            changes.swap(pending);
+        }
+
+        for (const std::pair<libusb_device *, bool> &change : changes) {
+            libusb_device *device = change.first;
+            if (change.second) {
+                devices[USBDevice::computeUSBdeviceID(device)] =
+                    std::unique_ptr<USBDevice>(new USBDevice(findModel(device), device, findIteration));
+            } else {
+                for (DeviceList::iterator it = devices.begin(); it != devices.end(); ++it) {
+                    if (it->second->getRawDevice() == device) {
+                        devices.erase(it);
+                        break;
+                    }
+                }
+            }
+            libusb_unref_device(device);
+        }
+        return (int)changes.size();
+    }
+
     libusb_device **deviceList;
     ssize_t deviceCount = libusb_get_device_list(context, &deviceList);
     if (deviceCount < 0) {
@@ -29,9 +82,6 @@ int FindDevices::updateDeviceList() {
 
     for (ssize_t deviceIterator = 0; deviceIterator < deviceCount; ++deviceIterator) {
         libusb_device *device = deviceList[deviceIterator];
-        // Get device descriptor
-        struct libusb_device_descriptor descriptor;
-        libusb_get_device_descriptor(device, &descriptor);
 
         DeviceList::const_iterator inList = devices.find(USBDevice::computeUSBdeviceID(device));
 
@@ -40,15 +90,10 @@ int FindDevices::updateDeviceList() {
             continue;
         }
 
-        for (DSOModel* model : ModelRegistry::get()->models()) {
-            // Check VID and PID for firmware flashed devices
-            bool supported = descriptor.idVendor == model->vendorID && descriptor.idProduct == model->productID;
-            // Devices without firmware have different VID/PIDs
-            supported |= descriptor.idVendor == model->vendorIDnoFirmware && descriptor.idProduct == model->productIDnoFirmware;
-            if (supported) {
-                ++changes;
-                devices[USBDevice::computeUSBdeviceID(device)] = std::unique_ptr<USBDevice>(new USBDevice(model, device, findIteration));
-            }
+        DSOModel *model = findModel(device);
+        if (model) {
+            ++changes;
+            devices[USBDevice::computeUSBdeviceID(device)] = std::unique_ptr<USBDevice>(new USBDevice(model, device, findIteration));
         }
     }
 
@@ -67,6 +112,45 @@ int FindDevices::updateDeviceList() {
     return changes;
 }
 
+int FindDevices::enableHotplug() {
+    if (hotplug) return LIBUSB_SUCCESS;
+    if (!libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) return LIBUSB_ERROR_NOT_SUPPORTED;
+
+    // The devices found so far are reported again by the enumeration of the registration
+    devices.clear();
+    int errorCode = libusb_hotplug_register_callback(
+        context, (libusb_hotplug_event)(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+        LIBUSB_HOTPLUG_ENUMERATE, LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+        &FindDevices::hotplugCallback, this, &hotplugHandle);
+    if (errorCode != LIBUSB_SUCCESS) return errorCode;
+
+    hotplug = true;
+    eventThread = std::thread(&FindDevices::handleEvents, this);
+    return LIBUSB_SUCCESS;
+}
+
+int LIBUSB_CALL FindDevices::hotplugCallback(libusb_context *, libusb_device *device, libusb_hotplug_event event,
+                                             void *userData) {
+    FindDevices *self = static_cast<FindDevices *>(userData);
+    if (!self->findModel(device)) return 0;
+
+    // Only queue the change, the devices are created and removed in the thread of updateDeviceList()
+    libusb_ref_device(device);
+    {
+        std::lock_guard<std::mutex> lock(self->pendingMutex);
+        self->pending.emplace_back(device, event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED);
+    }
+    emit self->devicesChanged();
+    return 0;
+}
+
+void FindDevices::handleEvents() {
+    while (!stopEvents) {
+        struct timeval timeout = {0, 250000};
+        libusb_handle_events_timeout_completed(context, &timeout, nullptr);
+    }
+}
+
 const FindDevices::DeviceList* FindDevices::getDevices()
 {
     return &devices;
@@ -76,5 +160,7 @@ std::unique_ptr<USBDevice> FindDevices::takeDevice(UniqueUSBid id)
 {
     DeviceList::iterator i = devices.find(id);
     if (i==devices.end()) return nullptr;
-    return std::move(i->second);
+    std::unique_ptr<USBDevice> device = std::move(i->second);
+    devices.erase(i);
+    return device;
 }
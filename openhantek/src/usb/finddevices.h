@@ -2,10 +2,17 @@
 
 #pragma once
 
+#include <QObject>
 #include <QString>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <map>
 #include <list>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "usbdevice.h"
 
@@ -16,26 +23,60 @@ struct libusb_context;
  * Use usually want to call `updateDeviceList` and then retrieve the list via `getDevices`.
  * You can call `updateDeviceList` as often as you want.
  * If you have found your favorite device, you want to call `takeDevice`. The device will
- * not be available in `getDevices` anymore and this will not change with calls to `updateDeviceList`.
+ * not be available in `getDevices` anymore, until it is found again by a later `updateDeviceList`.
+ *
+ * Instead of enumerating the bus on every `updateDeviceList`, you can call `enableHotplug`. libusb
+ * then reports the supported devices that arrive or leave, `devicesChanged` is emitted and the next
+ * `updateDeviceList` only applies these changes.
  *
  * Do not close the given usb context before this class object is destroyed.
  */
-class FindDevices{
+class FindDevices : public QObject {
+    Q_OBJECT
   public:
     typedef std::map<UniqueUSBid, std::unique_ptr<USBDevice>> DeviceList;
     FindDevices(libusb_context *context);
+    ~FindDevices();
     /// Updates the device list. To clear the list, just dispose this object
     /// \return If negative it represents a libusb error code otherwise the amount of updates
     int updateDeviceList();
+    /**
+     * @brief Registers for hotplug events and handles the libusb events in a thread of its own.
+     * The devices that are already plugged in are reported as arrived.
+     * @return LIBUSB_SUCCESS, LIBUSB_ERROR_NOT_SUPPORTED if the platform has no hotplug support,
+     * or another libusb error code. Keep on enumerating with `updateDeviceList` on errors.
+     */
+    int enableHotplug();
+    inline bool isHotplugEnabled() const { return hotplug; }
     const DeviceList *getDevices();
     /**
      * @brief takeDevice
      * @param id The unique usb id for the current bus layout
-     * @return A shared reference to the
+     * @return The device, removed from the list. nullptr if there is no device with this id.
      */
     std::unique_ptr<USBDevice> takeDevice(UniqueUSBid id);
+  signals:
+    /// A supported device arrived or left, call `updateDeviceList`. Emitted in the libusb event thread.
+    void devicesChanged();
+
   private:
+    static int LIBUSB_CALL hotplugCallback(libusb_context *context, libusb_device *device,
+                                           libusb_hotplug_event event, void *userData);
+    /// \return The model with the vendor and product id of the device, nullptr for unsupported devices.
+    DSOModel *findModel(libusb_device *device) const;
+    void handleEvents();
+
     libusb_context *context; ///< The usb context used for this device
     DeviceList devices;
     unsigned findIteration = 0;
+    /// The supported models by vendor and product id, with and without firmware
+    std::map<uint32_t, DSOModel *> models;
+
+    bool hotplug = false;
+    libusb_hotplug_callback_handle hotplugHandle;
+    std::thread eventThread;
+    std::atomic<bool> stopEvents;
+    std::mutex pendingMutex;
+    /// Devices that arrived (true) or left (false) since the last update, referenced until they are applied
+    std::vector<std::pair<libusb_device *, bool>> pending;
 };
@@ -93,13 +93,19 @@ bool USBDevice::connectDevice(QString &errorMessage) {
                            .arg(libUsbErrorString(errorCode))
                            .arg(libusb_get_bus_number(device), 3, 10, QLatin1Char('0'))
                            .arg(libusb_get_device_address(device), 3, 10, QLatin1Char('0'));
+        // Not connected, a later attempt opens the device again
+        libusb_close(handle);
+        handle = nullptr;
         return false;
     }
 
     return true;
 }
 
-USBDevice::~USBDevice() { disconnectFromDevice(); }
+USBDevice::~USBDevice() {
+    disconnectFromDevice();
+    libusb_unref_device(device);
+}
 
 int USBDevice::claimInterface(const libusb_interface_descriptor *interfaceDescriptor, int endpointOut, int endPointIn) {
     int errorCode = libusb_claim_interface(this->handle, interfaceDescriptor->bInterfaceNumber);
@@ -123,23 +129,33 @@ int USBDevice::claimInterface(const libusb_interface_descriptor *interfaceDescri
 }
 
 void USBDevice::disconnectFromDevice() {
-    if (!device) return;
+    if (!this->handle) return;
 
-    if (this->handle) {
-        // Release claimed interface
-        if (this->interface != -1) libusb_release_interface(this->handle, this->interface);
-        this->interface = -1;
+    // Release claimed interface
+    if (this->interface != -1) libusb_release_interface(this->handle, this->interface);
+    this->interface = -1;
 
-        // Close device handle
-        libusb_close(this->handle);
-    }
+    // Close device handle
+    libusb_close(this->handle);
     this->handle = nullptr;
 
-    libusb_unref_device(device);
-
     emit deviceDisconnected();
 }
 
+bool USBDevice::reconnectDevice(libusb_device *device, QString &errorMessage) {
+    disconnectFromDevice();
+
+    if (device != this->device) {
+        libusb_ref_device(device);
+        libusb_unref_device(this->device);
+        this->device = device;
+        libusb_get_device_descriptor(device, &descriptor);
+        uniqueUSBdeviceID = computeUSBdeviceID(device);
+    }
+
+    return connectDevice(errorMessage);
+}
+
 bool USBDevice::isConnected() { return this->handle != 0; }
 
 bool USBDevice::needsFirmware() {
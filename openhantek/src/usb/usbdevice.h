@@ -30,6 +30,12 @@ class USBDevice : public QObject {
     ~USBDevice();
     bool connectDevice(QString &errorMessage);
     void disconnectFromDevice();
+    /// \brief Connects again after the device has been lost, e.g. unplugged and plugged in again.
+    /// The model stays the same, the device may be found on another port.
+    /// \param device The libusb device found for this oscilloscope, or the current one to retry it.
+    /// \param errorMessage Describes why the connection failed.
+    /// \return true, if the connection is up again.
+    bool reconnectDevice(libusb_device *device, QString &errorMessage);
 
     /// \brief Check if the oscilloscope is connected.
     /// \return true, if a connection is up.
@@ -155,8 +161,8 @@ class USBDevice : public QObject {
     libusb_device *device; ///< The USB handle for the oscilloscope
     libusb_device_handle *handle = nullptr;
     unsigned findIteration;
-    const unsigned long uniqueUSBdeviceID;
-    int interface;
+    unsigned long uniqueUSBdeviceID;
+    int interface = -1;
     int outPacketLength; ///< Packet length for the OUT endpoint
     int inPacketLength;  ///< Packet length for the IN endpoint
   signals:
@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include <chrono>
+
+#include "utils/hostclock.h"
+
+int64_t hostTimestamp() {
+    using namespace std::chrono;
+    static const int64_t systemStart = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+    static const steady_clock::time_point steadyStart = steady_clock::now();
+    return systemStart + duration_cast<nanoseconds>(steady_clock::now() - steadyStart).count();
+}
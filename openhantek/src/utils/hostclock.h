@@ -0,0 +1,10 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <cstdint>
+
+/// \brief The host time in ns since the epoch, for the time stamps of the recorded frames.
+/// The system clock is read once, later values advance with the steady clock. So the time stamps of all
+/// devices can be compared with each other even if the system clock is adjusted while recording.
+int64_t hostTimestamp();
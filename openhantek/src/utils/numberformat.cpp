@@ -0,0 +1,287 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "utils/numberformat.h"
+
+namespace {
+
+/// \brief Floating point number f * 2^e with a 64 bit significand.
+struct DiyFp {
+    uint64_t f;
+    int e;
+};
+
+DiyFp operator-(const DiyFp &a, const DiyFp &b) { return {a.f - b.f, a.e}; }
+
+/// \brief The upper 64 bits of the product, rounded.
+DiyFp operator*(const DiyFp &x, const DiyFp &y) {
+    const uint64_t M32 = 0xffffffffu;
+    const uint64_t a = x.f >> 32, b = x.f & M32, c = y.f >> 32, d = y.f & M32;
+    const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+    tmp += 1u << 31;
+    return {ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64};
+}
+
+DiyFp normalize(DiyFp x) {
+    while (!(x.f & (uint64_t(1) << 63))) {
+        x.f <<= 1;
+        --x.e;
+    }
+    return x;
+}
+
+const int CACHED_POWER_FIRST = -348; ///< Decimal exponent of the first cached power
+const int CACHED_POWER_STEP = 8;     ///< Decimal exponent step of the cached powers
+const int CACHED_POWER_COUNT = 87;
+
+/// \brief The powers 10^-348, 10^-340 ... 10^340, normalized to 64 bit significands.
+/// They are computed once with exact integer arithmetic instead of being listed in a table.
+class CachedPowers {
+  public:
+    CachedPowers() {
+        for (int index = 0; index < CACHED_POWER_COUNT; ++index)
+            powers[index] = power(CACHED_POWER_FIRST + index * CACHED_POWER_STEP);
+    }
+    DiyFp powers[CACHED_POWER_COUNT];
+
+  private:
+    typedef std::vector<uint32_t> BigInt; ///< Little endian 32 bit words
+
+    static void multiply(BigInt &value, uint32_t factor) {
+        uint64_t carry = 0;
+        for (uint32_t &word : value) {
+            carry += (uint64_t)word * factor;
+            word = (uint32_t)carry;
+            carry >>= 32;
+        }
+        if (carry) value.push_back((uint32_t)carry);
+    }
+    static void divide(BigInt &value, uint32_t divisor) {
+        uint64_t remainder = 0;
+        for (size_t index = value.size(); index-- > 0;) {
+            remainder = (remainder << 32) | value[index];
+            value[index] = (uint32_t)(remainder / divisor);
+            remainder %= divisor;
+        }
+        while (!value.empty() && !value.back()) value.pop_back();
+    }
+    static int bitLength(const BigInt &value) {
+        int length = (int)(value.size() - 1) * 32;
+        for (uint32_t top = value.back(); top; top >>= 1) ++length;
+        return length;
+    }
+    static bool bit(const BigInt &value, int position) { return (value[position / 32] >> (position % 32)) & 1; }
+
+    /// \brief Rounds value * 2^shift to a normalized DiyFp.
+    static DiyFp round(const BigInt &value, int shift) {
+        const int length = bitLength(value);
+        uint64_t f = 0;
+        for (int position = length - 1; position >= length - 64; --position) f = (f << 1) | bit(value, position);
+        DiyFp result = {f, length - 64 + shift};
+        if (bit(value, length - 65) && !++result.f) result = {uint64_t(1) << 63, result.e + 1};
+        return result;
+    }
+    static DiyFp power(int exponent) {
+        if (exponent >= 0) {
+            BigInt value(1, 1);
+            for (int step = 0; step < exponent; ++step) multiply(value, 10);
+            if (bitLength(value) <= 64) {
+                uint64_t f = 0;
+                for (size_t index = value.size(); index-- > 0;) f = (f << 32) | value[index];
+                return normalize({f, 0});
+            }
+            return round(value, 0);
+        }
+        // 2^shift / 10^-exponent with at least 64 bits more than needed, floor divisions may be chained
+        const int shift = 128 + (-exponent * 10) / 3;
+        BigInt value((size_t)shift / 32 + 1, 0);
+        value.back() = uint32_t(1) << (shift % 32);
+        for (int step = 0; step < -exponent; ++step) divide(value, 10);
+        return round(value, -shift);
+    }
+};
+
+const CachedPowers cachedPowers;
+
+const uint64_t POW10[] = {1ull,
+                          10ull,
+                          100ull,
+                          1000ull,
+                          10000ull,
+                          100000ull,
+                          1000000ull,
+                          10000000ull,
+                          100000000ull,
+                          1000000000ull,
+                          10000000000ull,
+                          100000000000ull,
+                          1000000000000ull,
+                          10000000000000ull,
+                          100000000000000ull,
+                          1000000000000000ull,
+                          10000000000000000ull,
+                          100000000000000000ull,
+                          1000000000000000000ull,
+                          10000000000000000000ull};
+
+int countDecimalDigits(uint32_t value) {
+    int digits = 1;
+    while (digits < 10 && value >= POW10[digits]) ++digits;
+    return digits;
+}
+
+/// \brief Moves the last digit towards the exact value as long as it stays inside the rounding interval.
+void grisuRound(char *buffer, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance) {
+    while (rest < distance && delta - rest >= tenKappa &&
+           (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance)) {
+        buffer[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+/// \brief Generates the shortest digits inside the interval (upper - delta, upper).
+void digitGen(const DiyFp &w, const DiyFp &upper, uint64_t delta, char *buffer, int *length, int *k) {
+    const DiyFp one = {uint64_t(1) << -upper.e, upper.e};
+    const DiyFp distance = upper - w;
+    uint32_t integral = (uint32_t)(upper.f >> -one.e);
+    uint64_t fractional = upper.f & (one.f - 1);
+    int kappa = countDecimalDigits(integral);
+    *length = 0;
+
+    while (kappa > 0) {
+        const uint32_t divisor = (uint32_t)POW10[kappa - 1];
+        const uint32_t digit = integral / divisor;
+        integral %= divisor;
+        if (digit || *length) buffer[(*length)++] = (char)('0' + digit);
+        --kappa;
+        const uint64_t rest = ((uint64_t)integral << -one.e) + fractional;
+        if (rest <= delta) {
+            *k += kappa;
+            grisuRound(buffer, *length, delta, rest, POW10[kappa] << -one.e, distance.f);
+            return;
+        }
+    }
+    for (;;) {
+        fractional *= 10;
+        delta *= 10;
+        const char digit = (char)(fractional >> -one.e);
+        if (digit || *length) buffer[(*length)++] = (char)('0' + digit);
+        fractional &= one.f - 1;
+        --kappa;
+        if (fractional < delta) {
+            *k += kappa;
+            grisuRound(buffer, *length, delta, fractional, one.f, distance.f * POW10[-kappa]);
+            return;
+        }
+    }
+}
+
+/// \brief Writes the digits of a positive finite value, the value is digits * 10^k.
+void grisu2(double value, char *buffer, int *length, int *k) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint64_t HIDDEN_BIT = uint64_t(1) << 52;
+    const int biasedExponent = (int)((bits >> 52) & 0x7ff);
+    const uint64_t significand = bits & (HIDDEN_BIT - 1);
+    const DiyFp v = biasedExponent ? DiyFp{significand + HIDDEN_BIT, biasedExponent - 1075} : DiyFp{significand, -1074};
+
+    // Boundaries halfway to the neighbouring doubles
+    const DiyFp upper = normalize({(v.f << 1) + 1, v.e - 1});
+    DiyFp lower = (v.f == HIDDEN_BIT) ? DiyFp{(v.f << 2) - 1, v.e - 2} : DiyFp{(v.f << 1) - 1, v.e - 1};
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+
+    // Scale by a cached power, so that the binary exponent is between -59 and -32
+    const double dk = (-61 - upper.e) * 0.30102999566398114 + 347;
+    int powerK = (int)dk;
+    if (dk - powerK > 0.0) ++powerK;
+    const int index = (powerK >> 3) + 1;
+    const DiyFp cachedPower = cachedPowers.powers[index];
+    *k = -(CACHED_POWER_FIRST + index * CACHED_POWER_STEP);
+
+    const DiyFp w = normalize(v) * cachedPower;
+    DiyFp scaledUpper = upper * cachedPower;
+    DiyFp scaledLower = lower * cachedPower;
+    ++scaledLower.f;
+    --scaledUpper.f;
+    digitGen(w, scaledUpper, scaledUpper.f - scaledLower.f, buffer, length, k);
+}
+
+char *writeExponent(int exponent, char *buffer) {
+    if (exponent < 0) {
+        *buffer++ = '-';
+        exponent = -exponent;
+    }
+    if (exponent >= 100) {
+        *buffer++ = (char)('0' + exponent / 100);
+        exponent %= 100;
+        *buffer++ = (char)('0' + exponent / 10);
+    } else if (exponent >= 10)
+        *buffer++ = (char)('0' + exponent / 10);
+    *buffer++ = (char)('0' + exponent % 10);
+    return buffer;
+}
+
+/// \brief Places the decimal point into the digits, the value is digits * 10^k.
+char *prettify(char *buffer, int length, int k) {
+    const int exponent = length + k; // 10^(exponent-1) <= value < 10^exponent
+    if (k >= 0 && exponent <= 21) {
+        // 1234e3 -> 1234000
+        for (int position = length; position < exponent; ++position) buffer[position] = '0';
+        return buffer + exponent;
+    }
+    if (exponent > 0 && exponent <= 21) {
+        // 1234e-2 -> 12.34
+        std::memmove(buffer + exponent + 1, buffer + exponent, (size_t)(length - exponent));
+        buffer[exponent] = '.';
+        return buffer + length + 1;
+    }
+    if (exponent > -6 && exponent <= 0) {
+        // 1234e-6 -> 0.001234
+        const int offset = 2 - exponent;
+        std::memmove(buffer + offset, buffer, (size_t)length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        for (int position = 2; position < offset; ++position) buffer[position] = '0';
+        return buffer + length + offset;
+    }
+    if (length == 1) {
+        // 1e30
+        buffer[1] = 'e';
+        return writeExponent(exponent - 1, buffer + 2);
+    }
+    // 1234e30 -> 1.234e33
+    std::memmove(buffer + 2, buffer + 1, (size_t)(length - 1));
+    buffer[1] = '.';
+    buffer[length + 1] = 'e';
+    return writeExponent(exponent - 1, buffer + length + 2);
+}
+
+} // namespace
+
+char *formatShortest(char *buffer, double value) {
+    if (std::isnan(value)) {
+        std::memcpy(buffer, "nan", 3);
+        return buffer + 3;
+    }
+    if (std::signbit(value)) {
+        *buffer++ = '-';
+        value = -value;
+    }
+    if (std::isinf(value)) {
+        std::memcpy(buffer, "inf", 3);
+        return buffer + 3;
+    }
+    if (value == 0.0) {
+        *buffer = '0';
+        return buffer + 1;
+    }
+    int length, k;
+    grisu2(value, buffer, &length, &k);
+    return prettify(buffer, length, k);
+}
@@ -0,0 +1,17 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+/// Size of a buffer that holds every number written by formatShortest().
+#define SHORTEST_BUFFER_SIZE 32
+
+/// \brief Writes a short decimal representation of a double that reads back as exactly the same value.
+/// The digits are generated with the Grisu2 algorithm (integer arithmetic only, no locale), which finds the
+/// shortest representation for more than 99% of all values and at most one digit more otherwise. Values with a
+/// decimal exponent between -6 and 21 are written in fixed notation (0.00125, 1500), the others in
+/// scientific notation (1.5e-9). This is a lot faster than printf or QTextStream and is meant for writing
+/// large numbers of samples.
+/// \param buffer The output, at least SHORTEST_BUFFER_SIZE bytes. No terminating zero is written.
+/// \param value The value to write, nan and inf are written as such.
+/// \return The end of the written characters.
+char *formatShortest(char *buffer, double value);
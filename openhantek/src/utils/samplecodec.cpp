@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#include "samplecodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+/// Samples per block, every block has its own bit width
+const size_t BLOCK_SIZE = 128;
+/// Block marker of the blocks that are stored as floats
+const uint8_t RAW_BLOCK = 0xff;
+/// Codes are limited to this magnitude, so the deltas fit into 32 bits
+const double MAX_CODE = 1 << 30;
+
+/// The deltas are computed modulo 2^32, so they never overflow. Small negative deltas become small numbers.
+inline uint32_t zigzag(uint32_t delta) { return (delta << 1) ^ (0u - (delta >> 31)); }
+inline uint32_t unzigzag(uint32_t value) { return (value >> 1) ^ (0u - (value & 1)); }
+
+inline float decodeCode(double origin, double step, int32_t code) { return (float)(origin + code * step); }
+
+inline size_t packedSize(size_t count, unsigned width) { return (count * width + 7) / 8; }
+/// Packs the values LSB first with width bits each.
+void pack(const uint32_t *values, size_t count, unsigned width, uint8_t *output) {
+    uint64_t buffer = 0;
+    unsigned bits = 0;
+    for (size_t index = 0; index < count; ++index) {
+        buffer |= (uint64_t)values[index] << bits;
+        bits += width;
+        if (bits >= 32) {
+            output[0] = (uint8_t)buffer;
+            output[1] = (uint8_t)(buffer >> 8);
+            output[2] = (uint8_t)(buffer >> 16);
+            output[3] = (uint8_t)(buffer >> 24);
+            output += 4;
+            buffer >>= 32;
+            bits -= 32;
+        }
+    }
+    for (; bits > 0; bits = bits > 8 ? bits - 8 : 0, buffer >>= 8) *output++ = (uint8_t)buffer;
+}
+
+void unpack(const uint8_t *input, size_t count, unsigned width, uint32_t *values) {
+    const uint32_t mask = width == 32 ? 0xffffffffu : (1u << width) - 1;
+    const uint8_t *end = input + packedSize(count, width);
+    uint64_t buffer = 0;
+    unsigned bits = 0;
+    for (size_t index = 0; index < count; ++index) {
+        if (bits < width) {
+            // Refill 32 bits at once while the packed data has them
+            if (end - input >= 4) {
+                buffer |= ((uint64_t)input[0] | (uint64_t)input[1] << 8 | (uint64_t)input[2] << 16 |
+                           (uint64_t)input[3] << 24)
+                          << bits;
+                input += 4;
+                bits += 32;
+            } else {
+                while (bits < width) {
+                    buffer |= (uint64_t)*input++ << bits;
+                    bits += 8;
+                }
+            }
+        }
+        values[index] = (uint32_t)buffer & mask;
+        buffer >>= width;
+        bits -= width;
+    }
+}
+
+} // namespace
+
+void encodeSamples(const double *samples, size_t count, double step, std::vector<uint8_t> &output) {
+    if (!count) return;
+    if (!(step > 0) || !std::isfinite(step)) step = 0;
+    const double origin = std::isfinite(samples[0]) ? samples[0] : 0.0;
+    const double inverseStep = step > 0 ? 1.0 / step : 0.0;
+
+    // Header: The origin and the step of the codes
+    const size_t headerPosition = output.size();
+    output.resize(headerPosition + 2 * sizeof(double));
+    memcpy(output.data() + headerPosition, &origin, sizeof(double));
+    memcpy(output.data() + headerPosition + sizeof(double), &step, sizeof(double));
+
+    int32_t codes[BLOCK_SIZE];
+    uint32_t deltas[BLOCK_SIZE];
+    uint32_t previous = 0;
+    for (size_t begin = 0; begin < count; begin += BLOCK_SIZE) {
+        const size_t blockSize = std::min(BLOCK_SIZE, count - begin);
+        const double *block = samples + begin;
+
+        // Branch free loops, so they vectorize
+        bool exact = step > 0;
+        if (exact) {
+            bool outOfRange = false;
+            for (size_t index = 0; index < blockSize; ++index) {
+                double scaled = (block[index] - origin) * inverseStep;
+                outOfRange |= !(std::fabs(scaled) < MAX_CODE);
+                scaled = std::fabs(scaled) < MAX_CODE ? scaled : 0.0;
+                codes[index] = (int32_t)(scaled + (scaled >= 0 ? 0.5 : -0.5));
+            }
+            // The rounded codes have to reproduce the samples
+            bool mismatch = false;
+            for (size_t index = 0; index < blockSize; ++index)
+                mismatch |= decodeCode(origin, step, codes[index]) != (float)block[index];
+            exact = !outOfRange && !mismatch;
+        }
+
+        const size_t position = output.size();
+        if (!exact) {
+            output.resize(position + 1 + blockSize * sizeof(float));
+            output[position] = RAW_BLOCK;
+            float *values = reinterpret_cast<float *>(&output[position + 1]);
+            for (size_t index = 0; index < blockSize; ++index) {
+                const float value = (float)block[index];
+                memcpy(values + index, &value, sizeof(float));
+            }
+            continue;
+        }
+
+        uint32_t any = 0;
+        for (size_t index = 0; index < blockSize; ++index) {
+            deltas[index] = zigzag((uint32_t)codes[index] - previous);
+            previous = (uint32_t)codes[index];
+            any |= deltas[index];
+        }
+        unsigned width = 0;
+        while (width < 32 && (any >> width)) ++width;
+
+        output.resize(position + 1 + packedSize(blockSize, width));
+        output[position] = (uint8_t)width;
+        pack(deltas, blockSize, width, &output[position + 1]);
+    }
+}
+
+size_t decodeSamples(const uint8_t *input, size_t size, float *samples, size_t count) {
+    if (!count) return 0;
+    if (size < 2 * sizeof(double)) return 0;
+    double origin, step;
+    memcpy(&origin, input, sizeof(double));
+    memcpy(&step, input + sizeof(double), sizeof(double));
+    size_t position = 2 * sizeof(double);
+
+    uint32_t deltas[BLOCK_SIZE];
+    uint32_t previous = 0;
+    for (size_t begin = 0; begin < count; begin += BLOCK_SIZE) {
+        const size_t blockSize = std::min(BLOCK_SIZE, count - begin);
+        if (position >= size) return 0;
+        const uint8_t width = input[position++];
+
+        if (width == RAW_BLOCK) {
+            if (size - position < blockSize * sizeof(float)) return 0;
+            memcpy(samples + begin, input + position, blockSize * sizeof(float));
+            position += blockSize * sizeof(float);
+            continue;
+        }
+
+        if (width > 32 || size - position < packedSize(blockSize, width)) return 0;
+        if (width) {
+            unpack(input + position, blockSize, width, deltas);
+            position += packedSize(blockSize, width);
+        } else
+            memset(deltas, 0, blockSize * sizeof(uint32_t));
+        for (size_t index = 0; index < blockSize; ++index) {
+            previous += unzigzag(deltas[index]);
+            samples[begin + index] = decodeCode(origin, step, (int32_t)previous);
+        }
+    }
+    return position;
+}
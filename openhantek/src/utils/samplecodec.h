@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// \brief Appends the samples in a compressed form to output.
+/// The samples of the oscilloscope are ADC values times a step (plus an offset), so the codec maps every sample
+/// to an integer code relative to the first sample. Blocks of 128 codes are stored as zig-zag encoded deltas,
+/// packed with the bit width of the largest delta in the block. Adjacent samples usually differ by a few steps,
+/// which gives 2 to 8 bits per sample instead of 32. A block with a sample that is not reproduced exactly as
+/// float by its code (math channels, filtered signals, a wrong step) is stored as plain floats instead, so the
+/// codec is lossless for float precision in any case.
+/// \param samples The samples, they are decoded as float.
+/// \param step The quantization step, e.g. the voltage of one ADC value. 0 stores all samples as floats.
+void encodeSamples(const double *samples, size_t count, double step, std::vector<uint8_t> &output);
+
+/// \brief Decodes the samples of one encodeSamples() call.
+/// \param count The number of encoded samples, it isn't stored in the data.
+/// \return The number of bytes read from input, 0 if the data is corrupt.
+size_t decodeSamples(const uint8_t *input, size_t size, float *samples, size_t count);
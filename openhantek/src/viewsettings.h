@@ -40,10 +40,12 @@ struct DsoSettingsView {
     bool digitalPhosphor = false;                                     ///< true slowly fades out the previous graphs
     unsigned digitalPhosphorDepth = 8;                                ///< Number of channels shown at one time
     Dso::InterpolationMode interpolation = Dso::INTERPOLATION_LINEAR; ///< Interpolation mode for the graph
+    unsigned dotSize = 1;                                             ///< Size of the dots in pixels (no interpolation)
     bool screenColorImages = false;                                   ///< true exports images with screen colors
     bool zoom = false;                                                ///< true if the magnified scope is enabled
     Qt::ToolBarArea cursorGridPosition = Qt::RightToolBarArea;
     bool cursorsVisible = false;
+    bool detailedMeasurements = false; ///< true shows all automatic measurements below each channel
 
     unsigned digitalPhosphorDraws() const {
         return digitalPhosphor ? digitalPhosphorDepth : 1;